@@ -0,0 +1,65 @@
+/*
+
+  EXAMPLE osmium_apply_changes
+
+  Apply OSM change files to an OSM data file sorted by type and id and
+  write out the result. Reports the throughput at the end.
+
+  DEMONSTRATES USE OF:
+  * the ApplyChanges class
+  * file input and output
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_read
+  * osmium_convert
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cstdlib>   // for std::exit
+#include <cstring>   // for std::strcmp
+#include <exception> // for std::exception
+#include <iostream>  // for std::cout, std::cerr
+
+// Allow any format of input files (XML, PBF, ...)
+#include <osmium/io/any_input.hpp>
+
+// Allow any format of output files (XML, PBF, ...)
+#include <osmium/io/any_output.hpp>
+
+#include <osmium/changes/apply_changes.hpp>
+
+int main(int argc, char* argv[]) {
+    int arg = 1;
+    osmium::changes::ApplyChangesConfig config;
+    if (argc > 1 && !std::strcmp(argv[1], "--history")) {
+        config.with_history = true;
+        ++arg;
+    }
+
+    if (argc - arg < 3) {
+        std::cerr << "Usage: " << argv[0] << " [--history] INFILE CHANGE-FILE... OUTFILE\n";
+        std::exit(1);
+    }
+
+    try {
+        osmium::changes::ApplyChanges apply_changes{osmium::io::File{argv[arg]}, config};
+        for (int i = arg + 1; i < argc - 1; ++i) {
+            apply_changes.add_change_file(osmium::io::File{argv[i]});
+        }
+
+        const auto stats = apply_changes(osmium::io::File{argv[argc - 1]});
+
+        std::cout << "Read " << stats.base_objects << " objects from base file and "
+                  << stats.change_objects << " objects from change files.\n"
+                  << "Wrote " << stats.objects_written << " objects in "
+                  << stats.seconds << " s (" << static_cast<long>(stats.objects_per_second()) << " objects/s).\n";
+    } catch (const std::exception& e) {
+        // All exceptions used by the Osmium library derive from std::exception.
+        std::cerr << e.what() << '\n';
+        std::exit(1);
+    }
+}
+
@@ -0,0 +1,65 @@
+/*
+
+  EXAMPLE osmium_deduplicate
+
+  Keep only the last version of each object from an OSM file, for instance
+  from several overlapping change files concatenated into one file. The
+  input can be slightly out of order, if it is too far out of order, it is
+  sorted first.
+
+  DEMONSTRATES USE OF:
+  * the deduplicate() function and the Deduplicator class
+  * file input and output
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_read
+  * osmium_sort
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cstdlib>   // for std::exit, std::atol
+#include <cstring>   // for std::strcmp
+#include <exception> // for std::exception
+#include <iostream>  // for std::cout, std::cerr
+
+// Allow any format of input files (XML, PBF, ...)
+#include <osmium/io/any_input.hpp>
+
+// Allow any format of output files (XML, PBF, ...)
+#include <osmium/io/any_output.hpp>
+
+#include <osmium/changes/deduplicator.hpp>
+
+int main(int argc, char* argv[]) {
+    int arg = 1;
+    osmium::changes::DeduplicatorConfig config;
+    if (argc > 2 && !std::strcmp(argv[1], "--window")) {
+        // Number of objects the input can be out of order
+        config.window_size = static_cast<std::size_t>(std::atol(argv[2])); // NOLINT(cert-err34-c)
+        arg += 2;
+    }
+
+    if (argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--window OBJECTS] INFILE OUTFILE\n";
+        std::exit(1);
+    }
+
+    try {
+        const auto stats = osmium::changes::deduplicate(osmium::io::File{argv[arg]},
+                                                        osmium::io::File{argv[arg + 1]},
+                                                        config);
+
+        std::cout << "Read " << stats.objects_in << " objects, wrote "
+                  << stats.objects_out << " objects in " << stats.seconds << " s.\n";
+        if (stats.sorted_externally) {
+            std::cout << "Input was too far out of order and had to be sorted.\n";
+        }
+    } catch (const std::exception& e) {
+        // All exceptions used by the Osmium library derive from std::exception.
+        std::cerr << e.what() << '\n';
+        std::exit(1);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+
+  EXAMPLE osmium_derive_changes
+
+  Compare two OSM data files sorted by type and id and write the
+  differences to a change file (usually .osc or .osc.gz). Reports the
+  throughput at the end.
+
+  DEMONSTRATES USE OF:
+  * the DeriveChanges class
+  * file input and output
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_read
+  * osmium_convert
+  * osmium_apply_changes
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cstdlib>   // for std::exit
+#include <cstring>   // for std::strcmp
+#include <exception> // for std::exception
+#include <iostream>  // for std::cout, std::cerr
+
+// Allow any format of input files (XML, PBF, ...)
+#include <osmium/io/any_input.hpp>
+
+// Allow any format of output files (XML, PBF, ...)
+#include <osmium/io/any_output.hpp>
+
+#include <osmium/changes/derive_changes.hpp>
+
+int main(int argc, char* argv[]) {
+    int arg = 1;
+    osmium::changes::DeriveChangesConfig config;
+    if (argc > 1 && !std::strcmp(argv[1], "--ignore-metadata")) {
+        config.ignore_metadata = true;
+        ++arg;
+    }
+
+    if (argc - arg != 3) {
+        std::cerr << "Usage: " << argv[0] << " [--ignore-metadata] OLD-FILE NEW-FILE CHANGE-FILE\n";
+        std::exit(1);
+    }
+
+    try {
+        osmium::changes::DeriveChanges derive_changes{osmium::io::File{argv[arg]}, osmium::io::File{argv[arg + 1]}, config};
+
+        const auto stats = derive_changes(osmium::io::File{argv[arg + 2]});
+
+        std::cout << "Created: " << stats.created << "\n"
+                  << "Modified: " << stats.modified << "\n"
+                  << "Deleted: " << stats.deleted << "\n"
+                  << "Compared " << (stats.old_objects + stats.new_objects) << " objects in "
+                  << stats.seconds << " s (" << static_cast<long>(stats.objects_per_second()) << " objects/s).\n";
+    } catch (const std::exception& e) {
+        // All exceptions used by the Osmium library derive from std::exception.
+        std::cerr << e.what() << '\n';
+        std::exit(1);
+    }
+}
+
@@ -10,6 +10,7 @@
   * file input and output
   * setting file formats using the osmium::io::File class
   * OSM file headers
+  * the ChangesetFilter to filter changesets while parsing
   * input and output iterators
 
   SIMPLER EXAMPLES you might want to understand first:
@@ -29,6 +30,9 @@
 // (other formats don't support full changesets, so only XML is needed here).
 #include <osmium/io/xml_input.hpp>
 
+// We want to filter changesets while they are parsed.
+#include <osmium/io/changeset_filter.hpp>
+
 // We want to write OSM files in XML format.
 #include <osmium/io/xml_output.hpp>
 
@@ -53,10 +57,16 @@ int main(int argc, char* argv[]) {
         // The output file, force XML OSM file format.
         osmium::io::File output_file{argv[2], "osm"};
 
+        // Only changesets with at least one comment are of interest. The
+        // filter is evaluated by the parser on the attributes of each
+        // changeset, all other changesets are never built.
+        osmium::io::ChangesetFilter filter;
+        filter.set_min_comments(1);
+
         // Initialize Reader for the input file.
         // Read only changesets (will ignore nodes, ways, and
-        // relations if there are any).
-        osmium::io::Reader reader{input_file, osmium::osm_entity_bits::changeset};
+        // relations if there are any) matching the filter.
+        osmium::io::Reader reader{input_file, osmium::osm_entity_bits::changeset, filter};
 
         // Get the header from the input file.
         osmium::io::Header header = reader.header();
@@ -78,9 +88,11 @@ int main(int argc, char* argv[]) {
         // output file.
         auto output_iterator = osmium::io::make_output_iterator(writer);
 
-        // Copy all changesets from input to output that have at least one comment.
-        std::copy_if(input_range.begin(), input_range.end(), output_iterator, [](const osmium::Changeset& changeset) {
-            return changeset.num_comments() > 0;
+        // Copy all changesets from input to output that have at least one
+        // comment. The XML parser already did the filtering, but other
+        // formats ignore the filter, so check again.
+        std::copy_if(input_range.begin(), input_range.end(), output_iterator, [&filter](const osmium::Changeset& changeset) {
+            return filter.matches(changeset);
         });
 
         // Explicitly close the writer and reader. Will throw an exception if
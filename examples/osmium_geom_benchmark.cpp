@@ -0,0 +1,176 @@
+/*
+
+  EXAMPLE osmium_geom_benchmark
+
+  Compare the speed of the geometry factories returning each geometry as a
+  new string with the factories appending all geometries to one output
+  string.
+
+  The OSM file is read into memory first, then points for all nodes and
+  linestrings for all ways are created with each factory.
+
+  DEMONSTRATES USE OF:
+  * the WKB, WKT, GeoJSON, and TWKB factories
+  * the WKBAppendFactory, WKTAppendFactory, GeoJSONAppendFactory, and
+    TWKBAppendFactory
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_read
+  * osmium_road_length
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <chrono>   // for std::chrono::steady_clock
+#include <cstdlib>  // for std::exit
+#include <iostream> // for std::cout, std::cerr
+#include <string>   // for std::string
+#include <utility>  // for std::move
+#include <vector>   // for std::vector
+
+#include <osmium/geom/geojson.hpp>
+#include <osmium/geom/twkb.hpp>
+#include <osmium/geom/wkb.hpp>
+#include <osmium/geom/wkt.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/visitor.hpp>
+
+using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+struct Result {
+    double time_ms = 0.0;
+    std::size_t bytes = 0;
+    std::size_t geometries = 0;
+};
+
+// Create geometries for all nodes and ways in the buffers with a factory
+// returning strings. All geometries are appended to "all" as they would be
+// when writing them out.
+template <typename TFactory>
+Result run_string_factory(TFactory& factory, const std::vector<osmium::memory::Buffer>& buffers, std::string& all) {
+    Result result;
+
+    const auto add = [&](const std::string& geometry) {
+        result.bytes += geometry.size();
+        ++result.geometries;
+        all += geometry;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& buffer : buffers) {
+        for (const auto& node : buffer.select<osmium::Node>()) {
+            add(factory.create_point(node));
+        }
+        for (const auto& way : buffer.select<osmium::Way>()) {
+            try {
+                add(factory.create_linestring(way));
+            } catch (const osmium::geometry_error&) {
+                // ignore ways with less than two locations
+            }
+        }
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    result.time_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    return result;
+}
+
+// Create geometries for all nodes and ways in the buffers with a factory
+// appending to "out". After each buffer the output is appended to "all" in
+// one chunk as it would be when writing it out.
+template <typename TFactory>
+Result run_append_factory(TFactory& factory, const std::vector<osmium::memory::Buffer>& buffers, std::string& out, std::string& all) {
+    Result result;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& buffer : buffers) {
+        for (const auto& node : buffer.select<osmium::Node>()) {
+            result.bytes += factory.create_point(node);
+            ++result.geometries;
+        }
+        for (const auto& way : buffer.select<osmium::Way>()) {
+            try {
+                result.bytes += factory.create_linestring(way);
+                ++result.geometries;
+            } catch (const osmium::geometry_error&) {
+                // ignore ways with less than two locations, the factory
+                // removes what was already written
+            }
+        }
+        all += out;
+        out.clear();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    result.time_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    return result;
+}
+
+template <typename TStringFactory, typename TAppendFactory>
+void compare(const char* name, TStringFactory& string_factory, TAppendFactory& append_factory, std::string& out, const std::vector<osmium::memory::Buffer>& buffers) {
+    std::string string_all;
+    std::string append_all;
+
+    const Result string_result = run_string_factory(string_factory, buffers, string_all);
+    const Result append_result = run_append_factory(append_factory, buffers, out, append_all);
+
+    std::cout << name << " (" << string_result.geometries << " geometries, " << string_result.bytes << " bytes):\n"
+              << "  string factory: " << string_result.time_ms << " ms\n"
+              << "  append factory: " << append_result.time_ms << " ms\n";
+
+    if (string_all != append_all || string_result.bytes != append_result.bytes) {
+        std::cerr << "ERROR: Results of " << name << " factories differ\n";
+        std::exit(1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+        std::exit(1);
+    }
+
+    try {
+        // Read nodes and ways into memory adding node locations to the ways.
+        index_type index;
+        location_handler_type location_handler{index};
+        location_handler.ignore_errors();
+
+        std::vector<osmium::memory::Buffer> buffers;
+        osmium::io::Reader reader{argv[1], osmium::osm_entity_bits::node | osmium::osm_entity_bits::way};
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            osmium::apply(buffer, location_handler);
+            buffers.push_back(std::move(buffer));
+        }
+        reader.close();
+
+        std::string out;
+
+        osmium::geom::WKBFactory<> wkb_factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex};
+        osmium::geom::WKBAppendFactory<> wkb_append_factory{out, osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex};
+        compare("WKB (hex)", wkb_factory, wkb_append_factory, out, buffers);
+
+        osmium::geom::WKTFactory<> wkt_factory;
+        osmium::geom::WKTAppendFactory<> wkt_append_factory{out};
+        compare("WKT", wkt_factory, wkt_append_factory, out, buffers);
+
+        osmium::geom::GeoJSONFactory<> geojson_factory;
+        osmium::geom::GeoJSONAppendFactory<> geojson_append_factory{out};
+        compare("GeoJSON", geojson_factory, geojson_append_factory, out, buffers);
+
+        osmium::geom::TWKBFactory<> twkb_factory;
+        osmium::geom::TWKBAppendFactory<> twkb_append_factory{out};
+        compare("TWKB", twkb_factory, twkb_append_factory, out, buffers);
+    } catch (const std::exception& e) {
+        // All exceptions used by the Osmium library derive from std::exception.
+        std::cerr << e.what() << '\n';
+        std::exit(1);
+    }
+}
+
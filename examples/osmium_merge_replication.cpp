@@ -0,0 +1,61 @@
+/*
+
+  EXAMPLE osmium_merge_replication
+
+  Merge all change files from a local replication directory (for instance
+  a mirror of the minutely diffs from planet.osm.org) that are needed to
+  get from the given state (the state.txt saved when the data was last
+  updated) to the current state into one change file. Only the newest
+  version of each object is kept.
+
+  DEMONSTRATES USE OF:
+  * the ReplicationDirectory class
+  * the MergeChanges class
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_read
+  * osmium_apply_changes
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cstdlib>   // for std::exit
+#include <exception> // for std::exception
+#include <iostream>  // for std::cout, std::cerr
+
+// Allow any format of input files (XML, PBF, ...)
+#include <osmium/io/any_input.hpp>
+
+// Allow any format of output files (XML, PBF, ...)
+#include <osmium/io/any_output.hpp>
+
+#include <osmium/changes/merge_changes.hpp>
+#include <osmium/changes/replication.hpp>
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " REPLICATION-DIR STATE-FILE OUTFILE\n";
+        std::exit(1);
+    }
+
+    try {
+        const osmium::changes::ReplicationDirectory directory{argv[1]};
+        const auto last = osmium::changes::read_replication_state(argv[2]);
+        const auto current = directory.state();
+
+        osmium::changes::MergeChanges merged;
+        merged.add_change_files(directory.change_files(last.sequence_number, current.sequence_number));
+        merged.write(osmium::io::File{argv[3]});
+
+        std::cout << "Merged " << merged.files() << " change files from sequence number "
+                  << last.sequence_number << " (" << last.timestamp.to_iso() << ") to "
+                  << current.sequence_number << " (" << current.timestamp.to_iso() << ") into "
+                  << merged.size() << " objects.\n";
+    } catch (const std::exception& e) {
+        // All exceptions used by the Osmium library derive from std::exception.
+        std::cerr << e.what() << '\n';
+        std::exit(1);
+    }
+}
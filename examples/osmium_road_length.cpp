@@ -26,7 +26,7 @@
 // Allow any format of input files (XML, PBF, ...)
 #include <osmium/io/any_input.hpp>
 
-// For the osmium::geom::haversine::distance() function
+// For the osmium::geom::haversine::length() function
 #include <osmium/geom/haversine.hpp>
 
 // For osmium::apply()
@@ -56,7 +56,7 @@ struct RoadLengthHandler : public osmium::handler::Handler {
     void way(const osmium::Way& way) {
         const char* highway = way.tags()["highway"];
         if (highway) {
-            length += osmium::geom::haversine::distance(way.nodes());
+            length += osmium::geom::haversine::length(way.nodes());
         }
     }
 
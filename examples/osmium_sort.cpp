@@ -0,0 +1,65 @@
+/*
+
+  EXAMPLE osmium_sort
+
+  Sort OSM files by type, id, and version. Input files that don't fit into
+  memory are sorted in several runs using temporary files.
+
+  DEMONSTRATES USE OF:
+  * the ExternalSorter class
+  * file input and output
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_read
+  * osmium_convert
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cstdlib>   // for std::exit, std::atol
+#include <cstring>   // for std::strcmp
+#include <exception> // for std::exception
+#include <iostream>  // for std::cout, std::cerr
+
+// Allow any format of input files (XML, PBF, ...)
+#include <osmium/io/any_input.hpp>
+
+// Allow any format of output files (XML, PBF, ...)
+#include <osmium/io/any_output.hpp>
+
+#include <osmium/io/external_sorter.hpp>
+
+int main(int argc, char* argv[]) {
+    int arg = 1;
+    osmium::io::ExternalSorterConfig config;
+    if (argc > 2 && !std::strcmp(argv[1], "--memory")) {
+        // Memory budget in MBytes
+        config.memory_budget = static_cast<std::size_t>(std::atol(argv[2])) * 1024UL * 1024UL; // NOLINT(cert-err34-c)
+        arg += 2;
+    }
+
+    if (argc - arg < 2) {
+        std::cerr << "Usage: " << argv[0] << " [--memory MBYTES] INFILE... OUTFILE\n";
+        std::exit(1);
+    }
+
+    try {
+        osmium::io::ExternalSorter sorter{osmium::io::File{argv[arg]}, config};
+        for (int i = arg + 1; i < argc - 1; ++i) {
+            sorter.add_input(osmium::io::File{argv[i]});
+        }
+
+        const auto stats = sorter(osmium::io::File{argv[argc - 1]});
+
+        std::cout << "Sorted " << stats.objects << " objects in "
+                  << stats.seconds << " s (" << static_cast<long>(stats.objects_per_second()) << " objects/s).\n"
+                  << "Used " << stats.runs << " temporary runs with " << stats.bytes_spilled << " bytes.\n";
+    } catch (const std::exception& e) {
+        // All exceptions used by the Osmium library derive from std::exception.
+        std::cerr << e.what() << '\n';
+        std::exit(1);
+    }
+}
+
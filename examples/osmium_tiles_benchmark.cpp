@@ -0,0 +1,127 @@
+/*
+
+  EXAMPLE osmium_tiles_benchmark
+
+  Compare the speed and results of the scalar Mercator projection and Tile
+  functions with the batch versions working on arrays of locations.
+
+  DEMONSTRATES USE OF:
+  * the batch version of lonlat_to_mercator()
+  * the FixedZoomTiler class
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_tiles
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <algorithm> // for std::max
+#include <chrono>   // for std::chrono::steady_clock
+#include <cmath>    // for std::abs
+#include <cstdint>  // for uint32_t
+#include <cstdlib>  // for std::exit, std::atoi
+#include <iostream> // for std::cout, std::cerr
+#include <random>   // for std::mt19937, std::uniform_int_distribution
+#include <vector>   // for std::vector
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/tile.hpp>
+#include <osmium/osm/location.hpp>
+
+// Run the function and return how long it took in milliseconds.
+template <typename TFunc>
+double time_ms(TFunc&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [ZOOM [NUMBER_OF_LOCATIONS]]\n";
+        std::exit(1);
+    }
+
+    const int zoom = argc > 1 ? std::atoi(argv[1]) : 14; // NOLINT(cert-err34-c)
+    const int count = argc > 2 ? std::atoi(argv[2]) : 10000000; // NOLINT(cert-err34-c)
+
+    if (zoom < 0 || zoom > static_cast<int>(osmium::geom::FixedZoomTiler::max_zoom)) {
+        std::cerr << "ERROR: Zoom must be between 0 and " << osmium::geom::FixedZoomTiler::max_zoom << "\n";
+        std::exit(1);
+    }
+
+    if (count <= 0) {
+        std::cerr << "ERROR: Number of locations must be positive\n";
+        std::exit(1);
+    }
+
+    // Random locations in the range that can be projected.
+    std::mt19937 gen{42}; // NOLINT(cert-msc32-c, cert-msc51-cpp)
+    std::uniform_int_distribution<int32_t> lon_dist{-1800000000, 1800000000};
+    std::uniform_int_distribution<int32_t> lat_dist{-850511287, 850511287};
+    std::vector<osmium::Location> locations;
+    locations.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        locations.emplace_back(osmium::Location{lon_dist(gen), lat_dist(gen)});
+    }
+
+    // Projection
+    std::vector<osmium::geom::Coordinates> scalar_coordinates(count);
+    std::vector<osmium::geom::Coordinates> batch_coordinates(count);
+
+    const double scalar_projection_time = time_ms([&]() {
+        for (int i = 0; i < count; ++i) {
+            scalar_coordinates[i] = osmium::geom::lonlat_to_mercator(locations[i]);
+        }
+    });
+
+    const double batch_projection_time = time_ms([&]() {
+        osmium::geom::lonlat_to_mercator(locations.data(), locations.size(), batch_coordinates.data());
+    });
+
+    double max_difference = 0.0;
+    for (int i = 0; i < count; ++i) {
+        max_difference = std::max(max_difference, std::abs(scalar_coordinates[i].x - batch_coordinates[i].x));
+        max_difference = std::max(max_difference, std::abs(scalar_coordinates[i].y - batch_coordinates[i].y));
+    }
+
+    std::cout << "Projection of " << count << " locations:\n"
+              << "  scalar: " << scalar_projection_time << " ms\n"
+              << "  batch:  " << batch_projection_time << " ms\n"
+              << "  max difference: " << max_difference << " m\n";
+
+    // Tiles
+    std::vector<uint32_t> scalar_tx(count);
+    std::vector<uint32_t> scalar_ty(count);
+    std::vector<uint32_t> batch_tx(count);
+    std::vector<uint32_t> batch_ty(count);
+
+    const double scalar_tile_time = time_ms([&]() {
+        for (int i = 0; i < count; ++i) {
+            const osmium::geom::Tile tile{static_cast<uint32_t>(zoom), locations[i]};
+            scalar_tx[i] = tile.x;
+            scalar_ty[i] = tile.y;
+        }
+    });
+
+    osmium::geom::FixedZoomTiler tiler{static_cast<uint32_t>(zoom)};
+    const double batch_tile_time = time_ms([&]() {
+        tiler(locations.data(), locations.size(), batch_tx.data(), batch_ty.data());
+    });
+
+    int differences = 0;
+    for (int i = 0; i < count; ++i) {
+        if (scalar_tx[i] != batch_tx[i] || scalar_ty[i] != batch_ty[i]) {
+            ++differences;
+        }
+    }
+
+    std::cout << "Tiles in zoom level " << zoom << " for " << count << " locations:\n"
+              << "  Tile constructor: " << scalar_tile_time << " ms\n"
+              << "  FixedZoomTiler:   " << batch_tile_time << " ms\n"
+              << "  different results (locations near tile edges): " << differences << "\n";
+}
@@ -0,0 +1,65 @@
+/*
+
+  EXAMPLE osmium_time_filter
+
+  Read an OSM history file sorted by type, id, and version and write out
+  the state of the data at the given point in time, or all versions valid
+  at some point in the given time range. The input is processed in
+  parallel.
+
+  DEMONSTRATES USE OF:
+  * the TimeFilter class
+  * file input and output
+
+  SIMPLER EXAMPLES you might want to understand first:
+  * osmium_read
+  * osmium_convert
+
+  LICENSE
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cstdlib>   // for std::exit
+#include <exception> // for std::exception
+#include <iostream>  // for std::cerr
+#include <utility>   // for std::move
+
+// Allow any format of input files (XML, PBF, ...)
+#include <osmium/io/any_input.hpp>
+
+// Allow any format of output files (XML, PBF, ...)
+#include <osmium/io/any_output.hpp>
+
+#include <osmium/time_filter.hpp>
+
+int main(int argc, char* argv[]) {
+    if (argc != 4 && argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " INFILE OUTFILE TIME [TIME]\n"
+                  << "Times must be in ISO format (yyyy-mm-ddThh:mm:ssZ).\n";
+        std::exit(1);
+    }
+
+    try {
+        const osmium::TimeFilter filter = argc == 4 ? osmium::TimeFilter{osmium::Timestamp{argv[3]}}
+                                                    : osmium::TimeFilter{osmium::Timestamp{argv[3]}, osmium::Timestamp{argv[4]}};
+
+        osmium::io::Reader reader{argv[1]};
+
+        osmium::io::Header header{reader.header()};
+        header.set_has_multiple_object_versions(!filter.point_in_time());
+        osmium::io::Writer writer{argv[2], header};
+
+        filter.filter(reader, [&](osmium::memory::Buffer&& buffer) {
+            writer(std::move(buffer));
+        });
+
+        writer.close();
+        reader.close();
+    } catch (const std::exception& e) {
+        // All exceptions used by the Osmium library derive from std::exception.
+        std::cerr << e.what() << '\n';
+        std::exit(1);
+    }
+}
+
@@ -0,0 +1,379 @@
+#ifndef OSMIUM_CHANGES_APPLY_CHANGES_HPP
+#define OSMIUM_CHANGES_APPLY_CHANGES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/changes/detail/object_source.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/object_comparisons.hpp>
+#include <osmium/util/misc.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * @brief Applying, creating, and merging change files.
+     */
+    namespace changes {
+
+        /**
+         * Configuration for ApplyChanges.
+         */
+        struct ApplyChangesConfig {
+
+            /**
+             * Write all versions of all objects (including deleted ones)
+             * instead of only the newest version of objects that are not
+             * deleted. Use this to update history files.
+             */
+            bool with_history = false;
+
+            /**
+             * Objects are collected in a buffer of this size before they
+             * are handed to the Writer.
+             */
+            std::size_t buffer_size = 1024UL * 1024UL;
+
+            /**
+             * Allow overwriting of an existing output file?
+             */
+            osmium::io::overwrite overwrite = osmium::io::overwrite::no;
+
+        }; // struct ApplyChangesConfig
+
+        /**
+         * Statistics about one run of ApplyChanges.
+         */
+        struct ApplyChangesStats {
+
+            /// Number of objects read from the base file.
+            std::size_t base_objects = 0;
+
+            /// Number of objects read from all change files.
+            std::size_t change_objects = 0;
+
+            /// Number of objects written to the output.
+            std::size_t objects_written = 0;
+
+            /// Wall clock time of the whole run in seconds.
+            double seconds = 0.0;
+
+            /**
+             * Throughput of the run: Number of objects read per second.
+             */
+            double objects_per_second() const noexcept {
+                if (seconds <= 0.0) {
+                    return 0.0;
+                }
+                return static_cast<double>(base_objects + change_objects) / seconds;
+            }
+
+        }; // struct ApplyChangesStats
+
+        namespace detail {
+
+            /**
+             * All objects from one change file, sorted by type, id, and
+             * version. Change files are not sorted (objects are grouped
+             * by create/modify/delete), so they have to be read into
+             * memory completely. The objects can also come from a buffer
+             * owned by someone else.
+             */
+            class change_list {
+
+                std::vector<osmium::memory::Buffer> m_buffers{};
+                std::vector<const osmium::OSMObject*> m_objects{};
+                std::size_t m_pos = 0;
+
+                void sort() {
+                    // Stable sort, so that if the same version is in the
+                    // file twice, the one later in the file wins.
+                    std::stable_sort(m_objects.begin(), m_objects.end(), osmium::object_order_type_id_version_without_timestamp{});
+                }
+
+            public:
+
+                explicit change_list(const osmium::io::File& file) {
+                    osmium::io::Reader reader{file, osmium::osm_entity_bits::nwr};
+                    while (osmium::memory::Buffer buffer = reader.read()) {
+                        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                            m_objects.push_back(&object);
+                        }
+                        m_buffers.push_back(std::move(buffer));
+                    }
+                    reader.close();
+                    sort();
+                }
+
+                explicit change_list(const osmium::memory::Buffer& buffer) {
+                    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                        m_objects.push_back(&object);
+                    }
+                    sort();
+                }
+
+                std::size_t size() const noexcept {
+                    return m_objects.size();
+                }
+
+                const osmium::OSMObject* next() noexcept {
+                    if (m_pos == m_objects.size()) {
+                        return nullptr;
+                    }
+                    return m_objects[m_pos++];
+                }
+
+            }; // class change_list
+
+            struct merge_entry {
+                const osmium::OSMObject* object;
+                std::size_t source;
+            };
+
+            inline bool same_type_id(const osmium::OSMObject& lhs, const osmium::OSMObject& rhs) noexcept {
+                return lhs.type() == rhs.type() && lhs.id() == rhs.id();
+            }
+
+            inline bool same_type_id_version(const osmium::OSMObject& lhs, const osmium::OSMObject& rhs) noexcept {
+                return same_type_id(lhs, rhs) && lhs.version() == rhs.version();
+            }
+
+            /**
+             * Order of the merge (reversed, because std::priority_queue
+             * returns the largest element first): By type, id, and
+             * version, then by source, so that of two copies of the same
+             * version the one from the later change file wins.
+             */
+            struct merge_entry_greater {
+
+                bool operator()(const merge_entry& lhs, const merge_entry& rhs) const noexcept {
+                    return const_tie(rhs.object->type(), rhs.object->id() > 0, rhs.object->positive_id(), rhs.object->version(), rhs.source) <
+                           const_tie(lhs.object->type(), lhs.object->id() > 0, lhs.object->positive_id(), lhs.object->version(), lhs.source);
+                }
+
+            }; // struct merge_entry_greater
+
+        } // namespace detail
+
+        /**
+         * Apply change files (usually in .osc format) to a base file
+         * sorted by type, id, and version (as usual) and write the
+         * result to an output file.
+         *
+         * The change files are read into memory and sorted. The base file
+         * is streamed and merged with the sorted changes in one k-way
+         * merge. Reading and decoding the base file and encoding and
+         * writing the output happens in the background threads of the
+         * Reader and Writer, so the merge itself runs in parallel to
+         * them.
+         *
+         * Usually only the newest version of each object is written and
+         * deleted objects are removed. The change files can be given in
+         * any order and may overlap. If they contain the same version of
+         * an object, the one from the file added last is used, versions
+         * from change files replace the same version in the base file.
+         *
+         * If ApplyChangesConfig::with_history is set, all versions of
+         * all objects are written and the base file can be a history
+         * file.
+         *
+         * @code
+         * osmium::changes::ApplyChanges apply{osmium::io::File{"planet.osm.pbf"}};
+         * apply.add_change_file(osmium::io::File{"123.osc.gz"});
+         * apply.add_change_file(osmium::io::File{"124.osc.gz"});
+         * const auto stats = apply(osmium::io::File{"new-planet.osm.pbf"});
+         * std::cout << stats.objects_per_second() << " objects/s\n";
+         * @endcode
+         */
+        class ApplyChanges {
+
+            // A change file or, if buffer is set, a buffer with changes.
+            struct change_source {
+                osmium::io::File file;
+                const osmium::memory::Buffer* buffer;
+            };
+
+            osmium::io::File m_base;
+            std::vector<change_source> m_changes{};
+            ApplyChangesConfig m_config;
+
+        public:
+
+            /**
+             * Create an ApplyChanges object for the given base file.
+             */
+            explicit ApplyChanges(const osmium::io::File& base, const ApplyChangesConfig& config = ApplyChangesConfig{}) :
+                m_base(base),
+                m_config(config) {
+            }
+
+            /**
+             * Add a change file. If change files contain the same version
+             * of an object, the one from the file added last wins.
+             */
+            void add_change_file(const osmium::io::File& file) {
+                m_changes.push_back(change_source{file, nullptr});
+            }
+
+            /**
+             * Add changes from a buffer, for instance the changes merged
+             * by MergeChanges. They are handled like a change file added
+             * at this point. The buffer is not copied, it must be kept
+             * alive until the merge has run.
+             */
+            void add_changes(const osmium::memory::Buffer& buffer) {
+                m_changes.push_back(change_source{osmium::io::File{}, &buffer});
+            }
+
+            /**
+             * Merge the base file with all change files and write the
+             * result to the output file.
+             *
+             * @returns Statistics about this run.
+             * @throws std::runtime_error If the base file is not sorted.
+             * @throws Any exception the Reader or Writer throw.
+             */
+            ApplyChangesStats operator()(const osmium::io::File& output) {
+                ApplyChangesStats stats;
+                const auto start = std::chrono::steady_clock::now();
+
+                std::vector<detail::change_list> changes;
+                changes.reserve(m_changes.size());
+                for (const auto& source : m_changes) {
+                    if (source.buffer) {
+                        changes.emplace_back(*source.buffer);
+                    } else {
+                        changes.emplace_back(source.file);
+                    }
+                    stats.change_objects += changes.back().size();
+                }
+
+                osmium::io::Reader reader{m_base, osmium::osm_entity_bits::nwr};
+                detail::object_source base{reader};
+
+                osmium::io::Header header{reader.header()};
+                header.set_has_multiple_object_versions(m_config.with_history);
+                osmium::io::Writer writer{output, header, m_config.overwrite};
+
+                osmium::memory::Buffer buffer{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                const auto write = [&](const osmium::OSMObject& object) {
+                    if (!m_config.with_history && !object.visible()) {
+                        return;
+                    }
+                    buffer.add_item(object);
+                    buffer.commit();
+                    ++stats.objects_written;
+                    if (buffer.committed() >= m_config.buffer_size) {
+                        writer(std::move(buffer));
+                        buffer = osmium::memory::Buffer{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                    }
+                };
+
+                // Source 0 is the base file, source i+1 is change file i.
+                const auto next = [&](const std::size_t source) {
+                    return source == 0 ? base.next() : changes[source - 1].next();
+                };
+
+                std::priority_queue<detail::merge_entry, std::vector<detail::merge_entry>, detail::merge_entry_greater> queue;
+                for (std::size_t source = 0; source <= changes.size(); ++source) {
+                    if (const osmium::OSMObject* object = next(source)) {
+                        queue.push(detail::merge_entry{object, source});
+                    }
+                }
+
+                // The candidate is the newest object seen so far for the
+                // current type and id (or type, id, and version in history
+                // mode). It is written once an object with a different
+                // key comes along. The candidate is always the object
+                // popped last, so it is still valid when the next object
+                // is popped.
+                const osmium::OSMObject* candidate = nullptr;
+                while (!queue.empty()) {
+                    const detail::merge_entry entry = queue.top();
+                    queue.pop();
+
+                    if (candidate) {
+                        const bool same = m_config.with_history ? detail::same_type_id_version(*candidate, *entry.object)
+                                                                : detail::same_type_id(*candidate, *entry.object);
+                        if (!same) {
+                            write(*candidate);
+                        }
+                    }
+                    candidate = entry.object;
+
+                    if (entry.source == 0) {
+                        ++stats.base_objects;
+                    }
+                    if (const osmium::OSMObject* object = next(entry.source)) {
+                        if (entry.source == 0 && osmium::object_order_type_id_version_without_timestamp{}(*object, *entry.object)) {
+                            throw std::runtime_error{"Base file must be sorted by type, id, and version"};
+                        }
+                        queue.push(detail::merge_entry{object, entry.source});
+                    }
+                }
+
+                if (candidate) {
+                    write(*candidate);
+                }
+
+                reader.close();
+                if (buffer.committed() > 0) {
+                    writer(std::move(buffer));
+                }
+                writer.close();
+
+                stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return stats;
+            }
+
+        }; // class ApplyChanges
+
+    } // namespace changes
+
+} // namespace osmium
+
+#endif // OSMIUM_CHANGES_APPLY_CHANGES_HPP
@@ -0,0 +1,404 @@
+#ifndef OSMIUM_CHANGES_DEDUPLICATOR_HPP
+#define OSMIUM_CHANGES_DEDUPLICATOR_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+
+#include <osmium/handler/check_order.hpp>
+#include <osmium/io/external_sorter.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/misc.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace osmium {
+
+    namespace changes {
+
+        /**
+         * Configuration for the Deduplicator and deduplicate().
+         */
+        struct DeduplicatorConfig {
+
+            /**
+             * Maximum number of distinct objects kept in the window. The
+             * input can be out of order by at most this many objects.
+             */
+            std::size_t window_size = 100000;
+
+            /**
+             * Size of the buffers handed on. Also the amount of garbage
+             * from replaced versions and objects handed on allowed in the
+             * window storage before it is compacted.
+             */
+            std::size_t buffer_size = 1024UL * 1024UL;
+
+            /**
+             * Memory budget for sorting the input if it is not sorted
+             * well enough (deduplicate() only).
+             */
+            std::size_t memory_budget = 1024UL * 1024UL * 1024UL;
+
+            /**
+             * Allow overwriting of an existing output file
+             * (deduplicate() only)?
+             */
+            osmium::io::overwrite overwrite = osmium::io::overwrite::no;
+
+        }; // struct DeduplicatorConfig
+
+        /**
+         * Statistics about one run of deduplicate().
+         */
+        struct DeduplicateStats {
+
+            /// Number of objects read.
+            std::size_t objects_in = 0;
+
+            /// Number of objects written.
+            std::size_t objects_out = 0;
+
+            /// Was the input too far out of order, so it had to be sorted?
+            bool sorted_externally = false;
+
+            /// Wall clock time of the whole run in seconds.
+            double seconds = 0.0;
+
+        }; // struct DeduplicateStats
+
+        namespace detail {
+
+            struct dedup_key {
+
+                osmium::item_type type = osmium::item_type::undefined;
+                bool positive = false;
+                osmium::unsigned_object_id_type id = 0;
+
+                dedup_key() noexcept = default;
+
+                explicit dedup_key(const osmium::OSMObject& object) noexcept :
+                    type(object.type()),
+                    positive(object.id() > 0),
+                    id(object.positive_id()) {
+                }
+
+                friend bool operator<(const dedup_key& lhs, const dedup_key& rhs) noexcept {
+                    return const_tie(lhs.type, lhs.positive, lhs.id) < const_tie(rhs.type, rhs.positive, rhs.id);
+                }
+
+                friend bool operator==(const dedup_key& lhs, const dedup_key& rhs) noexcept {
+                    return lhs.type == rhs.type && lhs.positive == rhs.positive && lhs.id == rhs.id;
+                }
+
+            }; // struct dedup_key
+
+        } // namespace detail
+
+        /**
+         * A pipeline stage keeping only the last version of each object
+         * from a stream sorted by type and id (in the usual order) or
+         * nearly sorted, for instance the objects from several
+         * overlapping change files.
+         *
+         * The newest version of the objects is kept in a window ordered
+         * by type and id. When the window holds more than
+         * DeduplicatorConfig::window_size objects, the first one is
+         * handed on. So the output is sorted and the input can be out of
+         * order by up to that many objects. Of two copies of the same
+         * version the later one wins.
+         *
+         * If an object arrives after an object ordered after it has been
+         * handed on already, an osmium::out_of_order_error is thrown.
+         * Older versions of the object handed on last are dropped
+         * silently, though. Use deduplicate() to fall back to sorting
+         * the input in this case.
+         *
+         * Other entities (changesets) are handed on unchanged.
+         *
+         * @code
+         * osmium::changes::Deduplicator dedup;
+         * while (osmium::memory::Buffer buffer = reader.read()) {
+         *     writer(dedup(buffer));
+         * }
+         * writer(dedup.flush());
+         * @endcode
+         */
+        class Deduplicator {
+
+            DeduplicatorConfig m_config;
+
+            // The objects in the window are stored in m_storage, the map
+            // contains their offsets. Replaced versions and objects handed
+            // on stay in the storage until it is compacted.
+            std::map<detail::dedup_key, std::size_t> m_window{};
+            osmium::memory::Buffer m_storage;
+            std::size_t m_live_bytes = 0;
+
+            detail::dedup_key m_last_key{};
+            osmium::object_version_type m_last_version = 0;
+            bool m_has_last = false;
+
+            std::size_t m_objects_in = 0;
+            std::size_t m_objects_out = 0;
+
+            const osmium::OSMObject& stored(const std::size_t offset) const {
+                return m_storage.get<const osmium::OSMObject>(offset);
+            }
+
+            std::size_t store(const osmium::OSMObject& object) {
+                const std::size_t offset = m_storage.committed();
+                m_storage.add_item(object);
+                m_storage.commit();
+                m_live_bytes += object.padded_size();
+                return offset;
+            }
+
+            void compact() {
+                osmium::memory::Buffer storage{m_live_bytes + m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                for (auto& entry : m_window) {
+                    const std::size_t offset = storage.committed();
+                    storage.add_item(stored(entry.second));
+                    storage.commit();
+                    entry.second = offset;
+                }
+                using std::swap;
+                swap(m_storage, storage);
+            }
+
+            // Compact when more than half of the storage is dead. This keeps
+            // the memory use proportional to the window size and the
+            // amortized cost per object constant.
+            void compact_if_needed() {
+                if (m_storage.committed() > 2 * m_live_bytes + m_config.buffer_size) {
+                    compact();
+                }
+            }
+
+            void hand_on_first(osmium::memory::Buffer& output) {
+                const auto it = m_window.begin();
+                const osmium::OSMObject& object = stored(it->second);
+                output.add_item(object);
+                output.commit();
+                m_last_key = it->first;
+                m_last_version = object.version();
+                m_has_last = true;
+                m_live_bytes -= object.padded_size();
+                m_window.erase(it);
+                ++m_objects_out;
+            }
+
+            void add(const osmium::OSMObject& object, osmium::memory::Buffer& output) {
+                ++m_objects_in;
+                const detail::dedup_key key{object};
+
+                if (m_has_last && !(m_last_key < key)) {
+                    if (key == m_last_key && object.version() <= m_last_version) {
+                        return;
+                    }
+                    throw osmium::out_of_order_error{"Objects are too far out of order for deduplication window", object.id()};
+                }
+
+                const auto it = m_window.lower_bound(key);
+                if (it != m_window.end() && it->first == key) {
+                    const osmium::OSMObject& current = stored(it->second);
+                    if (object.version() < current.version()) {
+                        return;
+                    }
+                    m_live_bytes -= current.padded_size();
+                    it->second = store(object);
+                    compact_if_needed();
+                    return;
+                }
+
+                m_window.emplace_hint(it, key, store(object));
+                if (m_window.size() > m_config.window_size) {
+                    hand_on_first(output);
+                    compact_if_needed();
+                }
+            }
+
+        public:
+
+            explicit Deduplicator(const DeduplicatorConfig& config = DeduplicatorConfig{}) :
+                m_config(config),
+                m_storage(config.buffer_size, osmium::memory::Buffer::auto_grow::yes) {
+            }
+
+            /**
+             * Add all objects from the input buffer.
+             *
+             * @returns Buffer with the objects that left the window (can
+             *          be empty).
+             * @throws osmium::out_of_order_error If the input is too far
+             *         out of order.
+             */
+            osmium::memory::Buffer operator()(const osmium::memory::Buffer& input) {
+                osmium::memory::Buffer output{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+
+                for (const auto& entity : input) {
+                    if (entity.type() >= osmium::item_type::node && entity.type() <= osmium::item_type::relation) {
+                        add(static_cast<const osmium::OSMObject&>(entity), output);
+                    } else {
+                        output.add_item(entity);
+                        output.commit();
+                    }
+                }
+
+                return output;
+            }
+
+            /**
+             * Hand on all objects still in the window. Call this at the
+             * end of the input.
+             */
+            osmium::memory::Buffer flush() {
+                osmium::memory::Buffer output{m_live_bytes + 1024, osmium::memory::Buffer::auto_grow::yes};
+                while (!m_window.empty()) {
+                    hand_on_first(output);
+                }
+                m_storage.clear();
+                m_live_bytes = 0;
+                return output;
+            }
+
+            /// Number of objects added so far.
+            std::size_t objects_in() const noexcept {
+                return m_objects_in;
+            }
+
+            /// Number of objects handed on so far.
+            std::size_t objects_out() const noexcept {
+                return m_objects_out;
+            }
+
+        }; // class Deduplicator
+
+        /**
+         * Copy the input file to the output file keeping only the last
+         * version of each object using the Deduplicator. If the input is
+         * too far out of order for the window, the input is read again,
+         * sorted with the osmium::io::ExternalSorter and the sorted data
+         * is deduplicated. The output file written so far is overwritten
+         * in this case.
+         *
+         * Deleted objects are kept. Their visible flag is only written if
+         * the output is a history file (for instance with the suffix
+         * .osh.pbf) or a change file.
+         *
+         * @returns Statistics about this run.
+         * @throws osmium::out_of_order_error If the input is too far out
+         *         of order and is read from stdin or the output is
+         *         written to stdout.
+         * @throws Any exception the Readers or the Writer throw.
+         */
+        inline DeduplicateStats deduplicate(const osmium::io::File& input,
+                                            const osmium::io::File& output,
+                                            const DeduplicatorConfig& config = DeduplicatorConfig{},
+                                            osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+            DeduplicateStats stats;
+            const auto start = std::chrono::steady_clock::now();
+
+            try {
+                osmium::io::Reader reader{input, osmium::osm_entity_bits::nwr};
+                osmium::io::Header header{reader.header()};
+                header.set_has_multiple_object_versions(false);
+                osmium::io::Writer writer{output, header, config.overwrite};
+
+                Deduplicator dedup{config};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    writer(dedup(buffer));
+                }
+                writer(dedup.flush());
+                writer.close();
+                reader.close();
+
+                stats.objects_in = dedup.objects_in();
+                stats.objects_out = dedup.objects_out();
+                stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return stats;
+            } catch (const osmium::out_of_order_error&) {
+                if (input.filename().empty() || input.buffer() || output.filename().empty()) {
+                    throw;
+                }
+            }
+
+            osmium::io::ExternalSorterConfig sorter_config;
+            sorter_config.memory_budget = config.memory_budget;
+            sorter_config.buffer_size = config.buffer_size;
+            osmium::io::ExternalSorter sorter{input, sorter_config};
+
+            // The output file is ours now, it was written partially.
+            Deduplicator dedup{config};
+            std::unique_ptr<osmium::io::Writer> writer;
+            const auto open = [&]() {
+                if (!writer) {
+                    osmium::io::Header header{sorter.header()};
+                    header.set_has_multiple_object_versions(false);
+                    writer.reset(new osmium::io::Writer{output, header, osmium::io::overwrite::allow});
+                }
+            };
+
+            sorter.sort([&](osmium::memory::Buffer&& buffer) {
+                open();
+                (*writer)(dedup(buffer));
+            }, pool);
+            open();
+            (*writer)(dedup.flush());
+            writer->close();
+
+            stats.objects_in = dedup.objects_in();
+            stats.objects_out = dedup.objects_out();
+            stats.sorted_externally = true;
+            stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return stats;
+        }
+
+    } // namespace changes
+
+} // namespace osmium
+
+#endif // OSMIUM_CHANGES_DEDUPLICATOR_HPP
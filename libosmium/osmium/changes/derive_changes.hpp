@@ -0,0 +1,354 @@
+#ifndef OSMIUM_CHANGES_DERIVE_CHANGES_HPP
+#define OSMIUM_CHANGES_DERIVE_CHANGES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/changes/detail/object_source.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/misc.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace osmium {
+
+    namespace changes {
+
+        /**
+         * Configuration for DeriveChanges.
+         */
+        struct DeriveChangesConfig {
+
+            /**
+             * Only look at the tags, the node location, the way nodes,
+             * and the relation members when comparing objects, not at
+             * the version, timestamp, changeset, uid, and user. Objects
+             * where only those changed are not written to the output.
+             */
+            bool ignore_metadata = false;
+
+            /**
+             * Increment the version of deleted objects. Set this if the
+             * change file will be applied with tools that expect the
+             * version of the deletion in delete sections.
+             */
+            bool increment_version = false;
+
+            /**
+             * Objects are collected in a buffer of this size before they
+             * are handed to the Writer.
+             */
+            std::size_t buffer_size = 1024UL * 1024UL;
+
+            /**
+             * Allow overwriting of an existing output file?
+             */
+            osmium::io::overwrite overwrite = osmium::io::overwrite::no;
+
+        }; // struct DeriveChangesConfig
+
+        /**
+         * Statistics about one run of DeriveChanges.
+         */
+        struct DeriveChangesStats {
+
+            /// Number of objects read from the old file.
+            std::size_t old_objects = 0;
+
+            /// Number of objects read from the new file.
+            std::size_t new_objects = 0;
+
+            /// Number of objects only in the new file.
+            std::size_t created = 0;
+
+            /// Number of objects that are different in the new file.
+            std::size_t modified = 0;
+
+            /// Number of objects only in the old file.
+            std::size_t deleted = 0;
+
+            /// Wall clock time of the whole run in seconds.
+            double seconds = 0.0;
+
+            /**
+             * Throughput of the run: Number of objects read from both
+             * files per second.
+             */
+            double objects_per_second() const noexcept {
+                if (seconds <= 0.0) {
+                    return 0.0;
+                }
+                return static_cast<double>(old_objects + new_objects) / seconds;
+            }
+
+        }; // struct DeriveChangesStats
+
+        namespace detail {
+
+            inline bool less_type_id(const osmium::OSMObject& lhs, const osmium::OSMObject& rhs) noexcept {
+                return const_tie(lhs.type(), lhs.id() > 0, lhs.positive_id()) <
+                       const_tie(rhs.type(), rhs.id() > 0, rhs.positive_id());
+            }
+
+            /**
+             * Compare tag lists. The tags are stored as a sequence of
+             * zero-terminated keys and values followed by zero padding,
+             * so equal tag lists have the same bytes.
+             */
+            inline bool equal_tags(const osmium::TagList& lhs, const osmium::TagList& rhs) noexcept {
+                if (lhs.empty() || rhs.empty()) {
+                    return lhs.empty() && rhs.empty();
+                }
+                return lhs.byte_size() == rhs.byte_size() &&
+                       !std::memcmp(lhs.data() + sizeof(osmium::TagList),
+                                    rhs.data() + sizeof(osmium::TagList),
+                                    lhs.byte_size() - sizeof(osmium::TagList));
+            }
+
+            inline bool equal_nodes(const osmium::WayNodeList& lhs, const osmium::WayNodeList& rhs) noexcept {
+                if (lhs.size() != rhs.size()) {
+                    return false;
+                }
+                auto it = rhs.cbegin();
+                for (const auto& node_ref : lhs) {
+                    if (node_ref.ref() != it->ref()) {
+                        return false;
+                    }
+                    ++it;
+                }
+                return true;
+            }
+
+            inline bool equal_members(const osmium::RelationMemberList& lhs, const osmium::RelationMemberList& rhs) noexcept {
+                if (lhs.size() != rhs.size()) {
+                    return false;
+                }
+                auto it = rhs.cbegin();
+                for (const auto& member : lhs) {
+                    if (member.type() != it->type() ||
+                        member.ref() != it->ref() ||
+                        std::strcmp(member.role(), it->role()) != 0) {
+                        return false;
+                    }
+                    ++it;
+                }
+                return true;
+            }
+
+            /**
+             * Compare two objects with the same type and id. The cheap
+             * comparisons are done first.
+             */
+            inline bool equal_objects(const osmium::OSMObject& lhs, const osmium::OSMObject& rhs, const bool ignore_metadata) noexcept {
+                if (lhs.visible() != rhs.visible()) {
+                    return false;
+                }
+
+                if (!ignore_metadata) {
+                    if (lhs.version() != rhs.version() ||
+                        lhs.timestamp() != rhs.timestamp() ||
+                        lhs.changeset() != rhs.changeset() ||
+                        lhs.uid() != rhs.uid() ||
+                        std::strcmp(lhs.user(), rhs.user()) != 0) {
+                        return false;
+                    }
+                }
+
+                switch (lhs.type()) {
+                    case osmium::item_type::node:
+                        if (static_cast<const osmium::Node&>(lhs).location() != static_cast<const osmium::Node&>(rhs).location()) {
+                            return false;
+                        }
+                        break;
+                    case osmium::item_type::way:
+                        if (!equal_nodes(static_cast<const osmium::Way&>(lhs).nodes(), static_cast<const osmium::Way&>(rhs).nodes())) {
+                            return false;
+                        }
+                        break;
+                    case osmium::item_type::relation:
+                        if (!equal_members(static_cast<const osmium::Relation&>(lhs).members(), static_cast<const osmium::Relation&>(rhs).members())) {
+                            return false;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+
+                return equal_tags(lhs.tags(), rhs.tags());
+            }
+
+        } // namespace detail
+
+        /**
+         * Compute the changes between two snapshots of OSM data and write
+         * them to a change file.
+         *
+         * Both input files must be sorted by type and id and must not be
+         * history files. They are read in lockstep, each by its own Reader
+         * decoding in the background, so only a few buffers of each are
+         * in memory at any time. Objects are compared field by field (see
+         * detail::equal_objects()), which is exact and about as fast as
+         * hashing both objects would be.
+         *
+         * Objects only in the new file and objects that changed are
+         * written as they are in the new file, objects only in the old
+         * file are written with the visible flag cleared. The output is
+         * usually an .osc file; the OSC writer puts objects with version 1
+         * into create sections, other objects into modify sections, and
+         * deleted objects into delete sections.
+         *
+         * @code
+         * osmium::changes::DeriveChanges derive{osmium::io::File{"old.osm.pbf"},
+         *                                       osmium::io::File{"new.osm.pbf"}};
+         * const auto stats = derive(osmium::io::File{"changes.osc.gz"});
+         * std::cout << stats.objects_per_second() << " objects/s\n";
+         * @endcode
+         */
+        class DeriveChanges {
+
+            osmium::io::File m_old;
+            osmium::io::File m_new;
+            DeriveChangesConfig m_config;
+
+        public:
+
+            DeriveChanges(const osmium::io::File& old_file, const osmium::io::File& new_file, const DeriveChangesConfig& config = DeriveChangesConfig{}) :
+                m_old(old_file),
+                m_new(new_file),
+                m_config(config) {
+            }
+
+            /**
+             * Compare the old and new files and write the changes to the
+             * output file.
+             *
+             * @returns Statistics about this run.
+             * @throws std::runtime_error If an input file is not sorted.
+             * @throws Any exception the Readers or the Writer throw.
+             */
+            DeriveChangesStats operator()(const osmium::io::File& output) {
+                DeriveChangesStats stats;
+                const auto start = std::chrono::steady_clock::now();
+
+                osmium::io::Reader old_reader{m_old, osmium::osm_entity_bits::nwr};
+                osmium::io::Reader new_reader{m_new, osmium::osm_entity_bits::nwr};
+                detail::object_source old_source{old_reader};
+                detail::object_source new_source{new_reader};
+
+                osmium::io::Header header{new_reader.header()};
+                header.set_has_multiple_object_versions(true);
+                osmium::io::Writer writer{output, header, m_config.overwrite};
+
+                osmium::memory::Buffer buffer{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                const auto flush = [&]() {
+                    if (buffer.committed() >= m_config.buffer_size) {
+                        writer(std::move(buffer));
+                        buffer = osmium::memory::Buffer{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                    }
+                };
+
+                // Get the next object from the source, checking the order.
+                const auto next = [](detail::object_source& source, const osmium::OSMObject* last, std::size_t& count) {
+                    const osmium::OSMObject* object = source.next();
+                    if (object) {
+                        ++count;
+                        if (last && !detail::less_type_id(*last, *object)) {
+                            throw std::runtime_error{"Input files must be sorted by type and id"};
+                        }
+                    }
+                    return object;
+                };
+
+                const osmium::OSMObject* old_object = next(old_source, nullptr, stats.old_objects);
+                const osmium::OSMObject* new_object = next(new_source, nullptr, stats.new_objects);
+
+                while (old_object || new_object) {
+                    if (!new_object || (old_object && detail::less_type_id(*old_object, *new_object))) {
+                        auto& deleted = buffer.add_item(*old_object);
+                        buffer.commit();
+                        deleted.set_visible(false);
+                        if (m_config.increment_version) {
+                            deleted.set_version(old_object->version() + 1);
+                        }
+                        ++stats.deleted;
+                        old_object = next(old_source, old_object, stats.old_objects);
+                    } else if (!old_object || detail::less_type_id(*new_object, *old_object)) {
+                        buffer.add_item(*new_object);
+                        buffer.commit();
+                        ++stats.created;
+                        new_object = next(new_source, new_object, stats.new_objects);
+                    } else {
+                        if (!detail::equal_objects(*old_object, *new_object, m_config.ignore_metadata)) {
+                            buffer.add_item(*new_object);
+                            buffer.commit();
+                            ++stats.modified;
+                        }
+                        old_object = next(old_source, old_object, stats.old_objects);
+                        new_object = next(new_source, new_object, stats.new_objects);
+                    }
+                    flush();
+                }
+
+                old_reader.close();
+                new_reader.close();
+                if (buffer.committed() > 0) {
+                    writer(std::move(buffer));
+                }
+                writer.close();
+
+                stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return stats;
+            }
+
+        }; // class DeriveChanges
+
+    } // namespace changes
+
+} // namespace osmium
+
+#endif // OSMIUM_CHANGES_DERIVE_CHANGES_HPP
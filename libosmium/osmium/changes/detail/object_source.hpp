@@ -0,0 +1,96 @@
+#ifndef OSMIUM_CHANGES_DETAIL_OBJECT_SOURCE_HPP
+#define OSMIUM_CHANGES_DETAIL_OBJECT_SOURCE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <utility>
+
+namespace osmium {
+
+    namespace changes {
+
+        namespace detail {
+
+            /**
+             * Objects from a Reader in the order they are in the file.
+             * The buffer before the current one is kept, so the object
+             * returned by the previous call to next() is still valid.
+             */
+            class object_source {
+
+                osmium::io::Reader& m_reader;
+                osmium::memory::Buffer m_buffer{};
+                osmium::memory::Buffer m_previous{};
+                osmium::memory::Buffer::t_const_iterator<osmium::OSMObject> m_it{};
+                osmium::memory::Buffer::t_const_iterator<osmium::OSMObject> m_end{};
+                bool m_done = false;
+
+            public:
+
+                explicit object_source(osmium::io::Reader& reader) :
+                    m_reader(reader) {
+                }
+
+                /**
+                 * Get the next object or nullptr at the end of the input.
+                 */
+                const osmium::OSMObject* next() {
+                    while (m_it == m_end) {
+                        if (m_done) {
+                            return nullptr;
+                        }
+                        m_previous = std::move(m_buffer);
+                        m_buffer = m_reader.read();
+                        if (!m_buffer) {
+                            m_done = true;
+                            return nullptr;
+                        }
+                        m_it = m_buffer.cbegin<osmium::OSMObject>();
+                        m_end = m_buffer.cend<osmium::OSMObject>();
+                    }
+                    return &*m_it++;
+                }
+
+            }; // class object_source
+
+        } // namespace detail
+
+    } // namespace changes
+
+} // namespace osmium
+
+#endif // OSMIUM_CHANGES_DETAIL_OBJECT_SOURCE_HPP
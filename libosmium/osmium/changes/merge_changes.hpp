@@ -0,0 +1,236 @@
+#ifndef OSMIUM_CHANGES_MERGE_CHANGES_HPP
+#define OSMIUM_CHANGES_MERGE_CHANGES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+
+#include <osmium/changes/apply_changes.hpp>
+#include <osmium/io/data_ranges.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace changes {
+
+        /**
+         * Configuration for MergeChanges.
+         */
+        struct MergeChangesConfig {
+
+            /**
+             * Keep all versions of all objects instead of only the newest
+             * version of each object.
+             */
+            bool with_history = false;
+
+            /**
+             * Initial size of the buffer with the merged changes. It grows
+             * as needed.
+             */
+            std::size_t buffer_size = 1024UL * 1024UL;
+
+        }; // struct MergeChangesConfig
+
+        /**
+         * Merges change files into one change in memory, sorted by type,
+         * id, and version. Usually only the newest version of each object
+         * is kept (deleted objects are kept, too, they are changes after
+         * all).
+         *
+         * Change files can be added incrementally. Each call to
+         * add_change_files() reads only the new files and merges them
+         * into the changes collected so far, so an update loop never has
+         * to read the same change file twice. Objects from files added
+         * later replace the same version from files added earlier.
+         *
+         * The result can be applied with ApplyChanges::add_changes() or
+         * written out as one change file which can then be read by a
+         * Reader.
+         *
+         * @code
+         * osmium::changes::ReplicationDirectory dir{"/data/replication/minute"};
+         * osmium::changes::MergeChanges merged;
+         * merged.add_change_files(dir.change_files(last.sequence_number, current.sequence_number));
+         * merged.write(osmium::io::File{"merged.osc.gz"});
+         * @endcode
+         */
+        class MergeChanges {
+
+            MergeChangesConfig m_config;
+            osmium::memory::Buffer m_buffer;
+            std::size_t m_objects = 0;
+            std::size_t m_files = 0;
+
+        public:
+
+            explicit MergeChanges(const MergeChangesConfig& config = MergeChangesConfig{}) :
+                m_config(config),
+                m_buffer(config.buffer_size, osmium::memory::Buffer::auto_grow::yes) {
+            }
+
+            /**
+             * Read the change files and merge them into the changes
+             * collected so far. All files are merged in one pass, which
+             * is faster than adding them one by one.
+             *
+             * @throws Any exception the Reader throws.
+             */
+            void add_change_files(const std::vector<osmium::io::File>& files) {
+                if (files.empty()) {
+                    return;
+                }
+
+                // Source 0 are the changes merged so far, source i+1 is
+                // change file i.
+                std::vector<detail::change_list> changes;
+                changes.reserve(files.size() + 1);
+                changes.emplace_back(m_buffer);
+                for (const auto& file : files) {
+                    changes.emplace_back(file);
+                }
+
+                std::priority_queue<detail::merge_entry, std::vector<detail::merge_entry>, detail::merge_entry_greater> queue;
+                for (std::size_t source = 0; source < changes.size(); ++source) {
+                    if (const osmium::OSMObject* object = changes[source].next()) {
+                        queue.push(detail::merge_entry{object, source});
+                    }
+                }
+
+                osmium::memory::Buffer buffer{std::max(m_config.buffer_size, m_buffer.committed()), osmium::memory::Buffer::auto_grow::yes};
+                std::size_t objects = 0;
+                const auto write = [&](const osmium::OSMObject& object) {
+                    buffer.add_item(object);
+                    buffer.commit();
+                    ++objects;
+                };
+
+                // All objects are in memory, so unlike in ApplyChanges
+                // the candidate stays valid however long it is kept.
+                const osmium::OSMObject* candidate = nullptr;
+                while (!queue.empty()) {
+                    const detail::merge_entry entry = queue.top();
+                    queue.pop();
+
+                    if (candidate) {
+                        const bool same = m_config.with_history ? detail::same_type_id_version(*candidate, *entry.object)
+                                                                : detail::same_type_id(*candidate, *entry.object);
+                        if (!same) {
+                            write(*candidate);
+                        }
+                    }
+                    candidate = entry.object;
+
+                    if (const osmium::OSMObject* object = changes[entry.source].next()) {
+                        queue.push(detail::merge_entry{object, entry.source});
+                    }
+                }
+
+                if (candidate) {
+                    write(*candidate);
+                }
+
+                m_buffer = std::move(buffer);
+                m_objects = objects;
+                m_files += files.size();
+            }
+
+            /**
+             * Read the change file and merge it into the changes collected
+             * so far.
+             *
+             * @throws Any exception the Reader throws.
+             */
+            void add_change_file(const osmium::io::File& file) {
+                add_change_files(std::vector<osmium::io::File>{file});
+            }
+
+            /**
+             * The merged changes sorted by type, id, and version.
+             */
+            const osmium::memory::Buffer& buffer() const noexcept {
+                return m_buffer;
+            }
+
+            /// The number of objects in the merged changes.
+            std::size_t size() const noexcept {
+                return m_objects;
+            }
+
+            /// The number of change files merged so far.
+            std::size_t files() const noexcept {
+                return m_files;
+            }
+
+            /**
+             * Forget all changes collected so far.
+             */
+            void clear() {
+                m_buffer.clear();
+                m_objects = 0;
+                m_files = 0;
+            }
+
+            /**
+             * Write the merged changes to a file, usually in .osc format.
+             *
+             * @throws Any exception the Writer throws.
+             */
+            void write(const osmium::io::File& output, const osmium::io::overwrite overwrite = osmium::io::overwrite::no) const {
+                osmium::io::Header header;
+                header.set_has_multiple_object_versions(m_config.with_history);
+                header.data_ranges(osmium::io::DataRanges{}.add(m_buffer));
+                osmium::io::Writer writer{output, header, overwrite};
+                for (const auto& object : m_buffer.select<osmium::OSMObject>()) {
+                    writer(object);
+                }
+                writer.close();
+            }
+
+        }; // class MergeChanges
+
+    } // namespace changes
+
+} // namespace osmium
+
+#endif // OSMIUM_CHANGES_MERGE_CHANGES_HPP
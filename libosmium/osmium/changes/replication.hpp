@@ -0,0 +1,332 @@
+#ifndef OSMIUM_CHANGES_REPLICATION_HPP
+#define OSMIUM_CHANGES_REPLICATION_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+
+#include <osmium/io/file.hpp>
+#include <osmium/osm/timestamp.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a replication state file can not be read or
+     * parsed or when a replication directory doesn't contain the files
+     * needed.
+     */
+    struct replication_error : public std::runtime_error {
+
+        explicit replication_error(const std::string& what) :
+            std::runtime_error(what) {
+        }
+
+        explicit replication_error(const char* what) :
+            std::runtime_error(what) {
+        }
+
+    }; // struct replication_error
+
+    namespace changes {
+
+        /**
+         * The state of a replication source as found in the state.txt
+         * files: The sequence number of a change file and the timestamp
+         * up to which it contains the changes.
+         */
+        struct ReplicationState {
+
+            uint64_t sequence_number = 0;
+            osmium::Timestamp timestamp{};
+
+        }; // struct ReplicationState
+
+        /**
+         * Parse the contents of a replication state file. These are Java
+         * properties files, lines starting with '#' are comments and
+         * colons in the values are escaped with a backslash. Only the
+         * sequenceNumber and timestamp properties are used.
+         *
+         * @throws osmium::replication_error If one of them is missing or
+         *         invalid.
+         */
+        inline ReplicationState parse_replication_state(const std::string& data) {
+            ReplicationState state;
+            bool has_sequence_number = false;
+            bool has_timestamp = false;
+
+            std::istringstream stream{data};
+            std::string line;
+            while (std::getline(stream, line)) {
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (line.empty() || line[0] == '#') {
+                    continue;
+                }
+                const auto pos = line.find('=');
+                if (pos == std::string::npos) {
+                    continue;
+                }
+                const std::string key{line.substr(0, pos)};
+                std::string value;
+                for (auto it = line.begin() + pos + 1; it != line.end(); ++it) {
+                    if (*it != '\\') {
+                        value += *it;
+                    }
+                }
+
+                if (key == "sequenceNumber") {
+                    if (value.empty() || value.size() > 18 || value.find_first_not_of("0123456789") != std::string::npos) {
+                        throw osmium::replication_error{"invalid sequenceNumber in replication state: " + value};
+                    }
+                    state.sequence_number = std::stoull(value);
+                    has_sequence_number = true;
+                } else if (key == "timestamp") {
+                    try {
+                        state.timestamp = osmium::Timestamp{value};
+                    } catch (const std::invalid_argument&) {
+                        throw osmium::replication_error{"invalid timestamp in replication state: " + value};
+                    }
+                    has_timestamp = true;
+                }
+            }
+
+            if (!has_sequence_number || !has_timestamp) {
+                throw osmium::replication_error{"replication state needs sequenceNumber and timestamp"};
+            }
+
+            return state;
+        }
+
+        /**
+         * Read and parse a replication state file.
+         *
+         * @throws osmium::replication_error If the file can not be read
+         *         or parsed.
+         */
+        inline ReplicationState read_replication_state(const std::string& filename) {
+            std::ifstream file{filename};
+            if (!file.is_open()) {
+                throw osmium::replication_error{"can not open replication state file '" + filename + "'"};
+            }
+            std::ostringstream data;
+            data << file.rdbuf();
+            return parse_replication_state(data.str());
+        }
+
+        /**
+         * Access to a local directory with replication files in the usual
+         * layout (for instance a mirror of the minutely diffs from
+         * planet.osm.org): The current state is in state.txt, the change
+         * file and state for sequence number 1234567 are in
+         * 001/234/567.osc.gz and 001/234/567.state.txt.
+         *
+         * @code
+         * osmium::changes::ReplicationDirectory dir{"/data/replication/minute"};
+         * const auto current = dir.state();
+         * for (const auto& file : dir.change_files(last.sequence_number, current.sequence_number)) {
+         *     ...
+         * }
+         * @endcode
+         */
+        class ReplicationDirectory {
+
+            std::string m_directory;
+
+        public:
+
+            /**
+             * Use the replication files in the given directory.
+             */
+            explicit ReplicationDirectory(std::string directory) :
+                m_directory(std::move(directory)) {
+                if (!m_directory.empty() && m_directory.back() == '/') {
+                    m_directory.pop_back();
+                }
+            }
+
+            const std::string& directory() const noexcept {
+                return m_directory;
+            }
+
+            /**
+             * The path of the files for a sequence number relative to the
+             * replication directory and without suffix, for instance
+             * "001/234/567" for 1234567.
+             *
+             * @throws osmium::replication_error If the sequence number has
+             *         more than 9 digits.
+             */
+            static std::string sequence_path(const uint64_t sequence_number) {
+                if (sequence_number > 999999999ULL) {
+                    throw osmium::replication_error{"sequence number too large: " + std::to_string(sequence_number)};
+                }
+                char path[32];
+                std::snprintf(path, sizeof(path), "%03u/%03u/%03u",
+                              static_cast<unsigned int>(sequence_number / 1000000),
+                              static_cast<unsigned int>(sequence_number / 1000 % 1000),
+                              static_cast<unsigned int>(sequence_number % 1000));
+                return path;
+            }
+
+            /// Name of the file with the current state.
+            std::string state_file_name() const {
+                return m_directory + "/state.txt";
+            }
+
+            /// Name of the state file for a sequence number.
+            std::string state_file_name(const uint64_t sequence_number) const {
+                return m_directory + '/' + sequence_path(sequence_number) + ".state.txt";
+            }
+
+            /// Name of the change file for a sequence number.
+            std::string change_file_name(const uint64_t sequence_number) const {
+                return m_directory + '/' + sequence_path(sequence_number) + ".osc.gz";
+            }
+
+            /**
+             * Read the current state.
+             *
+             * @throws osmium::replication_error If it can not be read.
+             */
+            ReplicationState state() const {
+                return read_replication_state(state_file_name());
+            }
+
+            /**
+             * Read the state for a sequence number.
+             *
+             * @throws osmium::replication_error If it can not be read.
+             */
+            ReplicationState state(const uint64_t sequence_number) const {
+                return read_replication_state(state_file_name(sequence_number));
+            }
+
+            /**
+             * Is the state file for this sequence number available?
+             */
+            bool has_state(const uint64_t sequence_number) const {
+                return std::ifstream{state_file_name(sequence_number)}.is_open();
+            }
+
+            /**
+             * Find the newest sequence number whose state timestamp is not
+             * after the given timestamp. Applying all change files after
+             * it brings data as of that timestamp up to date. This is a
+             * binary search needing only about log2(n) state files.
+             *
+             * Mirrors often only keep the newer files. Missing state files
+             * are assumed to be older than all existing ones.
+             *
+             * @throws osmium::replication_error If the directory doesn't
+             *         go back far enough.
+             */
+            uint64_t sequence_for_timestamp(const osmium::Timestamp& timestamp) const {
+                const ReplicationState current = state();
+                if (current.timestamp <= timestamp) {
+                    return current.sequence_number;
+                }
+
+                // Invariant: lo is missing or not after the timestamp,
+                // hi is after the timestamp.
+                uint64_t lo = 0;
+                uint64_t hi = current.sequence_number;
+                while (hi - lo > 1) {
+                    const uint64_t mid = lo + (hi - lo) / 2;
+                    if (!has_state(mid) || state(mid).timestamp <= timestamp) {
+                        lo = mid;
+                    } else {
+                        hi = mid;
+                    }
+                }
+
+                if (!has_state(lo)) {
+                    throw osmium::replication_error{"replication directory '" + m_directory + "' doesn't go back to " + timestamp.to_iso()};
+                }
+
+                return lo;
+            }
+
+            /**
+             * The change files needed to get from the state with sequence
+             * number from to the state with sequence number to, ie. the
+             * files for the sequence numbers from+1 to to. They are
+             * returned in order.
+             *
+             * @throws osmium::replication_error If from is larger than to
+             *         or a change file is missing.
+             */
+            std::vector<osmium::io::File> change_files(const uint64_t from, const uint64_t to) const {
+                if (from > to) {
+                    throw osmium::replication_error{"invalid sequence number range"};
+                }
+
+                std::vector<osmium::io::File> files;
+                files.reserve(to - from);
+                for (uint64_t sequence_number = from + 1; sequence_number <= to; ++sequence_number) {
+                    std::string name{change_file_name(sequence_number)};
+                    if (!std::ifstream{name}.is_open()) {
+                        throw osmium::replication_error{"missing change file '" + name + "'"};
+                    }
+                    files.emplace_back(std::move(name));
+                }
+
+                return files;
+            }
+
+            /**
+             * The change files needed to get from the given state to the
+             * current state.
+             *
+             * @throws osmium::replication_error If a file is missing.
+             */
+            std::vector<osmium::io::File> change_files_since(const ReplicationState& last) const {
+                return change_files(last.sequence_number, state().sequence_number);
+            }
+
+        }; // class ReplicationDirectory
+
+    } // namespace changes
+
+} // namespace osmium
+
+#endif // OSMIUM_CHANGES_REPLICATION_HPP
@@ -51,7 +51,9 @@ namespace osmium {
      * underlying OSMObjects.
      *
      * Note that this class uses a mutable member variable internally.
-     * It can not be used safely in multiple threads!
+     * It can not be used safely in multiple threads! To process a
+     * history file in parallel, use apply_diff_parallel() from
+     * diff_parallel.hpp.
      */
     template <typename TBasicIterator>
     class DiffIterator {
@@ -0,0 +1,314 @@
+#ifndef OSMIUM_DIFF_PARALLEL_HPP
+#define OSMIUM_DIFF_PARALLEL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/diff_visitor.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item_iterator.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <type_traits>
+#include <utility>
+
+namespace osmium {
+
+    /**
+     * Part of a history file containing all versions of a number of
+     * objects. Because no object is split between partitions, diff
+     * handlers can work on different partitions in parallel.
+     *
+     * A partition consists of a (usually small) buffer with copies of
+     * the objects that were split between buffers read from the source
+     * and a range of objects in a buffer read from the source. It can
+     * only be moved, not copied.
+     */
+    class DiffPartition {
+
+        osmium::memory::Buffer m_head{};
+        osmium::memory::Buffer m_buffer{};
+        std::size_t m_begin = 0;
+        std::size_t m_end = 0;
+
+    public:
+
+        DiffPartition() = default;
+
+        /**
+         * Create a partition from all objects in the head buffer
+         * followed by the objects in the given buffer between the
+         * offsets begin and end. Usually you don't call this yourself,
+         * partitions are created by the DiffPartitioner.
+         */
+        DiffPartition(osmium::memory::Buffer&& head, osmium::memory::Buffer&& buffer, std::size_t begin, std::size_t end) :
+            m_head(std::move(head)),
+            m_buffer(std::move(buffer)),
+            m_begin(begin),
+            m_end(end) {
+        }
+
+        /// Is this partition empty?
+        bool empty() const noexcept {
+            return m_head.committed() == 0 && m_begin == m_end;
+        }
+
+        /**
+         * In a bool context any non-empty partition is true.
+         */
+        explicit operator bool() const noexcept {
+            return !empty();
+        }
+
+        /**
+         * Apply the diff handlers to all objects in this partition
+         * in order.
+         */
+        template <typename... THandlers>
+        void apply(THandlers&... handlers) const {
+            using iterator = osmium::memory::ItemIterator<const osmium::OSMObject>;
+            if (m_head.committed() > 0) {
+                osmium::apply_diff(m_head.cbegin<osmium::OSMObject>(), m_head.cend<osmium::OSMObject>(), handlers...);
+            }
+            if (m_begin != m_end) {
+                const unsigned char* const end = m_buffer.data() + m_end;
+                osmium::apply_diff(iterator{m_buffer.data() + m_begin, end}, iterator{end, end}, handlers...);
+            }
+        }
+
+    }; // class DiffPartition
+
+    /**
+     * Read buffers from a source (usually a Reader) of a history file
+     * sorted by type, id, and version and return them as DiffPartitions,
+     * so that all versions of an object are in the same partition.
+     *
+     * The versions of the last object in each buffer are copied and
+     * moved to the next partition together with any further versions of
+     * that object at the beginning of the next buffer. All other objects
+     * stay where they are.
+     */
+    template <typename TSource>
+    class DiffPartitioner {
+
+        TSource& m_source;
+
+        // Versions of the last object of the previous buffer.
+        osmium::memory::Buffer m_rest{};
+        osmium::item_type m_rest_type = osmium::item_type::undefined;
+        osmium::object_id_type m_rest_id = 0;
+
+        bool m_done = false;
+
+        static void copy_objects(const osmium::memory::Buffer& from, std::size_t begin, std::size_t end, osmium::memory::Buffer& to) {
+            using iterator = osmium::memory::ItemIterator<const osmium::OSMObject>;
+            if (!to) {
+                to = osmium::memory::Buffer{end - begin, osmium::memory::Buffer::auto_grow::yes};
+            }
+            const unsigned char* const last = from.data() + end;
+            for (iterator it{from.data() + begin, last}; it != iterator{last, last}; ++it) {
+                to.add_item(*it);
+                to.commit();
+            }
+        }
+
+    public:
+
+        explicit DiffPartitioner(TSource& source) :
+            m_source(source) {
+        }
+
+        /**
+         * Get the next partition. Returns an empty partition at the end
+         * of the input.
+         */
+        DiffPartition read() {
+            while (!m_done) {
+                osmium::memory::Buffer buffer = m_source.read();
+                if (!buffer) {
+                    m_done = true;
+                    break;
+                }
+
+                // Type and id of the current object. Objects with the
+                // same type and id as the rest belong to the rest.
+                osmium::item_type type = m_rest.committed() > 0 ? m_rest_type : osmium::item_type::undefined;
+                osmium::object_id_type id = m_rest_id;
+
+                // Offset of the first object not belonging to the rest
+                // and offset of the first version of the last object.
+                std::size_t begin = buffer.committed();
+                std::size_t last_start = 0;
+
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    if (object.type() != type || object.id() != id) {
+                        const auto offset = static_cast<std::size_t>(object.data() - buffer.data());
+                        if (begin == buffer.committed()) {
+                            begin = offset;
+                        }
+                        last_start = offset;
+                        type = object.type();
+                        id = object.id();
+                    }
+                }
+
+                if (begin == buffer.committed()) {
+                    // The whole buffer contains versions of the object
+                    // at the end of the previous buffer.
+                    copy_objects(buffer, 0, begin, m_rest);
+                    continue;
+                }
+
+                osmium::memory::Buffer head{std::move(m_rest)};
+                if (begin > 0) {
+                    copy_objects(buffer, 0, begin, head);
+                }
+
+                m_rest = osmium::memory::Buffer{};
+                copy_objects(buffer, last_start, buffer.committed(), m_rest);
+                m_rest_type = type;
+                m_rest_id = id;
+
+                DiffPartition partition{std::move(head), std::move(buffer), begin, last_start};
+                if (partition) {
+                    return partition;
+                }
+            }
+
+            if (m_rest.committed() > 0) {
+                return DiffPartition{std::move(m_rest), osmium::memory::Buffer{}, 0, 0};
+            }
+
+            return DiffPartition{};
+        }
+
+    }; // class DiffPartitioner
+
+    namespace detail {
+
+        template <typename TFunc, typename TResult>
+        class diff_partition_task {
+
+            DiffPartition m_partition;
+            TFunc* m_func;
+
+        public:
+
+            diff_partition_task(DiffPartition&& partition, TFunc& func) :
+                m_partition(std::move(partition)),
+                m_func(&func) {
+            }
+
+            TResult operator()() {
+                return (*m_func)(m_partition);
+            }
+
+        }; // class diff_partition_task
+
+    } // namespace detail
+
+    /**
+     * Process a history file sorted by type, id, and version in
+     * parallel. The input from the source (usually a Reader) is split
+     * into DiffPartitions, each containing all versions of some objects.
+     * The function func is called for each partition in the threads of
+     * the pool. Usually it creates diff handlers, calls apply() on the
+     * partition, and returns whatever the handlers found, for instance
+     * a buffer with new objects. The function output is called in the
+     * calling thread with those results in the order of the input, so
+     * it can, for instance, hand the buffers to a Writer.
+     *
+     * @code
+     * osmium::io::Reader reader{"history.osh.pbf"};
+     * osmium::io::Writer writer{"out.osm.pbf"};
+     * osmium::apply_diff_parallel(reader, [](const osmium::DiffPartition& partition) {
+     *     MyDiffHandler handler;
+     *     partition.apply(handler);
+     *     return handler.get_buffer();
+     * }, [&](osmium::memory::Buffer&& buffer) {
+     *     writer(std::move(buffer));
+     * });
+     * @endcode
+     *
+     * @param source Source of buffers with the history data.
+     * @param func Function taking a const DiffPartition& and returning
+     *             a non-void result. It is called from several threads
+     *             at the same time.
+     * @param output Function taking the results of func.
+     * @param pool The thread pool to use.
+     * @throws Any exception func or output throw. All running tasks are
+     *         finished before the exception is propagated.
+     */
+    template <typename TSource, typename TFunc, typename TOutput>
+    inline void apply_diff_parallel(TSource& source, TFunc&& func, TOutput&& output,
+                                    osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+        using func_type = typename std::remove_reference<TFunc>::type;
+        using result_type = typename std::result_of<func_type&(const DiffPartition&)>::type;
+
+        // Limit the number of partitions in memory at the same time.
+        const std::size_t max_pending = 2 * static_cast<std::size_t>(pool.num_threads()) + 1;
+
+        std::deque<std::future<result_type>> pending;
+        try {
+            DiffPartitioner<TSource> partitioner{source};
+            while (DiffPartition partition = partitioner.read()) {
+                pending.push_back(pool.submit(detail::diff_partition_task<func_type, result_type>{std::move(partition), func}));
+                if (pending.size() >= max_pending) {
+                    output(pending.front().get());
+                    pending.pop_front();
+                }
+            }
+            while (!pending.empty()) {
+                output(pending.front().get());
+                pending.pop_front();
+            }
+        } catch (...) {
+            // The tasks refer to func, they have to be finished before
+            // we return.
+            for (auto& future : pending) {
+                if (future.valid()) {
+                    future.wait();
+                }
+            }
+            throw;
+        }
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_DIFF_PARALLEL_HPP
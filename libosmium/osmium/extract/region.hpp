@@ -0,0 +1,205 @@
+#ifndef OSMIUM_EXTRACT_REGION_HPP
+#define OSMIUM_EXTRACT_REGION_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * @brief Splitting OSM data into extracts
+     */
+    namespace extract {
+
+        /**
+         * A region of the world described by a bounding box or by a
+         * polygon with any number of rings. Used by the Splitter.
+         *
+         * Polygons use the even-odd rule, so it doesn't matter which
+         * rings are outer and which are inner rings. Locations are tested
+         * with integer arithmetic on the fixed-point coordinates, so the
+         * results are exact. A location on the boundary of a box is
+         * inside, on the boundary of a polygon it can be inside or
+         * outside.
+         */
+        class Region {
+
+            using ring_type = std::vector<osmium::Location>;
+
+            osmium::Box m_envelope;
+            std::vector<ring_type> m_rings;
+
+            void check_rings_and_set_envelope() {
+                if (m_rings.empty()) {
+                    throw std::invalid_argument{"region polygon needs at least one ring"};
+                }
+                for (const auto& ring : m_rings) {
+                    if (ring.size() < 3) {
+                        throw std::invalid_argument{"region polygon ring needs at least three locations"};
+                    }
+                    for (const auto& location : ring) {
+                        if (!location.valid()) {
+                            throw std::invalid_argument{"invalid location in region polygon"};
+                        }
+                        m_envelope.extend(location);
+                    }
+                }
+            }
+
+            // Is the location inside the ring (even-odd rule)? The
+            // products fit into int64_t, because the differences of
+            // longitudes and latitudes are at most 3.6e9 and 1.8e9.
+            static bool in_ring(const ring_type& ring, const osmium::Location& location) noexcept {
+                const int64_t x = location.x();
+                const int64_t y = location.y();
+                bool inside = false;
+                for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+                    const int64_t xi = ring[i].x();
+                    const int64_t yi = ring[i].y();
+                    const int64_t xj = ring[j].x();
+                    const int64_t yj = ring[j].y();
+                    if ((yi > y) != (yj > y)) {
+                        const int64_t lhs = (x - xi) * (yj - yi);
+                        const int64_t rhs = (xj - xi) * (y - yi);
+                        if (yj > yi ? lhs < rhs : lhs > rhs) {
+                            inside = !inside;
+                        }
+                    }
+                }
+                return inside;
+            }
+
+        public:
+
+            /**
+             * Create a region from a bounding box.
+             *
+             * @throws std::invalid_argument If the box is not valid.
+             */
+            explicit Region(const osmium::Box& box) :
+                m_envelope(box),
+                m_rings() {
+                if (!box.valid()) {
+                    throw std::invalid_argument{"invalid box for region"};
+                }
+            }
+
+            /**
+             * Create a region from polygon rings. The rings don't have to
+             * be closed.
+             *
+             * @throws std::invalid_argument If there are no rings, a ring
+             *         has less than three locations, or contains an
+             *         invalid location.
+             */
+            explicit Region(std::vector<std::vector<osmium::Location>> rings) :
+                m_envelope(),
+                m_rings(std::move(rings)) {
+                check_rings_and_set_envelope();
+            }
+
+            /**
+             * Create a region from the rings of an area.
+             *
+             * @throws std::invalid_argument If the area has no rings or
+             *         the rings are invalid.
+             */
+            explicit Region(const osmium::Area& area) :
+                m_envelope(),
+                m_rings() {
+                for (const auto& outer : area.outer_rings()) {
+                    m_rings.emplace_back();
+                    for (const auto& node_ref : outer) {
+                        m_rings.back().push_back(node_ref.location());
+                    }
+                    for (const auto& inner : area.inner_rings(outer)) {
+                        m_rings.emplace_back();
+                        for (const auto& node_ref : inner) {
+                            m_rings.back().push_back(node_ref.location());
+                        }
+                    }
+                }
+                check_rings_and_set_envelope();
+            }
+
+            /// The bounding box of this region.
+            const osmium::Box& envelope() const noexcept {
+                return m_envelope;
+            }
+
+            /// Is this region described by a bounding box only?
+            bool is_box() const noexcept {
+                return m_rings.empty();
+            }
+
+            /// The polygon rings (empty if this is a box).
+            const std::vector<std::vector<osmium::Location>>& rings() const noexcept {
+                return m_rings;
+            }
+
+            /**
+             * Is the location inside this region? Invalid locations never
+             * are.
+             */
+            bool contains(const osmium::Location& location) const noexcept {
+                if (!location.valid() || !m_envelope.contains(location)) {
+                    return false;
+                }
+                if (m_rings.empty()) {
+                    return true;
+                }
+                bool inside = false;
+                for (const auto& ring : m_rings) {
+                    if (in_ring(ring, location)) {
+                        inside = !inside;
+                    }
+                }
+                return inside;
+            }
+
+        }; // class Region
+
+    } // namespace extract
+
+} // namespace osmium
+
+#endif // OSMIUM_EXTRACT_REGION_HPP
@@ -0,0 +1,453 @@
+#ifndef OSMIUM_EXTRACT_REGION_ASSIGNER_HPP
+#define OSMIUM_EXTRACT_REGION_ASSIGNER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/extract/region.hpp>
+#include <osmium/index/packed_rtree.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace extract {
+
+        namespace detail {
+
+            /**
+             * Index over the edges of one region polygon for fast
+             * point-in-polygon tests. The envelope of the polygon is
+             * divided into a grid. Each row of the grid has a list of
+             * all edges crossing it, so the even-odd test for a location
+             * only has to look at the edges in its row. Cells not
+             * touched by any edge are completely inside or outside the
+             * polygon, for locations in those cells no edges have to be
+             * looked at.
+             *
+             * The results are exactly the same as those of
+             * Region::contains().
+             */
+            class region_index {
+
+                struct edge {
+                    int32_t x1;
+                    int32_t y1;
+                    int32_t x2;
+                    int32_t y2;
+                };
+
+                enum cell_state : uint8_t {
+                    outside = 0,
+                    inside = 1,
+                    boundary = 2
+                };
+
+                // Maximum number of rows and columns of the grid.
+                enum {
+                    max_grid_size = 2048
+                };
+
+                osmium::Box m_envelope;
+                bool m_is_box;
+
+                int64_t m_min_x = 0;
+                int64_t m_min_y = 0;
+                int64_t m_cell_width = 1;
+                int64_t m_cell_height = 1;
+                uint32_t m_size = 1;
+
+                std::vector<edge> m_edges{};
+                std::vector<uint32_t> m_row_offsets{};
+                std::vector<uint32_t> m_row_edges{};
+                std::vector<uint8_t> m_cells{};
+
+                uint32_t row(int64_t y) const noexcept {
+                    return static_cast<uint32_t>((y - m_min_y) / m_cell_height);
+                }
+
+                uint32_t column(int64_t x) const noexcept {
+                    return static_cast<uint32_t>((x - m_min_x) / m_cell_width);
+                }
+
+                // Even-odd test with the edges in the given row. Same
+                // calculation as in Region.
+                bool in_row(int64_t x, int64_t y, uint32_t r) const noexcept {
+                    bool inside = false;
+                    for (uint32_t i = m_row_offsets[r]; i < m_row_offsets[r + 1]; ++i) {
+                        const edge& e = m_edges[m_row_edges[i]];
+                        const int64_t xi = e.x1;
+                        const int64_t yi = e.y1;
+                        const int64_t xj = e.x2;
+                        const int64_t yj = e.y2;
+                        if ((yi > y) != (yj > y)) {
+                            const int64_t lhs = (x - xi) * (yj - yi);
+                            const int64_t rhs = (xj - xi) * (y - yi);
+                            if (yj > yi ? lhs < rhs : lhs > rhs) {
+                                inside = !inside;
+                            }
+                        }
+                    }
+                    return inside;
+                }
+
+                void add_edges(const Region& region) {
+                    for (const auto& ring : region.rings()) {
+                        for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+                            m_edges.push_back(edge{ring[i].x(), ring[i].y(), ring[j].x(), ring[j].y()});
+                        }
+                    }
+                    if (m_edges.size() > std::numeric_limits<uint32_t>::max()) {
+                        throw std::length_error{"too many edges in region"};
+                    }
+                }
+
+                // Build the lists of edges for each row. An edge is needed
+                // in a row if it can cross a horizontal ray from a location
+                // in that row, that is if any y in the row is in the
+                // half-open range of the y coordinates of the edge.
+                void build_rows() {
+                    std::vector<uint32_t> counts(m_size + 1, 0);
+                    const auto for_each_row = [this](const edge& e, uint32_t& first, uint32_t& last) {
+                        const int64_t ymin = std::min(e.y1, e.y2);
+                        const int64_t ymax = std::max(e.y1, e.y2);
+                        first = row(ymin);
+                        last = ymax > ymin ? std::min(m_size - 1, row(ymax - 1)) + 1 : first;
+                    };
+
+                    for (const auto& e : m_edges) {
+                        uint32_t first = 0;
+                        uint32_t last = 0;
+                        for_each_row(e, first, last);
+                        for (uint32_t r = first; r < last; ++r) {
+                            ++counts[r + 1];
+                        }
+                    }
+
+                    m_row_offsets.resize(m_size + 1);
+                    for (uint32_t r = 0; r < m_size; ++r) {
+                        m_row_offsets[r + 1] = m_row_offsets[r] + counts[r + 1];
+                    }
+                    m_row_edges.resize(m_row_offsets.back());
+
+                    std::vector<uint32_t> fill{m_row_offsets.begin(), m_row_offsets.end() - 1};
+                    for (uint32_t i = 0; i < m_edges.size(); ++i) {
+                        uint32_t first = 0;
+                        uint32_t last = 0;
+                        for_each_row(m_edges[i], first, last);
+                        for (uint32_t r = first; r < last; ++r) {
+                            m_row_edges[fill[r]++] = i;
+                        }
+                    }
+                }
+
+                // Mark all cells an edge could go through as boundary
+                // cells. This is done in floating point arithmetic, so one
+                // cell more is marked on each side to be on the safe side.
+                void mark_boundary_cells() {
+                    for (const auto& e : m_edges) {
+                        const int64_t ymin = std::min(e.y1, e.y2);
+                        const int64_t ymax = std::max(e.y1, e.y2);
+                        const uint32_t first = row(ymin);
+                        const uint32_t last = std::min(m_size - 1, row(ymax));
+                        for (uint32_t r = first; r <= last; ++r) {
+                            double x1 = e.x1;
+                            double x2 = e.x2;
+                            if (e.y1 != e.y2) {
+                                const double band_min = static_cast<double>(std::max(ymin, m_min_y + r * m_cell_height));
+                                const double band_max = static_cast<double>(std::min(ymax, m_min_y + (r + 1) * m_cell_height));
+                                const double slope = static_cast<double>(e.x2 - e.x1) / static_cast<double>(e.y2 - e.y1);
+                                x1 = e.x1 + (band_min - e.y1) * slope;
+                                x2 = e.x1 + (band_max - e.y1) * slope;
+                            }
+                            const int64_t col_min = static_cast<int64_t>(std::floor((std::min(x1, x2) - m_min_x) / m_cell_width)) - 1;
+                            const int64_t col_max = static_cast<int64_t>(std::floor((std::max(x1, x2) - m_min_x) / m_cell_width)) + 1;
+                            const int64_t c_end = std::min(static_cast<int64_t>(m_size) - 1, col_max);
+                            for (int64_t c = std::max(int64_t(0), col_min); c <= c_end; ++c) {
+                                m_cells[r * m_size + c] = boundary;
+                            }
+                        }
+                    }
+                }
+
+                // Cells not touched by any edge are completely inside or
+                // outside, so testing the center of the cell is enough.
+                void classify_cells() {
+                    for (uint32_t r = 0; r < m_size; ++r) {
+                        const int64_t y = m_min_y + r * m_cell_height + m_cell_height / 2;
+                        for (uint32_t c = 0; c < m_size; ++c) {
+                            auto& cell = m_cells[r * m_size + c];
+                            if (cell != boundary) {
+                                const int64_t x = m_min_x + c * m_cell_width + m_cell_width / 2;
+                                cell = in_row(x, y, r) ? inside : outside;
+                            }
+                        }
+                    }
+                }
+
+            public:
+
+                explicit region_index(const Region& region) :
+                    m_envelope(region.envelope()),
+                    m_is_box(region.is_box()) {
+                    if (m_is_box) {
+                        return;
+                    }
+
+                    add_edges(region);
+
+                    m_size = static_cast<uint32_t>(std::min(static_cast<double>(max_grid_size),
+                                                            std::ceil(2 * std::sqrt(static_cast<double>(m_edges.size())))));
+                    m_min_x = m_envelope.bottom_left().x();
+                    m_min_y = m_envelope.bottom_left().y();
+                    const int64_t width = int64_t(m_envelope.top_right().x()) - m_min_x + 1;
+                    const int64_t height = int64_t(m_envelope.top_right().y()) - m_min_y + 1;
+                    m_cell_width = (width + m_size - 1) / m_size;
+                    m_cell_height = (height + m_size - 1) / m_size;
+
+                    build_rows();
+                    m_cells.resize(static_cast<std::size_t>(m_size) * m_size, outside);
+                    mark_boundary_cells();
+                    classify_cells();
+                }
+
+                /// Same as Region::contains().
+                bool contains(const osmium::Location& location) const noexcept {
+                    if (!location.valid() || !m_envelope.contains(location)) {
+                        return false;
+                    }
+                    if (m_is_box) {
+                        return true;
+                    }
+                    const uint32_t r = row(location.y());
+                    const auto cell = m_cells[r * m_size + column(location.x())];
+                    if (cell != boundary) {
+                        return cell == inside;
+                    }
+                    return in_row(location.x(), location.y(), r);
+                }
+
+            }; // class region_index
+
+        } // namespace detail
+
+        /**
+         * Assigns locations to the regions containing them. Built once
+         * from any number of (possibly overlapping) regions, usually
+         * polygons of boundaries with many vertices assembled from
+         * Areas.
+         *
+         * The envelopes of the regions are kept in a PackedRTree, so only
+         * regions whose envelopes contain a location are looked at. For
+         * each polygon region an index of its edges over a grid is built
+         * (in parallel for all regions), so that most locations can be
+         * classified without looking at any edges and for the others
+         * only the edges in one row of the grid have to be tested. The
+         * results are exactly the same as those of Region::contains().
+         *
+         * The region ids are the indexes of the regions in the vector
+         * given to the constructor. All queries are thread safe.
+         *
+         * @code
+         * std::vector<osmium::extract::Region> regions;
+         * // for all boundary areas:
+         * regions.emplace_back(area);
+         * const osmium::extract::RegionAssigner assigner{regions};
+         * assigner.for_each_region(location, [](uint32_t region_id) {
+         *     ...
+         * });
+         * @endcode
+         */
+        class RegionAssigner {
+
+            std::vector<detail::region_index> m_indexes{};
+            osmium::index::PackedRTree m_tree{};
+
+            // Number of locations handled in one task by assign().
+            enum {
+                chunk_size = 16 * 1024
+            };
+
+            template <typename TFunc>
+            static void run_parallel(std::size_t count, osmium::thread::Pool& pool, TFunc&& func) {
+                if (count <= 1) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        func(i);
+                    }
+                    return;
+                }
+
+                std::vector<std::future<void>> futures;
+                futures.reserve(count);
+                try {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        futures.push_back(pool.submit([&func, i]() {
+                            func(i);
+                        }));
+                    }
+                    for (auto& future : futures) {
+                        future.get();
+                    }
+                } catch (...) {
+                    for (auto& future : futures) {
+                        if (future.valid()) {
+                            future.wait();
+                        }
+                    }
+                    throw;
+                }
+            }
+
+        public:
+
+            /**
+             * Build the assigner from the given regions.
+             *
+             * @param regions The regions. The region id of each region is
+             *                its index in this vector.
+             * @param pool The thread pool used to build the indexes.
+             * @throws std::length_error If there are too many regions.
+             */
+            explicit RegionAssigner(const std::vector<Region>& regions,
+                                    osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+                if (regions.size() > std::numeric_limits<uint32_t>::max()) {
+                    throw std::length_error{"too many regions for RegionAssigner"};
+                }
+
+                std::vector<std::vector<detail::region_index>> parts(std::min(regions.size(), static_cast<std::size_t>(pool.num_threads())));
+                run_parallel(parts.size(), pool, [&](std::size_t part) {
+                    const std::size_t first = regions.size() * part / parts.size();
+                    const std::size_t last = regions.size() * (part + 1) / parts.size();
+                    for (std::size_t i = first; i < last; ++i) {
+                        parts[part].emplace_back(regions[i]);
+                    }
+                });
+
+                m_indexes.reserve(regions.size());
+                for (auto& part : parts) {
+                    std::move(part.begin(), part.end(), std::back_inserter(m_indexes));
+                }
+
+                osmium::index::PackedRTreeBuilder builder;
+                for (std::size_t i = 0; i < regions.size(); ++i) {
+                    builder.add(regions[i].envelope(), static_cast<osmium::object_id_type>(i));
+                }
+                m_tree = builder.build(pool);
+            }
+
+            /// The number of regions.
+            std::size_t size() const noexcept {
+                return m_indexes.size();
+            }
+
+            /**
+             * Call func(region_id) for each region containing the
+             * location. Regions are not reported in any particular order.
+             * Invalid locations are not in any region.
+             */
+            template <typename TFunc>
+            void for_each_region(const osmium::Location& location, TFunc&& func) const {
+                if (!location.valid()) {
+                    return;
+                }
+                m_tree.search(location, [&](osmium::object_id_type id) {
+                    const auto region_id = static_cast<uint32_t>(id);
+                    if (m_indexes[region_id].contains(location)) {
+                        std::forward<TFunc>(func)(region_id);
+                    }
+                });
+            }
+
+            /**
+             * Find the regions containing each of count locations. The
+             * work is done in parallel using the thread pool. The ids of
+             * the regions containing locations[i] are written, sorted, to
+             * region_ids[offsets[i]] to region_ids[offsets[i + 1] - 1].
+             * Existing content of offsets and region_ids is removed.
+             */
+            void assign(const osmium::Location* locations,
+                        std::size_t count,
+                        std::vector<std::size_t>& offsets,
+                        std::vector<uint32_t>& region_ids,
+                        osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) const {
+                const std::size_t num_chunks = (count + chunk_size - 1) / chunk_size;
+
+                // For each chunk the number of regions for each location
+                // and the region ids.
+                std::vector<std::pair<std::vector<uint32_t>, std::vector<uint32_t>>> results(num_chunks);
+
+                run_parallel(num_chunks, pool, [&](std::size_t chunk) {
+                    const std::size_t first = chunk * chunk_size;
+                    const std::size_t last = std::min(count, first + chunk_size);
+                    auto& result = results[chunk];
+                    result.first.reserve(last - first);
+                    for (std::size_t i = first; i < last; ++i) {
+                        const std::size_t size = result.second.size();
+                        for_each_region(locations[i], [&result](uint32_t region_id) {
+                            result.second.push_back(region_id);
+                        });
+                        std::sort(result.second.begin() + size, result.second.end());
+                        result.first.push_back(static_cast<uint32_t>(result.second.size() - size));
+                    }
+                });
+
+                offsets.clear();
+                offsets.reserve(count + 1);
+                offsets.push_back(0);
+                region_ids.clear();
+                for (const auto& result : results) {
+                    for (const auto n : result.first) {
+                        offsets.push_back(offsets.back() + n);
+                    }
+                    region_ids.insert(region_ids.end(), result.second.begin(), result.second.end());
+                }
+            }
+
+        }; // class RegionAssigner
+
+    } // namespace extract
+
+} // namespace osmium
+
+#endif // OSMIUM_EXTRACT_REGION_ASSIGNER_HPP
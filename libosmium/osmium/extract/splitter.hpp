@@ -0,0 +1,719 @@
+#ifndef OSMIUM_EXTRACT_SPLITTER_HPP
+#define OSMIUM_EXTRACT_SPLITTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/extract/region.hpp>
+#include <osmium/extract/region_assigner.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/tile.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/nwr_array.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/file.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace extract {
+
+        /**
+         * Configuration for the Splitter.
+         */
+        struct SplitterConfig {
+
+            /**
+             * Maximum number of output files open at the same time. Each
+             * open output needs a file descriptor, a thread, and some
+             * buffers. If there are more regions than this, the objects
+             * for all but the first group of this many regions are
+             * spilled to a temporary file while the input is read the
+             * second time. The groups are then written from there one
+             * after the other. The input is never read more than twice.
+             */
+            std::size_t max_open_files = 200;
+
+            /**
+             * Objects for each output are collected in a buffer of this
+             * size before they are handed to its Writer. Objects spilled
+             * for each group of outputs are collected in a buffer of this
+             * size before they are written to the temporary file.
+             */
+            std::size_t buffer_size = 256UL * 1024UL;
+
+            /**
+             * If this is set, all nodes of ways that have at least one
+             * node in a region are written to the output for that region.
+             * Otherwise those ways are written with references to nodes
+             * that are not in the output.
+             */
+            bool complete_ways = true;
+
+            /**
+             * Allow overwriting of existing output files?
+             */
+            osmium::io::overwrite overwrite = osmium::io::overwrite::no;
+
+        }; // struct SplitterConfig
+
+        namespace detail {
+
+            /**
+             * Stores the set of regions for each object id as a sorted
+             * list of (id, region) pairs. Objects in no region take up no
+             * space. Entries are appended, the list is sorted lazily when
+             * it is queried, which is cheap if the ids come in order.
+             */
+            class id_region_map {
+
+                struct entry {
+                    osmium::object_id_type id;
+                    uint32_t region;
+                };
+
+                std::vector<entry> m_entries;
+                bool m_sorted = true;
+
+                static bool less(const entry& lhs, const entry& rhs) noexcept {
+                    return lhs.id < rhs.id || (lhs.id == rhs.id && lhs.region < rhs.region);
+                }
+
+                void sort_unique() {
+                    std::sort(m_entries.begin(), m_entries.end(), less);
+                    m_entries.erase(std::unique(m_entries.begin(), m_entries.end(), [](const entry& lhs, const entry& rhs) {
+                        return lhs.id == rhs.id && lhs.region == rhs.region;
+                    }), m_entries.end());
+                    m_sorted = true;
+                }
+
+            public:
+
+                void add(const osmium::object_id_type id, const uint32_t region) {
+                    const entry e{id, region};
+                    if (m_sorted && !m_entries.empty() && !less(m_entries.back(), e)) {
+                        m_sorted = false;
+                    }
+                    m_entries.push_back(e);
+                }
+
+                /// Add all entries from the other map and clear it.
+                void merge(id_region_map& other) {
+                    m_entries.insert(m_entries.end(), other.m_entries.begin(), other.m_entries.end());
+                    m_sorted = false;
+                    other.clear();
+                }
+
+                /**
+                 * Call func(region) for all regions the object with this
+                 * id is in, in ascending order.
+                 */
+                template <typename TFunc>
+                void for_each_region(const osmium::object_id_type id, TFunc&& func) {
+                    if (!m_sorted) {
+                        sort_unique();
+                    }
+                    auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), id, [](const entry& e, const osmium::object_id_type i) {
+                        return e.id < i;
+                    });
+                    for (; it != m_entries.cend() && it->id == id; ++it) {
+                        std::forward<TFunc>(func)(it->region);
+                    }
+                }
+
+                std::size_t size() const noexcept {
+                    return m_entries.size();
+                }
+
+                void clear() {
+                    std::vector<entry>{}.swap(m_entries);
+                    m_sorted = true;
+                }
+
+            }; // class id_region_map
+
+            /**
+             * Temporary file for the objects of output groups that can't
+             * be written while reading the input. The objects are stored
+             * in their internal format in chunks of at most buffer_size
+             * bytes (unless a single object is larger). The chunks of all
+             * groups are in the same file, for each group the list of its
+             * chunks is kept, so the groups can be read back one after the
+             * other.
+             */
+            class spill_file {
+
+                struct chunk {
+                    std::size_t offset;
+                    std::size_t size;
+                }; // struct chunk
+
+                int m_fd = -1;
+                std::size_t m_buffer_size;
+                std::size_t m_bytes = 0;
+                std::vector<std::string> m_pending;
+                std::vector<std::vector<chunk>> m_chunks;
+
+                void write_chunk(const std::size_t group, const char* data, const std::size_t size) {
+                    if (m_fd < 0) {
+                        m_fd = osmium::detail::create_tmp_file();
+                    }
+                    osmium::io::detail::reliable_write(m_fd, data, size);
+                    m_chunks[group].push_back(chunk{m_bytes, size});
+                    m_bytes += size;
+                }
+
+            public:
+
+                spill_file(const std::size_t num_groups, const std::size_t buffer_size) :
+                    m_buffer_size(buffer_size),
+                    m_pending(num_groups),
+                    m_chunks(num_groups) {
+                }
+
+                spill_file(const spill_file&) = delete;
+                spill_file& operator=(const spill_file&) = delete;
+
+                spill_file(spill_file&&) = delete;
+                spill_file& operator=(spill_file&&) = delete;
+
+                ~spill_file() noexcept {
+                    if (m_fd >= 0) {
+                        try {
+                            osmium::io::detail::reliable_close(m_fd);
+                        } catch (...) { // NOLINT(bugprone-empty-catch)
+                            // Ignore errors when closing a temporary file.
+                        }
+                    }
+                }
+
+                /// Number of bytes written to the temporary file.
+                std::size_t bytes() const noexcept {
+                    return m_bytes;
+                }
+
+                void add(const std::size_t group, const osmium::OSMObject& object) {
+                    auto& pending = m_pending[group];
+                    const std::size_t size = object.padded_size();
+                    if (!pending.empty() && pending.size() + size > m_buffer_size) {
+                        write_chunk(group, pending.data(), pending.size());
+                        pending.clear();
+                    }
+                    if (size > m_buffer_size) {
+                        write_chunk(group, reinterpret_cast<const char*>(object.data()), size);
+                        return;
+                    }
+                    if (pending.capacity() < m_buffer_size) {
+                        pending.reserve(m_buffer_size);
+                    }
+                    pending.append(reinterpret_cast<const char*>(object.data()), size);
+                }
+
+                /// Write out all pending data. Call before reading.
+                void flush() {
+                    for (std::size_t group = 0; group < m_pending.size(); ++group) {
+                        if (!m_pending[group].empty()) {
+                            write_chunk(group, m_pending[group].data(), m_pending[group].size());
+                        }
+                        std::string{}.swap(m_pending[group]);
+                    }
+                }
+
+                /**
+                 * Call func(object) for all objects spilled for the group
+                 * in the order they were added.
+                 */
+                template <typename TFunc>
+                void for_each_object(const std::size_t group, TFunc&& func) const {
+                    std::unique_ptr<unsigned char[]> data;
+                    std::size_t capacity = 0;
+                    for (const auto& c : m_chunks[group]) {
+                        if (c.size > capacity) {
+                            data.reset(new unsigned char[c.size]);
+                            capacity = c.size;
+                        }
+                        osmium::util::file_seek(m_fd, c.offset);
+                        std::size_t done = 0;
+                        while (done < c.size) {
+                            const auto nread = osmium::io::detail::reliable_read(m_fd, reinterpret_cast<char*>(data.get() + done), static_cast<unsigned int>(c.size - done));
+                            if (nread <= 0) {
+                                throw std::runtime_error{"temporary file of Splitter is truncated"};
+                            }
+                            done += static_cast<std::size_t>(nread);
+                        }
+                        const osmium::memory::Buffer buffer{data.get(), c.size};
+                        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                            std::forward<TFunc>(func)(object);
+                        }
+                    }
+                }
+
+            }; // class spill_file
+
+        } // namespace detail
+
+        /**
+         * Splits an OSM file into any number of extracts (outputs) in
+         * two passes over the input. Each extract is defined by a Tile or
+         * a Region (bounding box or polygon). Regions can overlap, tile
+         * regions can't.
+         *
+         * The first pass assigns nodes to regions by their location, ways
+         * to all regions that contain any of their nodes, and relations
+         * to all regions that contain any of their members (members that
+         * are relations are only taken into account if they come earlier
+         * in the input). With SplitterConfig::complete_ways all nodes of
+         * the ways in a region are added to the region, too. The ids of
+         * the objects in each region are kept in memory (16 bytes per
+         * object and region). This is not limited by the configuration,
+         * it grows with the size of the extracts, so splitting a large
+         * input into many or heavily overlapping regions needs a lot of
+         * memory.
+         *
+         * The second pass writes the outputs. At most
+         * SplitterConfig::max_open_files outputs are open at a time. The
+         * objects for the first group of this many outputs are written
+         * directly, the objects for all other groups are written once per
+         * group to a temporary file. The other groups are then written
+         * from this file, each reading only its own objects. So the input
+         * is always read exactly twice, however many outputs there are.
+         * The temporary file needs as much space as the objects in all
+         * groups but the first (once per group they are in). In memory
+         * one buffer of SplitterConfig::buffer_size is needed for each
+         * open output and for each group.
+         *
+         * Tiles are found directly from the node location using a
+         * FixedZoomTiler, so a huge number of tile outputs is no problem.
+         * All tiles must have the same zoom level. All other regions are
+         * looked up with a RegionAssigner, which gets the locations of all
+         * nodes in an input buffer at once and works in parallel.
+         *
+         * The input should be sorted by type and id (as usual), it can
+         * be any file format the Reader understands. It must not be a
+         * history file.
+         *
+         * @code
+         * osmium::extract::Splitter splitter{osmium::io::File{"input.osm.pbf"}};
+         * splitter.add_region(osmium::Box{5.8, 47.2, 15.1, 55.1}, osmium::io::File{"germany.osm.pbf"});
+         * splitter.add_tile(osmium::geom::Tile{8, 134, 86}, osmium::io::File{"tile.osm.pbf"});
+         * splitter();
+         * @endcode
+         */
+        class Splitter {
+
+            struct output {
+                osmium::io::File file;
+                osmium::Box envelope;
+            };
+
+            osmium::io::File m_input;
+            SplitterConfig m_config;
+            std::vector<output> m_outputs{};
+
+            // Regions (and their output index) that are not tiles.
+            std::vector<std::pair<Region, uint32_t>> m_regions{};
+
+            // Tile regions: Tile x and y coordinates -> output index
+            std::unique_ptr<osmium::geom::FixedZoomTiler> m_tiler{};
+            std::unordered_map<uint64_t, uint32_t> m_tiles{};
+
+            osmium::nwr_array<detail::id_region_map> m_ids{};
+            detail::id_region_map m_way_nodes{};
+            std::vector<uint32_t> m_scratch{};
+            std::size_t m_passes = 0;
+            std::size_t m_spilled_bytes = 0;
+
+            // Outputs currently open, index first to first+size-1.
+            std::size_t m_first_open = 0;
+            std::vector<std::unique_ptr<osmium::io::Writer>> m_writers{};
+            std::vector<osmium::memory::Buffer> m_buffers{};
+
+            // Scratch space for assigning nodes to regions.
+            std::vector<osmium::object_id_type> m_node_ids{};
+            std::vector<osmium::Location> m_locations{};
+            std::vector<std::size_t> m_offsets{};
+            std::vector<uint32_t> m_region_ids{};
+
+            static uint64_t tile_key(const uint32_t x, const uint32_t y) noexcept {
+                return (static_cast<uint64_t>(x) << 32U) | y;
+            }
+
+            static osmium::Box tile_envelope(const osmium::geom::Tile& tile) {
+                const double num_tiles = osmium::geom::num_tiles_in_zoom(tile.z);
+                const double extent = osmium::geom::tile_extent_in_zoom(tile.z);
+                return osmium::Box{
+                    tile.x / num_tiles * 360.0 - 180.0,
+                    osmium::geom::detail::y_to_lat(osmium::geom::detail::max_coordinate_epsg3857 - (tile.y + 1) * extent),
+                    (tile.x + 1) / num_tiles * 360.0 - 180.0,
+                    osmium::geom::detail::y_to_lat(osmium::geom::detail::max_coordinate_epsg3857 - tile.y * extent)
+                };
+            }
+
+            std::size_t add_output(const osmium::io::File& file, const osmium::Box& envelope) {
+                if (m_outputs.size() == std::numeric_limits<uint32_t>::max()) {
+                    throw std::length_error{"too many outputs for Splitter"};
+                }
+                m_outputs.push_back(output{file, envelope});
+                return m_outputs.size() - 1;
+            }
+
+            // Sort and remove duplicates from the regions in m_scratch.
+            void unique_scratch() {
+                std::sort(m_scratch.begin(), m_scratch.end());
+                m_scratch.erase(std::unique(m_scratch.begin(), m_scratch.end()), m_scratch.end());
+            }
+
+            void assign_node_to_tile(const osmium::Node& node) {
+                const osmium::Location location = node.location();
+                if (!location.valid()) {
+                    return;
+                }
+
+                const auto it = m_tiles.find(tile_key(m_tiler->tile_x(location.x()), m_tiler->tile_y(location.y())));
+                if (it != m_tiles.end()) {
+                    m_ids(osmium::item_type::node).add(node.id(), it->second);
+                }
+            }
+
+            // Assign all nodes in the buffer to the (non-tile) regions
+            // containing them.
+            void assign_nodes_to_regions(const osmium::memory::Buffer& buffer, const RegionAssigner& assigner) {
+                m_node_ids.clear();
+                m_locations.clear();
+                for (const auto& node : buffer.select<osmium::Node>()) {
+                    m_node_ids.push_back(node.id());
+                    m_locations.push_back(node.location());
+                }
+                if (m_node_ids.empty()) {
+                    return;
+                }
+
+                assigner.assign(m_locations.data(), m_locations.size(), m_offsets, m_region_ids);
+
+                auto& ids = m_ids(osmium::item_type::node);
+                for (std::size_t i = 0; i < m_node_ids.size(); ++i) {
+                    for (std::size_t j = m_offsets[i]; j < m_offsets[i + 1]; ++j) {
+                        ids.add(m_node_ids[i], m_regions[m_region_ids[j]].second);
+                    }
+                }
+            }
+
+            void assign_way(const osmium::Way& way) {
+                m_scratch.clear();
+                auto& node_ids = m_ids(osmium::item_type::node);
+                for (const auto& node_ref : way.nodes()) {
+                    node_ids.for_each_region(node_ref.ref(), [this](const uint32_t region) {
+                        m_scratch.push_back(region);
+                    });
+                }
+                unique_scratch();
+
+                for (const auto region : m_scratch) {
+                    m_ids(osmium::item_type::way).add(way.id(), region);
+                    if (m_config.complete_ways) {
+                        for (const auto& node_ref : way.nodes()) {
+                            m_way_nodes.add(node_ref.ref(), region);
+                        }
+                    }
+                }
+            }
+
+            void assign_relation(const osmium::Relation& relation) {
+                m_scratch.clear();
+                for (const auto& member : relation.members()) {
+                    if (member.type() == osmium::item_type::node ||
+                        member.type() == osmium::item_type::way ||
+                        member.type() == osmium::item_type::relation) {
+                        m_ids(member.type()).for_each_region(member.ref(), [this](const uint32_t region) {
+                            m_scratch.push_back(region);
+                        });
+                    }
+                }
+                unique_scratch();
+
+                for (const auto region : m_scratch) {
+                    m_ids(osmium::item_type::relation).add(relation.id(), region);
+                }
+            }
+
+            void assign() {
+                std::vector<Region> regions;
+                regions.reserve(m_regions.size());
+                for (const auto& region : m_regions) {
+                    regions.push_back(region.first);
+                }
+                const RegionAssigner assigner{regions};
+
+                osmium::io::Reader reader{m_input, osmium::osm_entity_bits::nwr};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    if (!m_regions.empty()) {
+                        assign_nodes_to_regions(buffer, assigner);
+                    }
+                    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                        switch (object.type()) {
+                            case osmium::item_type::node:
+                                if (m_tiler) {
+                                    assign_node_to_tile(static_cast<const osmium::Node&>(object));
+                                }
+                                break;
+                            case osmium::item_type::way:
+                                assign_way(static_cast<const osmium::Way&>(object));
+                                break;
+                            case osmium::item_type::relation:
+                                assign_relation(static_cast<const osmium::Relation&>(object));
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+                }
+                reader.close();
+                ++m_passes;
+
+                m_ids(osmium::item_type::node).merge(m_way_nodes);
+            }
+
+            // Open the outputs with index first to last-1.
+            void open_outputs(const osmium::io::Header& input_header, const std::size_t first, const std::size_t last) {
+                m_first_open = first;
+                for (std::size_t i = first; i < last; ++i) {
+                    osmium::io::Header header{input_header};
+                    header.boxes().clear();
+                    header.add_box(m_outputs[i].envelope);
+                    m_writers.emplace_back(new osmium::io::Writer{m_outputs[i].file, header, m_config.overwrite});
+                    m_buffers.emplace_back(m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes);
+                }
+            }
+
+            void close_outputs() {
+                for (std::size_t i = 0; i < m_writers.size(); ++i) {
+                    if (m_buffers[i].committed() > 0) {
+                        (*m_writers[i])(std::move(m_buffers[i]));
+                    }
+                    m_writers[i]->close();
+                }
+                m_writers.clear();
+                m_buffers.clear();
+            }
+
+            // Add the object to all open outputs it belongs to.
+            void write_to_open_outputs(const osmium::OSMObject& object) {
+                const std::size_t last = m_first_open + m_writers.size();
+                m_ids(object.type()).for_each_region(object.id(), [&](const uint32_t region) {
+                    if (region < m_first_open || region >= last) {
+                        return;
+                    }
+                    auto& buffer = m_buffers[region - m_first_open];
+                    buffer.add_item(object);
+                    buffer.commit();
+                    if (buffer.committed() >= m_config.buffer_size) {
+                        (*m_writers[region - m_first_open])(std::move(buffer));
+                        buffer = osmium::memory::Buffer{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                    }
+                });
+            }
+
+            // Write the first group of outputs while reading the input,
+            // spill the objects for the other groups and write them
+            // afterwards.
+            void write_outputs() {
+                const std::size_t group_size = m_config.max_open_files;
+                const std::size_t num_groups = (m_outputs.size() + group_size - 1) / group_size;
+                detail::spill_file spill{num_groups, m_config.buffer_size};
+
+                osmium::io::Reader reader{m_input, osmium::osm_entity_bits::nwr};
+                const osmium::io::Header header{reader.header()};
+                open_outputs(header, 0, std::min(m_outputs.size(), group_size));
+
+                while (osmium::memory::Buffer input = reader.read()) {
+                    for (const auto& object : input.select<osmium::OSMObject>()) {
+                        if (object.type() != osmium::item_type::node &&
+                            object.type() != osmium::item_type::way &&
+                            object.type() != osmium::item_type::relation) {
+                            continue;
+                        }
+                        write_to_open_outputs(object);
+                        if (num_groups > 1) {
+                            // regions come in ascending order, so each
+                            // object is spilled at most once per group
+                            std::size_t last_group = 0;
+                            m_ids(object.type()).for_each_region(object.id(), [&](const uint32_t region) {
+                                const std::size_t group = region / group_size;
+                                if (group != last_group) {
+                                    spill.add(group, object);
+                                    last_group = group;
+                                }
+                            });
+                        }
+                    }
+                }
+                reader.close();
+                ++m_passes;
+                close_outputs();
+
+                spill.flush();
+                m_spilled_bytes = spill.bytes();
+
+                for (std::size_t group = 1; group < num_groups; ++group) {
+                    const std::size_t first = group * group_size;
+                    open_outputs(header, first, std::min(m_outputs.size(), first + group_size));
+                    spill.for_each_object(group, [this](const osmium::OSMObject& object) {
+                        write_to_open_outputs(object);
+                    });
+                    close_outputs();
+                }
+            }
+
+        public:
+
+            /**
+             * Create a Splitter for the given input file.
+             */
+            explicit Splitter(const osmium::io::File& input, const SplitterConfig& config = SplitterConfig{}) :
+                m_input(input),
+                m_config(config) {
+                if (m_config.max_open_files == 0) {
+                    throw std::invalid_argument{"max_open_files must be at least 1"};
+                }
+            }
+
+            /**
+             * Add an output for the given region.
+             *
+             * @returns The index of the output.
+             */
+            std::size_t add_region(const Region& region, const osmium::io::File& output) {
+                const auto index = add_output(output, region.envelope());
+                m_regions.emplace_back(region, static_cast<uint32_t>(index));
+                return index;
+            }
+
+            /**
+             * Add an output for the given bounding box.
+             *
+             * @returns The index of the output.
+             * @throws std::invalid_argument If the box is invalid.
+             */
+            std::size_t add_region(const osmium::Box& box, const osmium::io::File& output) {
+                return add_region(Region{box}, output);
+            }
+
+            /**
+             * Add an output for the given tile. A node on the border of
+             * two tiles is only in one of them.
+             *
+             * @returns The index of the output.
+             * @throws std::invalid_argument If the zoom level of the tile
+             *         is different from the zoom level of tiles added
+             *         before or larger than FixedZoomTiler::max_zoom or
+             *         the tile was added before.
+             */
+            std::size_t add_tile(const osmium::geom::Tile& tile, const osmium::io::File& output) {
+                if (!m_tiler) {
+                    m_tiler.reset(new osmium::geom::FixedZoomTiler{tile.z});
+                } else if (m_tiler->zoom() != tile.z) {
+                    throw std::invalid_argument{"all tiles added to a Splitter must have the same zoom level"};
+                }
+                if (m_tiles.count(tile_key(tile.x, tile.y))) {
+                    throw std::invalid_argument{"tile added twice to Splitter"};
+                }
+                const auto index = add_output(output, tile_envelope(tile));
+                m_tiles.emplace(tile_key(tile.x, tile.y), static_cast<uint32_t>(index));
+                return index;
+            }
+
+            /// The number of outputs.
+            std::size_t num_outputs() const noexcept {
+                return m_outputs.size();
+            }
+
+            /// The number of times the input was read so far.
+            std::size_t passes() const noexcept {
+                return m_passes;
+            }
+
+            /**
+             * The number of bytes written to the temporary file for the
+             * output groups after the first one.
+             */
+            std::size_t spilled_bytes() const noexcept {
+                return m_spilled_bytes;
+            }
+
+            /**
+             * Read the input and write all outputs. Can only be called
+             * once.
+             *
+             * @throws Any exception the Reader or Writers throw.
+             */
+            void operator()() {
+                if (m_passes > 0) {
+                    throw std::runtime_error{"Splitter can only be run once"};
+                }
+                assign();
+                write_outputs();
+                for (auto& ids : m_ids) {
+                    ids.clear();
+                }
+            }
+
+        }; // class Splitter
+
+    } // namespace extract
+
+} // namespace osmium
+
+#endif // OSMIUM_EXTRACT_SPLITTER_HPP
@@ -0,0 +1,229 @@
+#ifndef OSMIUM_GEOM_CLIP_HPP
+#define OSMIUM_GEOM_CLIP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        namespace detail {
+
+            enum class clip_edge {
+                left   = 0,
+                right  = 1,
+                bottom = 2,
+                top    = 3
+            }; // enum class clip_edge
+
+            inline bool inside_clip_edge(const Coordinates& p, clip_edge edge, const Coordinates& bottom_left, const Coordinates& top_right) noexcept {
+                switch (edge) {
+                    case clip_edge::left:
+                        return p.x >= bottom_left.x;
+                    case clip_edge::right:
+                        return p.x <= top_right.x;
+                    case clip_edge::bottom:
+                        return p.y >= bottom_left.y;
+                    default: // top
+                        break;
+                }
+                return p.y <= top_right.y;
+            }
+
+            // Intersection of the segment a-b with the line through the
+            // given edge. Must only be called if a and b are on different
+            // sides of the edge.
+            inline Coordinates intersect_clip_edge(const Coordinates& a, const Coordinates& b, clip_edge edge, const Coordinates& bottom_left, const Coordinates& top_right) noexcept {
+                if (edge == clip_edge::left || edge == clip_edge::right) {
+                    const double x = edge == clip_edge::left ? bottom_left.x : top_right.x;
+                    return Coordinates{x, a.y + (b.y - a.y) * (x - a.x) / (b.x - a.x)};
+                }
+                const double y = edge == clip_edge::bottom ? bottom_left.y : top_right.y;
+                return Coordinates{a.x + (b.x - a.x) * (y - a.y) / (b.y - a.y), y};
+            }
+
+            // Clip the segment a-b with the Liang-Barsky algorithm. Returns
+            // false if the segment is completely outside the box, otherwise
+            // sets t0 and t1 to the parameters of the inside part.
+            inline bool clip_segment(const Coordinates& a, const Coordinates& b, const Coordinates& bottom_left, const Coordinates& top_right, double& t0, double& t1) noexcept {
+                const double dx = b.x - a.x;
+                const double dy = b.y - a.y;
+                const double p[4] = {-dx, dx, -dy, dy};
+                const double q[4] = {a.x - bottom_left.x, top_right.x - a.x, a.y - bottom_left.y, top_right.y - a.y};
+
+                t0 = 0.0;
+                t1 = 1.0;
+                for (int k = 0; k < 4; ++k) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wfloat-equal"
+                    if (p[k] == 0.0) {
+#pragma GCC diagnostic pop
+                        if (q[k] < 0) {
+                            return false;
+                        }
+                    } else {
+                        const double r = q[k] / p[k];
+                        if (p[k] < 0) {
+                            if (r > t1) {
+                                return false;
+                            }
+                            t0 = std::max(t0, r);
+                        } else {
+                            if (r < t0) {
+                                return false;
+                            }
+                            t1 = std::min(t1, r);
+                        }
+                    }
+                }
+                return true;
+            }
+
+            inline Coordinates point_on_segment(const Coordinates& a, const Coordinates& b, double t) noexcept {
+                if (t <= 0.0) {
+                    return a;
+                }
+                if (t >= 1.0) {
+                    return b;
+                }
+                return Coordinates{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t};
+            }
+
+        } // namespace detail
+
+        /**
+         * Clip a closed ring to a box using the Sutherland-Hodgman
+         * algorithm. The result is a closed ring again, but where the ring
+         * went outside the box it can have (degenerate) edges along the
+         * boundary of the box. If nothing of the ring is inside the box,
+         * the ring will be empty afterwards.
+         *
+         * @param ring The points of the ring, the first and last point must
+         *             be the same. They are changed in place.
+         * @param bottom_left Bottom left corner of the box.
+         * @param top_right Top right corner of the box.
+         */
+        inline void clip_ring(std::vector<Coordinates>& ring, const Coordinates& bottom_left, const Coordinates& top_right) {
+            if (ring.size() < 4) {
+                ring.clear();
+                return;
+            }
+
+            ring.pop_back(); // work on open ring
+            std::vector<Coordinates> input;
+            for (const auto edge : {detail::clip_edge::left, detail::clip_edge::right, detail::clip_edge::bottom, detail::clip_edge::top}) {
+                using std::swap;
+                swap(input, ring);
+                ring.clear();
+
+                Coordinates prev = input.back();
+                bool prev_inside = detail::inside_clip_edge(prev, edge, bottom_left, top_right);
+                for (const auto& point : input) {
+                    const bool inside = detail::inside_clip_edge(point, edge, bottom_left, top_right);
+                    if (inside != prev_inside) {
+                        ring.push_back(detail::intersect_clip_edge(prev, point, edge, bottom_left, top_right));
+                    }
+                    if (inside) {
+                        ring.push_back(point);
+                    }
+                    prev = point;
+                    prev_inside = inside;
+                }
+
+                if (ring.empty()) {
+                    return;
+                }
+            }
+
+            ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+            if (ring.size() > 1 && ring.front() == ring.back()) {
+                ring.pop_back();
+            }
+            if (ring.size() < 3) {
+                ring.clear();
+                return;
+            }
+            ring.push_back(ring.front());
+        }
+
+        /**
+         * Clip a linestring to a box. Parts of the linestring outside the
+         * box are removed, so the result can consist of any number of
+         * linestrings.
+         *
+         * @param points The points of the linestring.
+         * @param bottom_left Bottom left corner of the box.
+         * @param top_right Top right corner of the box.
+         * @param parts The linestrings inside the box will be written here,
+         *              each has at least two different points.
+         */
+        inline void clip_linestring(const std::vector<Coordinates>& points, const Coordinates& bottom_left, const Coordinates& top_right, std::vector<std::vector<Coordinates>>& parts) {
+            parts.clear();
+
+            bool open = false;
+            for (std::size_t i = 1; i < points.size(); ++i) {
+                const auto& a = points[i - 1];
+                const auto& b = points[i];
+                double t0 = 0.0;
+                double t1 = 1.0;
+                if (!detail::clip_segment(a, b, bottom_left, top_right, t0, t1)) {
+                    open = false;
+                    continue;
+                }
+                if (!open || t0 > 0.0) {
+                    parts.emplace_back();
+                    parts.back().push_back(detail::point_on_segment(a, b, t0));
+                }
+                parts.back().push_back(detail::point_on_segment(a, b, t1));
+                open = t1 >= 1.0;
+            }
+
+            for (auto& part : parts) {
+                part.erase(std::unique(part.begin(), part.end()), part.end());
+            }
+            parts.erase(std::remove_if(parts.begin(), parts.end(), [](const std::vector<Coordinates>& part) {
+                return part.size() < 2;
+            }), parts.end());
+        }
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_CLIP_HPP
@@ -33,7 +33,9 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/geom/clip.hpp>
 #include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/simplify.hpp>
 #include <osmium/memory/collection.hpp>
 #include <osmium/memory/item.hpp>
 #include <osmium/osm/area.hpp>
@@ -48,7 +50,9 @@ DEALINGS IN THE SOFTWARE.
 #include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -141,28 +145,430 @@ namespace osmium {
 
         }; // class IdentityProjection
 
+        namespace detail {
+
+            /**
+             * Output policy for the string based geometry factory
+             * implementations (WKB, WKT, GeoJSON): Each geometry is built
+             * in an internal string which is then returned.
+             */
+            class string_output {
+
+                std::string m_str;
+
+            public:
+
+                using result_type = std::string;
+
+                /// Start a new geometry.
+                void start() noexcept {
+                    m_str.clear();
+                }
+
+                /// Discard the geometry started last if it isn't finished.
+                void rollback() noexcept {
+                    m_str.clear();
+                }
+
+                /// The string the geometry is appended to.
+                std::string& buffer() noexcept {
+                    return m_str;
+                }
+
+                /// Offset in buffer() of the geometry started last.
+                std::size_t start_offset() const noexcept {
+                    return 0;
+                }
+
+                /// Finish geometry and return it.
+                result_type finish() {
+                    std::string str;
+
+                    using std::swap;
+                    swap(str, m_str);
+
+                    return str;
+                }
+
+                /**
+                 * Build a complete geometry in one go by calling
+                 * func(str, offset) to append it to an empty string str at
+                 * the given offset (always 0). Used for points which don't
+                 * need any state in the factory.
+                 */
+                template <typename TFunc>
+                result_type make(TFunc&& func) const {
+                    std::string str;
+                    std::forward<TFunc>(func)(str, 0);
+                    return str;
+                }
+
+            }; // class string_output
+
+            /**
+             * Output policy for the string based geometry factory
+             * implementations (WKB, WKT, GeoJSON): All geometries are
+             * appended to a string provided by the caller and only their
+             * sizes are returned. The caller can clear the string whenever
+             * they want, its capacity is reused, so after a while no
+             * memory allocations are needed any more.
+             *
+             * If creating a geometry fails with an exception, the partial
+             * geometry is removed from the string again, so the string
+             * always contains complete geometries only.
+             */
+            class append_output {
+
+                std::string* m_out;
+                std::size_t m_start = 0;
+                bool m_active = false;
+
+            public:
+
+                using result_type = std::size_t;
+
+                explicit append_output(std::string& out) noexcept :
+                    m_out(&out) {
+                }
+
+                /// Start a new geometry.
+                void start() noexcept {
+                    m_start = m_out->size();
+                    m_active = true;
+                }
+
+                /// Discard the geometry started last if it isn't finished.
+                void rollback() noexcept {
+                    if (m_active) {
+                        m_out->resize(m_start);
+                        m_active = false;
+                    }
+                }
+
+                /// The string the geometry is appended to.
+                std::string& buffer() noexcept {
+                    return *m_out;
+                }
+
+                /// Offset in buffer() of the geometry started last.
+                std::size_t start_offset() const noexcept {
+                    return m_start;
+                }
+
+                /// Finish geometry and return the number of bytes appended.
+                result_type finish() noexcept {
+                    m_active = false;
+                    return m_out->size() - m_start;
+                }
+
+                /**
+                 * Build a complete geometry in one go by calling
+                 * func(str, offset) to append it to the output string str
+                 * which currently ends at the given offset. Used for points
+                 * which don't need any state in the factory.
+                 */
+                template <typename TFunc>
+                result_type make(TFunc&& func) const {
+                    const std::size_t start = m_out->size();
+                    try {
+                        std::forward<TFunc>(func)(*m_out, start);
+                    } catch (...) {
+                        m_out->resize(start);
+                        throw;
+                    }
+                    return m_out->size() - start;
+                }
+
+            }; // class append_output
+
+            // Does the projection have a batch version of operator()
+            // projecting an array of locations in one go?
+            template <typename TProjection>
+            class has_batch_projection {
+
+                template <typename T>
+                static auto check(int) -> decltype(std::declval<const T&>()(static_cast<const osmium::Location*>(nullptr), std::size_t{0}, static_cast<Coordinates*>(nullptr)), std::true_type{});
+
+                template <typename T>
+                static std::false_type check(...);
+
+            public:
+
+                using type = decltype(check<TProjection>(0));
+
+            }; // class has_batch_projection
+
+            // Does the factory implementation have a rollback() function
+            // discarding a partially created geometry?
+            template <typename TGeomImpl>
+            class has_rollback {
+
+                template <typename T>
+                static auto check(int) -> decltype(std::declval<T&>().rollback(), std::true_type{});
+
+                template <typename T>
+                static std::false_type check(...);
+
+            public:
+
+                using type = decltype(check<TGeomImpl>(0));
+
+            }; // class has_rollback
+
+            /**
+             * Calls rollback() on the factory implementation when it goes
+             * out of scope, removing the partial geometry from the output
+             * if creating it failed with an exception. After a geometry
+             * is finished this does nothing. For implementations without
+             * rollback() this is a no-op.
+             */
+            template <typename TGeomImpl, typename = typename has_rollback<TGeomImpl>::type>
+            class rollback_guard {
+
+                TGeomImpl& m_impl;
+
+            public:
+
+                explicit rollback_guard(TGeomImpl& impl) noexcept :
+                    m_impl(impl) {
+                }
+
+                rollback_guard(const rollback_guard&) = delete;
+                rollback_guard& operator=(const rollback_guard&) = delete;
+
+                ~rollback_guard() noexcept {
+                    m_impl.rollback();
+                }
+
+            }; // class rollback_guard
+
+            template <typename TGeomImpl>
+            class rollback_guard<TGeomImpl, std::false_type> {
+
+            public:
+
+                explicit rollback_guard(TGeomImpl& /*impl*/) noexcept {
+                }
+
+            }; // class rollback_guard
+
+        } // namespace detail
+
         /**
          * Geometry factory.
+         *
+         * If the projection has, in addition to the usual
+         *
+         * @code
+         * Coordinates operator()(osmium::Location location) const;
+         * @endcode
+         *
+         * a batch version
+         *
+         * @code
+         * void operator()(const osmium::Location* locations, std::size_t count, Coordinates* out) const;
+         * @endcode
+         *
+         * it is used to project all locations of a linestring, polygon, or
+         * ring at once. Only valid locations are handed to the batch
+         * version, if there are invalid locations osmium::invalid_location
+         * is thrown.
+         *
+         * Linestrings, polygons, and multipolygons can be simplified (see
+         * set_simplification()) and clipped to a box (see set_clip_box())
+         * before they are handed to the implementation. This is done on
+         * the projected coordinates. Points are never changed.
          */
         template <typename TGeomImpl, typename TProjection = IdentityProjection>
         class GeometryFactory {
 
             /**
-             * Add all points of an outer or inner ring to a multipolygon.
+             * Project the locations of the NodeRefs from it to end and call
+             * add() with the coordinates of each. If unique is set,
+             * consecutive nodes with the same location are only used once.
+             *
+             * @returns The number of points added.
              */
-            void add_points(const osmium::NodeRefList& nodes) {
+            template <typename TIter, typename TAdd>
+            std::size_t project(TIter it, TIter end, bool unique, TAdd&& add, std::false_type /*batch*/) {
+                std::size_t num_points = 0;
+                osmium::Location last_location;
+                for (; it != end; ++it) {
+                    if (!unique || last_location != it->location()) {
+                        last_location = it->location();
+                        add(m_projection(last_location));
+                        ++num_points;
+                    }
+                }
+                return num_points;
+            }
+
+            template <typename TIter, typename TAdd>
+            std::size_t project(TIter it, TIter end, bool unique, TAdd&& add, std::true_type /*batch*/) {
+                m_locations.clear();
                 osmium::Location last_location;
-                for (const osmium::NodeRef& node_ref : nodes) {
-                    if (last_location != node_ref.location()) {
-                        last_location = node_ref.location();
-                        m_impl.multipolygon_add_location(m_projection(last_location));
+                for (; it != end; ++it) {
+                    if (!unique || last_location != it->location()) {
+                        last_location = it->location();
+                        if (!last_location.valid()) {
+                            throw osmium::invalid_location{"invalid location"};
+                        }
+                        m_locations.push_back(last_location);
                     }
                 }
+
+                m_coordinates.resize(m_locations.size());
+                m_projection(m_locations.data(), m_locations.size(), m_coordinates.data());
+                for (const auto& coordinates : m_coordinates) {
+                    add(coordinates);
+                }
+
+                return m_locations.size();
+            }
+
+            template <typename TIter, typename TAdd>
+            std::size_t project(TIter it, TIter end, bool unique, TAdd&& add) {
+                return project(it, end, unique, std::forward<TAdd>(add), typename detail::has_batch_projection<TProjection>::type{});
+            }
+
+            /**
+             * Add all points of an outer or inner ring to a multipolygon.
+             */
+            void add_points(const osmium::NodeRefList& nodes) {
+                project(nodes.cbegin(), nodes.cend(), true, [this](const Coordinates& c) {
+                    m_impl.multipolygon_add_location(c);
+                });
             }
 
             TProjection m_projection;
             TGeomImpl m_impl;
 
+            // Only used for projections with batch version
+            std::vector<osmium::Location> m_locations;
+            std::vector<Coordinates> m_coordinates;
+
+            // Simplification and clipping
+            simplification m_simplification = simplification::none;
+            double m_tolerance = 0.0;
+            bool m_clip = false;
+            Coordinates m_clip_bottom_left;
+            Coordinates m_clip_top_right;
+            std::vector<Coordinates> m_points;
+            std::vector<std::vector<Coordinates>> m_parts;
+
+            bool processing() const noexcept {
+                return m_simplification != simplification::none || m_clip;
+            }
+
+            // Project the nodes into m_points.
+            template <typename TIter>
+            void collect_points(TIter it, TIter end, bool unique) {
+                m_points.clear();
+                project(it, end, unique, [this](const Coordinates& c) {
+                    m_points.push_back(c);
+                });
+            }
+
+            void collect_points(const osmium::NodeRefList& nodes, use_nodes un, direction dir) {
+                if (dir == direction::forward) {
+                    collect_points(nodes.cbegin(), nodes.cend(), un == use_nodes::unique);
+                } else {
+                    collect_points(nodes.crbegin(), nodes.crend(), un == use_nodes::unique);
+                }
+            }
+
+            // Simplify and clip the linestring in m_points. The resulting
+            // linestrings are in m_parts.
+            void process_linestring() {
+                if (m_points.size() < 2) {
+                    throw osmium::geometry_error{"need at least two points for linestring"};
+                }
+                simplify(m_points, m_simplification, m_tolerance);
+                if (m_clip) {
+                    clip_linestring(m_points, m_clip_bottom_left, m_clip_top_right, m_parts);
+                } else {
+                    m_parts.resize(1);
+                    using std::swap;
+                    swap(m_parts.front(), m_points);
+                }
+            }
+
+            // Simplify and clip the ring in m_points. Returns false if
+            // nothing is left of it.
+            bool process_ring() {
+                simplify(m_points, m_simplification, m_tolerance);
+                if (m_clip) {
+                    clip_ring(m_points, m_clip_bottom_left, m_clip_top_right);
+                }
+                return m_points.size() >= 4;
+            }
+
+            typename TGeomImpl::linestring_type make_linestring(const std::vector<Coordinates>& points) {
+                m_impl.linestring_start();
+                for (const auto& c : points) {
+                    m_impl.linestring_add_location(c);
+                }
+                return m_impl.linestring_finish(points.size());
+            }
+
+            void add_ring_points() {
+                for (const auto& c : m_points) {
+                    m_impl.multipolygon_add_location(c);
+                }
+            }
+
+            typename TGeomImpl::multipolygon_type create_processed_multipolygon(const osmium::Area& area) {
+                std::size_t num_polygons = 0;
+                std::size_t num_rings = 0;
+                bool skip_inner_rings = true;
+                m_impl.multipolygon_start();
+
+                for (const auto& item : area) {
+                    if (item.type() == osmium::item_type::outer_ring) {
+                        auto& ring = static_cast<const osmium::OuterRing&>(item);
+                        ++num_rings;
+                        collect_points(ring.cbegin(), ring.cend(), true);
+                        skip_inner_rings = !process_ring();
+                        if (skip_inner_rings) {
+                            continue;
+                        }
+                        if (num_polygons > 0) {
+                            m_impl.multipolygon_polygon_finish();
+                        }
+                        m_impl.multipolygon_polygon_start();
+                        m_impl.multipolygon_outer_ring_start();
+                        add_ring_points();
+                        m_impl.multipolygon_outer_ring_finish();
+                        ++num_polygons;
+                    } else if (item.type() == osmium::item_type::inner_ring) {
+                        auto& ring = static_cast<const osmium::InnerRing&>(item);
+                        ++num_rings;
+                        if (skip_inner_rings) {
+                            continue;
+                        }
+                        collect_points(ring.cbegin(), ring.cend(), true);
+                        if (!process_ring()) {
+                            continue;
+                        }
+                        m_impl.multipolygon_inner_ring_start();
+                        add_ring_points();
+                        m_impl.multipolygon_inner_ring_finish();
+                    }
+                }
+
+                // if there are no rings, this area is invalid
+                if (num_rings == 0) {
+                    throw osmium::geometry_error{"invalid area"};
+                }
+
+                if (num_polygons == 0) {
+                    throw osmium::geometry_error{"nothing left of area after simplification or clipping"};
+                }
+
+                m_impl.multipolygon_polygon_finish();
+                return m_impl.multipolygon_finish();
+            }
+
         public:
 
             GeometryFactory<TGeomImpl, TProjection>() :
@@ -205,6 +611,50 @@ namespace osmium {
                 return m_projection.proj_string();
             }
 
+            /**
+             * Simplify all linestrings, polygons, and multipolygon rings
+             * created from now on with the given algorithm. The tolerance
+             * is in units of the projection (for Visvalingam-Whyatt it is
+             * an area, so in units squared). Rings that have less than four
+             * points after simplification are removed.
+             *
+             * Simplification is only done by the create_linestring(),
+             * create_linestrings(), create_polygon(), and
+             * create_multipolygon() functions, not when using the
+             * linestring_start(), fill_linestring(), ... functions.
+             */
+            void set_simplification(simplification algorithm, double tolerance) noexcept {
+                m_simplification = algorithm;
+                m_tolerance = tolerance;
+            }
+
+            /**
+             * Clip all linestrings, polygons, and multipolygons created from
+             * now on to the given box (in units of the projection). Polygon
+             * rings are clipped with the Sutherland-Hodgman algorithm, so
+             * they can have edges along the boundary of the box.
+             *
+             * Clipping can split a linestring into several parts, use
+             * create_linestrings() to get all of them. Clipping is done after
+             * simplification.
+             *
+             * @throws std::invalid_argument if the box is empty.
+             */
+            void set_clip_box(const Coordinates& bottom_left, const Coordinates& top_right) {
+                if (!bottom_left.valid() || !top_right.valid() ||
+                    bottom_left.x >= top_right.x || bottom_left.y >= top_right.y) {
+                    throw std::invalid_argument{"invalid clip box"};
+                }
+                m_clip = true;
+                m_clip_bottom_left = bottom_left;
+                m_clip_top_right = top_right;
+            }
+
+            /// Do not clip geometries any more.
+            void clear_clip_box() noexcept {
+                m_clip = false;
+            }
+
             /* Point */
 
             point_type create_point(const osmium::Location& location) const {
@@ -237,32 +687,40 @@ namespace osmium {
 
             template <typename TIter>
             size_t fill_linestring(TIter it, TIter end) {
-                size_t num_points = 0;
-                for (; it != end; ++it, ++num_points) {
-                    m_impl.linestring_add_location(m_projection(it->location()));
-                }
-                return num_points;
+                return project(it, end, false, [this](const Coordinates& c) {
+                    m_impl.linestring_add_location(c);
+                });
             }
 
             template <typename TIter>
             size_t fill_linestring_unique(TIter it, TIter end) {
-                size_t num_points = 0;
-                osmium::Location last_location;
-                for (; it != end; ++it) {
-                    if (last_location != it->location()) {
-                        last_location = it->location();
-                        m_impl.linestring_add_location(m_projection(last_location));
-                        ++num_points;
-                    }
-                }
-                return num_points;
+                return project(it, end, true, [this](const Coordinates& c) {
+                    m_impl.linestring_add_location(c);
+                });
             }
 
             linestring_type linestring_finish(size_t num_points) {
                 return m_impl.linestring_finish(num_points);
             }
 
+            /**
+             * Create linestring from the nodes. If a clip box is set and the
+             * clipped linestring has more than one part or nothing is left
+             * of it, osmium::geometry_error is thrown.
+             */
             linestring_type create_linestring(const osmium::WayNodeList& wnl, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
+                const detail::rollback_guard<TGeomImpl> guard{m_impl};
+
+                if (processing()) {
+                    collect_points(wnl, un, dir);
+                    process_linestring();
+                    if (m_parts.size() != 1) {
+                        throw osmium::geometry_error{m_parts.empty() ? "nothing left of linestring after clipping"
+                                                                     : "linestring split into several parts by clipping"};
+                    }
+                    return make_linestring(m_parts.front());
+                }
+
                 linestring_start();
                 size_t num_points = 0;
 
@@ -302,6 +760,35 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Create linestrings from the nodes after simplification and
+             * clipping and call func() with each of them. Clipping can
+             * create any number of linestrings.
+             *
+             * @returns The number of linestrings created.
+             */
+            template <typename TFunc>
+            std::size_t create_linestrings(const osmium::WayNodeList& wnl, TFunc&& func, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
+                const detail::rollback_guard<TGeomImpl> guard{m_impl};
+
+                collect_points(wnl, un, dir);
+                process_linestring();
+                for (const auto& part : m_parts) {
+                    std::forward<TFunc>(func)(make_linestring(part));
+                }
+                return m_parts.size();
+            }
+
+            template <typename TFunc>
+            std::size_t create_linestrings(const osmium::Way& way, TFunc&& func, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
+                try {
+                    return create_linestrings(way.nodes(), std::forward<TFunc>(func), un, dir);
+                } catch (osmium::geometry_error& e) {
+                    e.set_id("way", way.id());
+                    throw;
+                }
+            }
+
             /* Polygon */
 
             void polygon_start() {
@@ -310,25 +797,16 @@ namespace osmium {
 
             template <typename TIter>
             size_t fill_polygon(TIter it, TIter end) {
-                size_t num_points = 0;
-                for (; it != end; ++it, ++num_points) {
-                    m_impl.polygon_add_location(m_projection(it->location()));
-                }
-                return num_points;
+                return project(it, end, false, [this](const Coordinates& c) {
+                    m_impl.polygon_add_location(c);
+                });
             }
 
             template <typename TIter>
             size_t fill_polygon_unique(TIter it, TIter end) {
-                size_t num_points = 0;
-                osmium::Location last_location;
-                for (; it != end; ++it) {
-                    if (last_location != it->location()) {
-                        last_location = it->location();
-                        m_impl.polygon_add_location(m_projection(last_location));
-                        ++num_points;
-                    }
-                }
-                return num_points;
+                return project(it, end, true, [this](const Coordinates& c) {
+                    m_impl.polygon_add_location(c);
+                });
             }
 
             polygon_type polygon_finish(size_t num_points) {
@@ -336,6 +814,23 @@ namespace osmium {
             }
 
             polygon_type create_polygon(const osmium::WayNodeList& wnl, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
+                const detail::rollback_guard<TGeomImpl> guard{m_impl};
+
+                if (processing()) {
+                    collect_points(wnl, un, dir);
+                    if (m_points.size() < 4) {
+                        throw osmium::geometry_error{"need at least four points for polygon"};
+                    }
+                    if (!process_ring()) {
+                        throw osmium::geometry_error{"nothing left of polygon after simplification or clipping"};
+                    }
+                    polygon_start();
+                    for (const auto& c : m_points) {
+                        m_impl.polygon_add_location(c);
+                    }
+                    return polygon_finish(m_points.size());
+                }
+
                 polygon_start();
                 size_t num_points = 0;
 
@@ -378,7 +873,13 @@ namespace osmium {
             /* MultiPolygon */
 
             multipolygon_type create_multipolygon(const osmium::Area& area) {
+                const detail::rollback_guard<TGeomImpl> guard{m_impl};
+
                 try {
+                    if (processing()) {
+                        return create_processed_multipolygon(area);
+                    }
+
                     size_t num_polygons = 0;
                     size_t num_rings = 0;
                     m_impl.multipolygon_start();
@@ -47,135 +47,157 @@ namespace osmium {
 
         namespace detail {
 
-            class GeoJSONFactoryImpl {
-
-                std::string m_str;
+            /**
+             * Geometry factory implementation creating GeoJSON. The TOutput
+             * policy decides whether each geometry is returned as a new
+             * string (string_output) or appended to a string provided by
+             * the caller (append_output).
+             */
+            template <typename TOutput>
+            class BasicGeoJSONFactoryImpl {
+
+                TOutput m_output;
                 int m_precision;
 
+                void start(const char* head) {
+                    m_output.start();
+                    m_output.buffer() += head;
+                }
+
             public:
 
-                using point_type        = std::string;
-                using linestring_type   = std::string;
-                using polygon_type      = std::string;
-                using multipolygon_type = std::string;
-                using ring_type         = std::string;
+                using point_type        = typename TOutput::result_type;
+                using linestring_type   = typename TOutput::result_type;
+                using polygon_type      = typename TOutput::result_type;
+                using multipolygon_type = typename TOutput::result_type;
+                using ring_type         = typename TOutput::result_type;
 
-                explicit GeoJSONFactoryImpl(int /*srid*/, int precision = 7) :
+                explicit BasicGeoJSONFactoryImpl(int /*srid*/, int precision = 7) :
                     m_precision(precision) {
                 }
 
+                /**
+                 * Constructor for the append_output policy. All geometries
+                 * will be appended to the string out.
+                 */
+                explicit BasicGeoJSONFactoryImpl(int /*srid*/, std::string& out, int precision = 7) :
+                    m_output(out),
+                    m_precision(precision) {
+                }
+
+                /// Discard the geometry started last if it isn't finished.
+                void rollback() noexcept {
+                    m_output.rollback();
+                }
+
                 /* Point */
 
                 // { "type": "Point", "coordinates": [100.0, 0.0] }
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
-                    std::string str{"{\"type\":\"Point\",\"coordinates\":"};
-                    xy.append_to_string(str, '[', ',', ']', m_precision);
-                    str += "}";
-                    return str;
+                    return m_output.make([&](std::string& str, std::size_t /*offset*/) {
+                        str += "{\"type\":\"Point\",\"coordinates\":";
+                        xy.append_to_string(str, '[', ',', ']', m_precision);
+                        str += "}";
+                    });
                 }
 
                 /* LineString */
 
                 // { "type": "LineString", "coordinates": [ [100.0, 0.0], [101.0, 1.0] ] }
                 void linestring_start() {
-                    m_str = "{\"type\":\"LineString\",\"coordinates\":[";
+                    start("{\"type\":\"LineString\",\"coordinates\":[");
                 }
 
                 void linestring_add_location(const osmium::geom::Coordinates& xy) {
-                    xy.append_to_string(m_str, '[', ',', ']', m_precision);
-                    m_str += ',';
+                    xy.append_to_string(m_output.buffer(), '[', ',', ']', m_precision);
+                    m_output.buffer() += ',';
                 }
 
                 linestring_type linestring_finish(size_t /*num_points*/) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ']';
-                    str += "}";
-                    return str;
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ']';
+                    m_output.buffer() += "}";
+                    return m_output.finish();
                 }
 
                 /* Polygon */
                 void polygon_start() {
-                    m_str = "{\"type\":\"Polygon\",\"coordinates\":[[";
+                    start("{\"type\":\"Polygon\",\"coordinates\":[[");
                 }
 
                 void polygon_add_location(const osmium::geom::Coordinates& xy) {
-                    xy.append_to_string(m_str, '[', ',', ']', m_precision);
-                    m_str += ',';
+                    xy.append_to_string(m_output.buffer(), '[', ',', ']', m_precision);
+                    m_output.buffer() += ',';
                 }
 
                 polygon_type polygon_finish(size_t /*num_points*/) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ']';
-                    str += "]}";
-                    return str;
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ']';
+                    m_output.buffer() += "]}";
+                    return m_output.finish();
                 }
 
                 /* MultiPolygon */
 
                 void multipolygon_start() {
-                    m_str = "{\"type\":\"MultiPolygon\",\"coordinates\":[";
+                    start("{\"type\":\"MultiPolygon\",\"coordinates\":[");
                 }
 
                 void multipolygon_polygon_start() {
-                    m_str += '[';
+                    m_output.buffer() += '[';
                 }
 
                 void multipolygon_polygon_finish() {
-                    m_str += "],";
+                    m_output.buffer() += "],";
                 }
 
                 void multipolygon_outer_ring_start() {
-                    m_str += '[';
+                    m_output.buffer() += '[';
                 }
 
                 void multipolygon_outer_ring_finish() {
-                    assert(!m_str.empty());
-                    m_str.back() = ']';
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ']';
                 }
 
                 void multipolygon_inner_ring_start() {
-                    m_str += ",[";
+                    m_output.buffer() += ",[";
                 }
 
                 void multipolygon_inner_ring_finish() {
-                    assert(!m_str.empty());
-                    m_str.back() = ']';
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ']';
                 }
 
                 void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
-                    xy.append_to_string(m_str, '[', ',', ']', m_precision);
-                    m_str += ',';
+                    xy.append_to_string(m_output.buffer(), '[', ',', ']', m_precision);
+                    m_output.buffer() += ',';
                 }
 
                 multipolygon_type multipolygon_finish() {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ']';
-                    str += "}";
-                    return str;
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ']';
+                    m_output.buffer() += "}";
+                    return m_output.finish();
                 }
 
-            }; // class GeoJSONFactoryImpl
+            }; // class BasicGeoJSONFactoryImpl
+
+            using GeoJSONFactoryImpl = BasicGeoJSONFactoryImpl<string_output>;
 
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using GeoJSONFactory = GeometryFactory<osmium::geom::detail::GeoJSONFactoryImpl, TProjection>;
 
+        /**
+         * GeoJSON factory appending all geometries to a string given to
+         * the constructor. The create_*() functions return the number of
+         * bytes appended.
+         */
+        template <typename TProjection = IdentityProjection>
+        using GeoJSONAppendFactory = GeometryFactory<osmium::geom::detail::BasicGeoJSONFactoryImpl<osmium::geom::detail::append_output>, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
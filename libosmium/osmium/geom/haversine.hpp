@@ -38,7 +38,9 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/node_ref_list.hpp>
 #include <osmium/osm/way.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <iterator>
 
 namespace osmium {
@@ -58,6 +60,103 @@ namespace osmium {
             /// @brief Earth's quadratic mean radius for WGS84
             constexpr const double EARTH_RADIUS_IN_METERS = 6372797.560856;
 
+            namespace detail {
+
+                // Sine for -PI/2 <= x <= PI/2 as Taylor polynomial up to
+                // x^19. The error is below the precision of a double in
+                // this range. There are no branches or library calls in
+                // here, so loops calling this can be vectorized.
+                constexpr inline double sin_polynomial(double x) noexcept {
+                    return x * (1.0 + x * x *
+                              (-1.6666666666666666e-1 + x * x *
+                              ( 8.3333333333333333e-3 + x * x *
+                              (-1.9841269841269841e-4 + x * x *
+                              ( 2.7557319223985893e-6 + x * x *
+                              (-2.5052108385441720e-8 + x * x *
+                              ( 1.6059043836821613e-10 + x * x *
+                              (-7.6471637318198164e-13 + x * x *
+                              ( 2.8114572543455206e-15 + x * x *
+                              (-8.2206352466243297e-18))))))))));
+                }
+
+                // Arcsine for 0 <= x <= max_x_for_asin_polynomial as Taylor
+                // polynomial up to x^19. The error is below the precision
+                // of a double in this range.
+                constexpr inline double asin_polynomial(double x) noexcept {
+                    return x * (1.0 + x * x *
+                              (1.6666666666666666e-1 + x * x *
+                              (7.5000000000000000e-2 + x * x *
+                              (4.4642857142857144e-2 + x * x *
+                              (3.0381944444444444e-2 + x * x *
+                              (2.2372159090909092e-2 + x * x *
+                              (1.7352764423076924e-2 + x * x *
+                              (1.3964843750000000e-2 + x * x *
+                              (1.1551800896139705e-2 + x * x *
+                              (9.7616095291940776e-3))))))))));
+                }
+
+                // This is sin(d / (2 * EARTH_RADIUS_IN_METERS)) for a
+                // distance d of about 1600 km.
+                constexpr const double max_x_for_asin_polynomial = 0.125;
+
+                // Cosine for -PI/2 <= x <= PI/2.
+                constexpr inline double cos_polynomial(double x) noexcept {
+                    return sin_polynomial(PI / 2 - (x < 0 ? -x : x));
+                }
+
+                // The number of points handled in one go by the length()
+                // function.
+                constexpr const std::size_t length_chunk_size = 256;
+
+                /**
+                 * Calculate the haversine distances between count - 1
+                 * pairs of neighbouring points given as longitudes,
+                 * latitudes (both in radians) and the cosine of the
+                 * latitudes and write them into out.
+                 */
+                inline void haversine_distances(const double* lon, const double* lat, const double* cos_lat, std::size_t count, double* out) noexcept {
+                    for (std::size_t i = 1; i < count; ++i) {
+                        double lonh = std::abs(lon[i - 1] - lon[i]) * 0.5;
+                        lonh = sin_polynomial(std::min(lonh, PI - lonh));
+                        const double lath = sin_polynomial((lat[i - 1] - lat[i]) * 0.5);
+                        out[i - 1] = std::sqrt(lath * lath + cos_lat[i - 1] * cos_lat[i] * lonh * lonh);
+                    }
+
+                    for (std::size_t i = 0; i < count - 1; ++i) {
+                        out[i] = asin_polynomial(out[i]);
+                    }
+
+                    // Fix up the few very long segments.
+                    for (std::size_t i = 1; i < count; ++i) {
+                        if (out[i - 1] > max_x_for_asin_polynomial) {
+                            const double lonh = std::sin((lon[i - 1] - lon[i]) * 0.5);
+                            const double lath = std::sin((lat[i - 1] - lat[i]) * 0.5);
+                            out[i - 1] = std::asin(std::sqrt(lath * lath + cos_lat[i - 1] * cos_lat[i] * lonh * lonh));
+                        }
+                    }
+
+                    for (std::size_t i = 0; i < count - 1; ++i) {
+                        out[i] *= 2.0 * EARTH_RADIUS_IN_METERS;
+                    }
+                }
+
+                /**
+                 * Calculate the distances between count - 1 pairs of
+                 * neighbouring points using the equirectangular
+                 * approximation. See haversine_distances() for the
+                 * parameters.
+                 */
+                inline void equirectangular_distances(const double* lon, const double* lat, const double* cos_lat, std::size_t count, double* out) noexcept {
+                    for (std::size_t i = 1; i < count; ++i) {
+                        double dlon = std::abs(lon[i - 1] - lon[i]);
+                        dlon = std::min(dlon, 2 * PI - dlon) * (cos_lat[i - 1] + cos_lat[i]) * 0.5;
+                        const double dlat = lat[i - 1] - lat[i];
+                        out[i - 1] = EARTH_RADIUS_IN_METERS * std::sqrt(dlon * dlon + dlat * dlat);
+                    }
+                }
+
+            } // namespace detail
+
             /**
              * Calculate distance in meters between two sets of coordinates.
              *
@@ -102,6 +201,93 @@ namespace osmium {
                 return sum_length;
             }
 
+            /**
+             * The method used by the length() function to calculate the
+             * distance between neighbouring nodes.
+             */
+            enum class length_method {
+
+                /**
+                 * Use the haversine formula. The results are the same as
+                 * those of the distance() functions except for rounding
+                 * errors.
+                 */
+                haversine = 0,
+
+                /**
+                 * Use the equirectangular approximation, which is faster
+                 * but less exact for longer segments and near the poles.
+                 * For segments shorter than 10 km at latitudes between -80
+                 * and 80 degrees the relative error compared to the
+                 * haversine formula is below 0.001 percent.
+                 */
+                equirectangular = 1
+
+            }; // enum class length_method
+
+            /**
+             * Calculate length of node list. This does the same as the
+             * distance() function, but faster, because the nodes are
+             * handled in batches: The coordinates are converted to radians
+             * and the cosines of the latitudes are calculated only once per
+             * node and the distances are calculated in loops using
+             * polynomial approximations of the trigonometric functions,
+             * which the compiler can vectorize.
+             *
+             * @param nrl The node list, usually the nodes of a way.
+             * @param method The method used for calculating the distances.
+             * @throws osmium::invalid_location if any of the locations is
+             *         invalid.
+             */
+            inline double length(const osmium::NodeRefList& nrl, length_method method = length_method::haversine) {
+                constexpr const std::size_t chunk_size = detail::length_chunk_size;
+
+                // One more than the chunk size, because the last point of
+                // a chunk is copied to the beginning of the next one.
+                double lon[chunk_size + 1];
+                double lat[chunk_size + 1];
+                double cos_lat[chunk_size + 1];
+                double distances[chunk_size];
+
+                double sum_length = 0;
+                std::size_t count = 0;
+
+                for (auto it = nrl.begin(); it != nrl.end();) {
+                    for (; it != nrl.end() && count <= chunk_size; ++it, ++count) {
+                        const osmium::Location location = it->location();
+                        if (!location.valid()) {
+                            throw osmium::invalid_location{"invalid location"};
+                        }
+                        lon[count] = deg_to_rad(location.lon_without_check());
+                        lat[count] = deg_to_rad(location.lat_without_check());
+                    }
+
+                    for (std::size_t i = 0; i < count; ++i) {
+                        cos_lat[i] = detail::cos_polynomial(lat[i]);
+                    }
+
+                    if (count < 2) {
+                        break;
+                    }
+
+                    if (method == length_method::haversine) {
+                        detail::haversine_distances(lon, lat, cos_lat, count, distances);
+                    } else {
+                        detail::equirectangular_distances(lon, lat, cos_lat, count, distances);
+                    }
+
+                    for (std::size_t i = 0; i < count - 1; ++i) {
+                        sum_length += distances[i];
+                    }
+
+                    lon[0] = lon[count - 1];
+                    lat[0] = lat[count - 1];
+                    count = 1;
+                }
+
+                return sum_length;
+            }
+
         } // namespace haversine
 
     } // namespace geom
@@ -37,7 +37,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/geom/util.hpp>
 #include <osmium/osm/location.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace osmium {
@@ -57,20 +60,14 @@ namespace osmium {
                 return earth_radius_for_epsg3857 * std::log(std::tan(osmium::geom::PI / 4 + deg_to_rad(lat) / 2));
             }
 
-#ifdef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
-            inline double lat_to_y(double lat) {
-                return lat_to_y_with_tan(lat);
-            }
-#else
-
             // This is a much faster implementation than the canonical
             // implementation using the tan() function. For details
-            // see https://github.com/osmcode/mercator-projection .
-            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
-                if (lat < -78.0 || lat > 78.0) {
-                    return lat_to_y_with_tan(lat);
-                }
-
+            // see https://github.com/osmcode/mercator-projection . It is
+            // only valid for latitudes between -78 and 78 degrees, the
+            // maximum error in that range is about 3.5 mm. There are no
+            // branches or library calls in here, so loops calling this
+            // can be vectorized by the compiler.
+            constexpr inline double lat_to_y_polynomial(double lat) noexcept {
                 return earth_radius_for_epsg3857 *
                     ((((((((((-3.1112583378460085319e-23  * lat +
                                2.0465852743943268009e-19) * lat +
@@ -94,6 +91,21 @@ namespace osmium {
                               -3.4554675198786337842e-4)  * lat +
                               -5.4367203601085991108e-4)  * lat + 1.0);
             }
+
+            constexpr double max_lat_for_polynomial = 78.0;
+
+#ifdef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
+            inline double lat_to_y(double lat) {
+                return lat_to_y_with_tan(lat);
+            }
+#else
+            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
+                if (lat < -max_lat_for_polynomial || lat > max_lat_for_polynomial) {
+                    return lat_to_y_with_tan(lat);
+                }
+
+                return lat_to_y_polynomial(lat);
+            }
 #endif
 
             constexpr inline double x_to_lon(double x) {
@@ -135,6 +147,80 @@ namespace osmium {
             return Coordinates{detail::x_to_lon(c.x), detail::y_to_lat(c.y)};
         }
 
+        /**
+         * Convert count locations from WGS84 lon/lat to web mercator and
+         * write the results to out. The results are the same as those of
+         * calling lonlat_to_mercator() on each location, but this is
+         * faster for many locations: The main loop only uses the
+         * polynomial approximation, so the compiler can vectorize it. The
+         * few locations further north or south than 78 degrees are fixed
+         * up afterwards.
+         *
+         * @pre All locations must be valid and have a latitude between
+         *      -MERCATOR_MAX_LAT and MERCATOR_MAX_LAT.
+         * @pre out must have space for count Coordinates.
+         */
+        inline void lonlat_to_mercator(const osmium::Location* locations, std::size_t count, Coordinates* out) {
+#ifdef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i].x = detail::lon_to_x(locations[i].lon_without_check());
+                out[i].y = detail::lat_to_y(locations[i].lat_without_check());
+            }
+#else
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i].x = detail::lon_to_x(locations[i].lon_without_check());
+                out[i].y = detail::lat_to_y_polynomial(locations[i].lat_without_check());
+            }
+
+            constexpr const int32_t max_y = static_cast<int32_t>(detail::max_lat_for_polynomial * osmium::detail::coordinate_precision);
+            for (std::size_t i = 0; i < count; ++i) {
+                if (locations[i].y() < -max_y || locations[i].y() > max_y) {
+                    out[i].y = detail::lat_to_y_with_tan(locations[i].lat_without_check());
+                }
+            }
+#endif
+        }
+
+        /**
+         * Convert count coordinates from WGS84 lon/lat to web mercator and
+         * write the results to out, which can be the same as in. See the
+         * version of this function taking Locations for details.
+         *
+         * @pre All coordinates must be valid and in the range described
+         *      for lonlat_to_mercator().
+         * @pre out must have space for count Coordinates.
+         */
+        inline void lonlat_to_mercator(const Coordinates* in, std::size_t count, Coordinates* out) {
+#ifdef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = lonlat_to_mercator(in[i]);
+            }
+#else
+            // Work in chunks, remembering the latitudes for the fix up,
+            // because in and out can be the same.
+            constexpr const std::size_t chunk_size = 256;
+            double lats[chunk_size];
+            for (std::size_t start = 0; start < count; start += chunk_size) {
+                const std::size_t num = std::min(chunk_size, count - start);
+                const Coordinates* chunk_in = in + start;
+                Coordinates* chunk_out = out + start;
+
+                for (std::size_t i = 0; i < num; ++i) {
+                    lats[i] = chunk_in[i].y;
+                }
+                for (std::size_t i = 0; i < num; ++i) {
+                    chunk_out[i].x = detail::lon_to_x(chunk_in[i].x);
+                    chunk_out[i].y = detail::lat_to_y_polynomial(lats[i]);
+                }
+                for (std::size_t i = 0; i < num; ++i) {
+                    if (lats[i] < -detail::max_lat_for_polynomial || lats[i] > detail::max_lat_for_polynomial) {
+                        chunk_out[i].y = detail::lat_to_y_with_tan(lats[i]);
+                    }
+                }
+            }
+#endif
+        }
+
         /**
          * Functor that does projection from WGS84 (EPSG:4326) to "Web
          * Mercator" (EPSG:3857)
@@ -161,6 +247,19 @@ namespace osmium {
                 return Coordinates{detail::lon_to_x(location.lon()), detail::lat_to_y(location.lat())};
             }
 
+            /**
+             * Do coordinate transformation for count locations and write
+             * the results to out. Used by the GeometryFactory for all
+             * locations of a linestring or ring at once.
+             *
+             * @pre All locations must be valid and in the range given for
+             *      the single location version.
+             * @pre out must have space for count Coordinates.
+             */
+            void operator()(const osmium::Location* locations, std::size_t count, Coordinates* out) const {
+                lonlat_to_mercator(locations, count, out);
+            }
+
             int epsg() const noexcept {
                 return 3857;
             }
@@ -0,0 +1,358 @@
+#ifndef OSMIUM_GEOM_MVT_HPP
+#define OSMIUM_GEOM_MVT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/factory.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/tile.hpp>
+#include <osmium/geom/twkb.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        namespace detail {
+
+            /**
+             * Geometry factory implementation creating the geometry
+             * encoding used in Mapbox Vector Tiles (see
+             * https://github.com/mapbox/vector-tile-spec): A sequence of
+             * MoveTo, LineTo, and ClosePath commands with zigzag encoded
+             * deltas in the integer coordinates of a tile. The result is
+             * the content of the packed "geometry" field of a feature,
+             * i.e. the commands encoded as varints.
+             *
+             * The coordinates must be in Web Mercator (use the
+             * MercatorProjection). They are transformed into the local
+             * coordinates of the tile given to the constructor and
+             * rounded to integers. Points that end up in the same place
+             * as the point before them are removed. Rings are oriented as
+             * the specification requires. Linestrings with fewer than two
+             * and rings with fewer than three remaining points are
+             * dropped (and with outer rings their inner rings). If
+             * nothing is left of a geometry, a geometry_error is thrown.
+             *
+             * Geometries are not clipped to the tile, use the
+             * set_clip_box() function of the GeometryFactory for that.
+             *
+             * The TOutput policy decides whether each geometry is
+             * returned as a new string (string_output) or appended to a
+             * string provided by the caller (append_output).
+             */
+            template <typename TOutput>
+            class BasicMVTFactoryImpl {
+
+                enum command_type : uint32_t {
+                    command_move_to    = 1,
+                    command_line_to    = 2,
+                    command_close_path = 7
+                }; // enum command_type
+
+                struct point {
+                    int64_t x;
+                    int64_t y;
+                };
+
+                TOutput m_output;
+                double m_origin_x;
+                double m_origin_y;
+                double m_scale;
+
+                // Last point written, coordinates are written as deltas.
+                int64_t m_x = 0;
+                int64_t m_y = 0;
+
+                // Points of the current linestring or ring.
+                std::vector<point> m_points;
+
+                // Number of rings written in the current geometry and
+                // whether the last outer ring was dropped.
+                std::size_t m_rings = 0;
+                bool m_skip_inner_rings = false;
+
+                point to_tile(const osmium::geom::Coordinates& xy) const noexcept {
+                    return point{std::llround((xy.x - m_origin_x) * m_scale),
+                                 std::llround((m_origin_y - xy.y) * m_scale)};
+                }
+
+                static void command(std::string& str, command_type id, std::size_t count) {
+                    str_push_varint(str, static_cast<uint32_t>(id) | (static_cast<uint32_t>(count) << 3U));
+                }
+
+                static uint32_t zigzag(int64_t value) {
+                    if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) {
+                        throw geometry_error{"coordinate out of range for vector tile"};
+                    }
+                    return protozero::encode_zigzag32(static_cast<int32_t>(value));
+                }
+
+                void write_point(std::string& str, const point& p) {
+                    str_push_varint(str, zigzag(p.x - m_x));
+                    str_push_varint(str, zigzag(p.y - m_y));
+                    m_x = p.x;
+                    m_y = p.y;
+                }
+
+                void write_points(std::string& str) {
+                    command(str, command_move_to, 1);
+                    write_point(str, m_points.front());
+                    command(str, command_line_to, m_points.size() - 1);
+                    for (auto it = std::next(m_points.begin()); it != m_points.end(); ++it) {
+                        write_point(str, *it);
+                    }
+                }
+
+                void add_point(const osmium::geom::Coordinates& xy) {
+                    const point p = to_tile(xy);
+                    if (m_points.empty() || p.x != m_points.back().x || p.y != m_points.back().y) {
+                        m_points.push_back(p);
+                    }
+                }
+
+                // Write the ring in m_points (if anything is left of it)
+                // with the orientation needed for outer or inner rings.
+                bool write_ring(bool outer) {
+                    if (m_points.size() > 1 && m_points.front().x == m_points.back().x && m_points.front().y == m_points.back().y) {
+                        m_points.pop_back();
+                    }
+                    if (m_points.size() < 3) {
+                        return false;
+                    }
+
+                    // Twice the area using the surveyor's formula. It is
+                    // positive for outer rings in tile coordinates.
+                    int64_t area = 0;
+                    for (std::size_t i = 0, j = m_points.size() - 1; i < m_points.size(); j = i++) {
+                        area += m_points[j].x * m_points[i].y - m_points[i].x * m_points[j].y;
+                    }
+                    if (area == 0) {
+                        return false;
+                    }
+                    if ((area > 0) != outer) {
+                        std::reverse(m_points.begin(), m_points.end());
+                    }
+
+                    write_points(m_output.buffer());
+                    command(m_output.buffer(), command_close_path, 1);
+                    ++m_rings;
+                    return true;
+                }
+
+                void start() {
+                    m_output.start();
+                    m_x = 0;
+                    m_y = 0;
+                    m_points.clear();
+                    m_rings = 0;
+                }
+
+            public:
+
+                enum {
+                    default_extent = 4096
+                };
+
+                using point_type        = typename TOutput::result_type;
+                using linestring_type   = typename TOutput::result_type;
+                using polygon_type      = typename TOutput::result_type;
+                using multipolygon_type = typename TOutput::result_type;
+                using ring_type         = typename TOutput::result_type;
+
+                /**
+                 * Constructor.
+                 *
+                 * @param srid Must be 3857 (Web Mercator).
+                 * @param tile The tile the geometries are created for.
+                 * @param extent The size of the tile in integer
+                 *               coordinates.
+                 * @throws std::invalid_argument If the srid is not 3857.
+                 */
+                BasicMVTFactoryImpl(int srid, const osmium::geom::Tile& tile, uint32_t extent = default_extent) :
+                    m_origin_x(-detail::max_coordinate_epsg3857 + tile.x * tile_extent_in_zoom(tile.z)),
+                    m_origin_y(detail::max_coordinate_epsg3857 - tile.y * tile_extent_in_zoom(tile.z)),
+                    m_scale(extent / tile_extent_in_zoom(tile.z)) {
+                    if (srid != 3857) {
+                        throw std::invalid_argument{"vector tile geometries need Web Mercator coordinates"};
+                    }
+                }
+
+                /**
+                 * Constructor for the append_output policy. All geometries
+                 * will be appended to the string out.
+                 */
+                BasicMVTFactoryImpl(int srid, std::string& out, const osmium::geom::Tile& tile, uint32_t extent = default_extent) :
+                    m_output(out),
+                    m_origin_x(-detail::max_coordinate_epsg3857 + tile.x * tile_extent_in_zoom(tile.z)),
+                    m_origin_y(detail::max_coordinate_epsg3857 - tile.y * tile_extent_in_zoom(tile.z)),
+                    m_scale(extent / tile_extent_in_zoom(tile.z)) {
+                    if (srid != 3857) {
+                        throw std::invalid_argument{"vector tile geometries need Web Mercator coordinates"};
+                    }
+                }
+
+                /// Discard the geometry started last if it isn't finished.
+                void rollback() noexcept {
+                    m_output.rollback();
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    const point p = to_tile(xy);
+                    return m_output.make([&](std::string& str, const std::size_t /*offset*/) {
+                        command(str, command_move_to, 1);
+                        str_push_varint(str, zigzag(p.x));
+                        str_push_varint(str, zigzag(p.y));
+                    });
+                }
+
+                /* LineString */
+
+                void linestring_start() {
+                    start();
+                }
+
+                void linestring_add_location(const osmium::geom::Coordinates& xy) {
+                    add_point(xy);
+                }
+
+                linestring_type linestring_finish(std::size_t /*num_points*/) {
+                    if (m_points.size() < 2) {
+                        throw geometry_error{"nothing left of linestring in vector tile"};
+                    }
+                    write_points(m_output.buffer());
+                    return m_output.finish();
+                }
+
+                /* Polygon */
+
+                void polygon_start() {
+                    start();
+                }
+
+                void polygon_add_location(const osmium::geom::Coordinates& xy) {
+                    add_point(xy);
+                }
+
+                polygon_type polygon_finish(std::size_t /*num_points*/) {
+                    if (!write_ring(true)) {
+                        throw geometry_error{"nothing left of polygon in vector tile"};
+                    }
+                    return m_output.finish();
+                }
+
+                /* MultiPolygon */
+
+                void multipolygon_start() {
+                    start();
+                }
+
+                void multipolygon_polygon_start() {
+                }
+
+                void multipolygon_polygon_finish() {
+                }
+
+                void multipolygon_outer_ring_start() {
+                    m_points.clear();
+                }
+
+                void multipolygon_outer_ring_finish() {
+                    m_skip_inner_rings = !write_ring(true);
+                }
+
+                void multipolygon_inner_ring_start() {
+                    m_points.clear();
+                }
+
+                void multipolygon_inner_ring_finish() {
+                    if (!m_skip_inner_rings) {
+                        write_ring(false);
+                    }
+                }
+
+                void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
+                    add_point(xy);
+                }
+
+                multipolygon_type multipolygon_finish() {
+                    if (m_rings == 0) {
+                        throw geometry_error{"nothing left of area in vector tile"};
+                    }
+                    return m_output.finish();
+                }
+
+            }; // class BasicMVTFactoryImpl
+
+            using MVTFactoryImpl = BasicMVTFactoryImpl<string_output>;
+
+        } // namespace detail
+
+        /**
+         * Factory creating Mapbox Vector Tile geometries for the tile
+         * given to the constructor:
+         *
+         * @code
+         * osmium::geom::MVTFactory<> factory{osmium::geom::Tile{14, 8529, 5613}};
+         * @endcode
+         */
+        template <typename TProjection = MercatorProjection>
+        using MVTFactory = GeometryFactory<osmium::geom::detail::MVTFactoryImpl, TProjection>;
+
+        /**
+         * Vector tile geometry factory appending all geometries to a
+         * string given to the constructor. The create_*() functions return
+         * the number of bytes appended.
+         */
+        template <typename TProjection = MercatorProjection>
+        using MVTAppendFactory = GeometryFactory<osmium::geom::detail::BasicMVTFactoryImpl<osmium::geom::detail::append_output>, TProjection>;
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_MVT_HPP
@@ -0,0 +1,288 @@
+#ifndef OSMIUM_GEOM_PROJ_PROJECTION_HPP
+#define OSMIUM_GEOM_PROJ_PROJECTION_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * This file contains code for projecting OSM locations to arbitrary
+ * coordinate reference systems using the transformation API of the PROJ
+ * library version 6.1 or newer.
+ *
+ * @attention If you include this file, you'll need to link with `libproj`.
+ */
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/util.hpp>
+#include <osmium/osm/location.hpp>
+
+#include <proj.h>
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace osmium {
+
+    namespace geom {
+
+        namespace detail {
+
+            struct ProjContextDeleter {
+                void operator()(PJ_CONTEXT* context) const noexcept {
+                    proj_context_destroy(context);
+                }
+            }; // struct ProjContextDeleter
+
+            struct ProjDeleter {
+                void operator()(PJ* pj) const noexcept {
+                    proj_destroy(pj);
+                }
+            }; // struct ProjDeleter
+
+        } // namespace detail
+
+        /**
+         * Functor that does projection from WGS84 (EPSG:4326) to the given
+         * CRS using the PROJ transformation API. Use this instead of the
+         * Projection class which uses the deprecated proj_api.h.
+         *
+         * The CRS can be given as EPSG code or as any string PROJ
+         * understands as CRS definition, for instance "EPSG:32632", a
+         * PROJ string like "+proj=utm +zone=32 +datum=WGS84", or WKT. The
+         * axis order of the result is always x/y or lon/lat, the unit is
+         * degrees for geographic CRS.
+         *
+         * If this projection is initialized with the constructor taking
+         * an integer with the epsg code 4326, no projection is done. If it
+         * is initialized with epsg code 3857 the Osmium-internal
+         * implementation of the Mercator projection is used. This does not
+         * happen if you use the constructor taking a string.
+         *
+         * Each ProjProjection has its own PROJ context. PROJ objects must
+         * not be used from several threads at the same time, so each thread
+         * needs its own ProjProjection. Copying a ProjProjection creates a
+         * new context and transformation, so the easiest way to do this is
+         * to give each thread its own copy or its own GeometryFactory.
+         *
+         * There is a batch version of operator() which the GeometryFactory
+         * uses to project all locations of a way or ring in one call to
+         * proj_trans_generic().
+         */
+        class ProjProjection {
+
+            int m_epsg;
+            std::string m_crs;
+
+            // The order is important here, the transformation must be
+            // destroyed before its context.
+            std::unique_ptr<PJ_CONTEXT, detail::ProjContextDeleter> m_context;
+            std::unique_ptr<PJ, detail::ProjDeleter> m_transformation;
+
+            void init() {
+                if (m_epsg == 4326 || m_epsg == 3857) {
+                    return;
+                }
+
+                m_context.reset(proj_context_create());
+                if (!m_context) {
+                    throw osmium::projection_error{"creation of PROJ context failed"};
+                }
+
+                std::unique_ptr<PJ, detail::ProjDeleter> transformation{
+                    proj_create_crs_to_crs(m_context.get(), "EPSG:4326", m_crs.c_str(), nullptr)};
+                if (!transformation) {
+                    throw osmium::projection_error{std::string{"creation of transformation to CRS '"} + m_crs + "' failed: " + error_string(proj_context_errno(m_context.get()))};
+                }
+
+                // Always use lon/lat and x/y axis order.
+                m_transformation.reset(proj_normalize_for_visualization(m_context.get(), transformation.get()));
+                if (!m_transformation) {
+                    throw osmium::projection_error{std::string{"creation of transformation to CRS '"} + m_crs + "' failed: " + error_string(proj_context_errno(m_context.get()))};
+                }
+            }
+
+            static std::string error_string(int error) {
+                const char* message = proj_errno_string(error);
+                return message ? message : "unknown error";
+            }
+
+            // PROJ returns HUGE_VAL coordinates if a transformation fails.
+            Coordinates check(const Coordinates& c) const {
+                if (!std::isfinite(c.x) || !std::isfinite(c.y)) {
+                    throw osmium::projection_error{std::string{"projection failed: "} + error_string(proj_errno(m_transformation.get()))};
+                }
+                return c;
+            }
+
+        public:
+
+            explicit ProjProjection(const std::string& crs) :
+                m_epsg(-1),
+                m_crs(crs) {
+                init();
+            }
+
+            explicit ProjProjection(const char* crs) :
+                ProjProjection(std::string{crs}) {
+            }
+
+            explicit ProjProjection(int epsg) :
+                m_epsg(epsg),
+                m_crs(std::string{"EPSG:"} + std::to_string(epsg)) {
+                init();
+            }
+
+            /**
+             * Copy constructor. The copy has its own PROJ context and
+             * can be used in a different thread.
+             */
+            ProjProjection(const ProjProjection& other) :
+                m_epsg(other.m_epsg),
+                m_crs(other.m_crs) {
+                init();
+            }
+
+            ProjProjection& operator=(const ProjProjection& other) {
+                ProjProjection copy{other};
+                swap(copy);
+                return *this;
+            }
+
+            ProjProjection(ProjProjection&&) noexcept = default;
+
+            ProjProjection& operator=(ProjProjection&& other) noexcept {
+                swap(other);
+                return *this;
+            }
+
+            ~ProjProjection() noexcept = default;
+
+            void swap(ProjProjection& other) noexcept {
+                using std::swap;
+                swap(m_epsg, other.m_epsg);
+                swap(m_crs, other.m_crs);
+                swap(m_context, other.m_context);
+                swap(m_transformation, other.m_transformation);
+            }
+
+            /**
+             * Do coordinate transformation.
+             *
+             * @pre Location must be in valid range (depends on projection
+             *      used).
+             * @throws osmium::projection_error if the projection fails
+             */
+            Coordinates operator()(osmium::Location location) const {
+                if (m_epsg == 4326) {
+                    return Coordinates{location.lon(), location.lat()};
+                }
+
+                if (m_epsg == 3857) {
+                    return Coordinates{detail::lon_to_x(location.lon()),
+                                       detail::lat_to_y(location.lat())};
+                }
+
+                const PJ_COORD c = proj_trans(m_transformation.get(), PJ_FWD, proj_coord(location.lon(), location.lat(), 0, 0));
+                return check(Coordinates{c.xy.x, c.xy.y});
+            }
+
+            /**
+             * Do coordinate transformation for count locations and write
+             * the results to out. This is done with one call to the PROJ
+             * library which is much faster than one call per location.
+             *
+             * @pre out must have space for count Coordinates.
+             * @throws osmium::projection_error if the projection fails for
+             *         any of the locations
+             * @throws osmium::invalid_location if any of the locations is
+             *         invalid
+             */
+            void operator()(const osmium::Location* locations, std::size_t count, Coordinates* out) const {
+                static_assert(std::is_standard_layout<Coordinates>::value && sizeof(Coordinates) == 2 * sizeof(double),
+                              "Coordinates must be two doubles for proj_trans_generic()");
+
+                if (m_epsg == 3857) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (!locations[i].valid()) {
+                            throw osmium::invalid_location{"invalid location"};
+                        }
+                    }
+                    lonlat_to_mercator(locations, count, out);
+                    return;
+                }
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i].x = locations[i].lon();
+                    out[i].y = locations[i].lat();
+                }
+
+                if (m_epsg == 4326 || count == 0) {
+                    return;
+                }
+
+                proj_trans_generic(m_transformation.get(), PJ_FWD,
+                                   &out->x, sizeof(Coordinates), count,
+                                   &out->y, sizeof(Coordinates), count,
+                                   nullptr, 0, 0,
+                                   nullptr, 0, 0);
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    check(out[i]);
+                }
+            }
+
+            int epsg() const noexcept {
+                return m_epsg;
+            }
+
+            /**
+             * The CRS definition given in the constructor or "EPSG:" and
+             * the EPSG code.
+             */
+            std::string proj_string() const {
+                return m_crs;
+            }
+
+        }; // class ProjProjection
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_PROJ_PROJECTION_HPP
@@ -0,0 +1,243 @@
+#ifndef OSMIUM_GEOM_SIMPLIFY_HPP
+#define OSMIUM_GEOM_SIMPLIFY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        /**
+         * Line simplification algorithms.
+         */
+        enum class simplification {
+            none            = 0,
+            douglas_peucker = 1, ///< Douglas-Peucker, tolerance is a distance
+            visvalingam     = 2  ///< Visvalingam-Whyatt, tolerance is an area
+        }; // enum class simplification
+
+        namespace detail {
+
+            // Squared distance of point p from the segment a-b.
+            inline double squared_segment_distance(const Coordinates& p, const Coordinates& a, const Coordinates& b) noexcept {
+                double x = a.x;
+                double y = a.y;
+                const double dx = b.x - x;
+                const double dy = b.y - y;
+
+                const double length = dx * dx + dy * dy;
+                if (length > 0) {
+                    const double t = ((p.x - x) * dx + (p.y - y) * dy) / length;
+                    if (t > 1) {
+                        x = b.x;
+                        y = b.y;
+                    } else if (t > 0) {
+                        x += dx * t;
+                        y += dy * t;
+                    }
+                }
+
+                const double ex = p.x - x;
+                const double ey = p.y - y;
+                return ex * ex + ey * ey;
+            }
+
+            // Area of the triangle a-b-c.
+            inline double triangle_area(const Coordinates& a, const Coordinates& b, const Coordinates& c) noexcept {
+                return std::abs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+            }
+
+            // Remove all points not marked in keep.
+            inline void remove_unmarked(std::vector<Coordinates>& points, const std::vector<bool>& keep) {
+                std::size_t out = 0;
+                for (std::size_t i = 0; i < points.size(); ++i) {
+                    if (keep[i]) {
+                        points[out++] = points[i];
+                    }
+                }
+                points.resize(out);
+            }
+
+        } // namespace detail
+
+        /**
+         * Simplify a linestring or ring using the Douglas-Peucker
+         * algorithm. Removes all points whose distance from the simplified
+         * line is less than or equal to the tolerance. The first and last
+         * point are always kept, so rings stay closed.
+         *
+         * @param points The points of the linestring or ring. They are
+         *               changed in place.
+         * @param tolerance Maximum distance in the units of the coordinates.
+         */
+        inline void simplify_douglas_peucker(std::vector<Coordinates>& points, double tolerance) {
+            if (points.size() < 3) {
+                return;
+            }
+
+            const double squared_tolerance = tolerance * tolerance;
+            std::vector<bool> keep(points.size(), false);
+            keep.front() = true;
+            keep.back() = true;
+
+            std::vector<std::pair<std::size_t, std::size_t>> stack;
+            stack.emplace_back(0, points.size() - 1);
+            while (!stack.empty()) {
+                const auto first = stack.back().first;
+                const auto last = stack.back().second;
+                stack.pop_back();
+
+                double max_distance = 0.0;
+                std::size_t index = 0;
+                for (std::size_t i = first + 1; i < last; ++i) {
+                    const double distance = detail::squared_segment_distance(points[i], points[first], points[last]);
+                    if (distance > max_distance) {
+                        index = i;
+                        max_distance = distance;
+                    }
+                }
+
+                if (max_distance > squared_tolerance) {
+                    keep[index] = true;
+                    stack.emplace_back(first, index);
+                    stack.emplace_back(index, last);
+                }
+            }
+
+            detail::remove_unmarked(points, keep);
+        }
+
+        /**
+         * Simplify a linestring or ring using the Visvalingam-Whyatt
+         * algorithm. Repeatedly removes the point which forms the triangle
+         * with the smallest area with its neighbours until all triangles
+         * are larger than the given area. The first and last point are
+         * always kept, so rings stay closed.
+         *
+         * @param points The points of the linestring or ring. They are
+         *               changed in place.
+         * @param min_area Minimum triangle area in the units of the
+         *                 coordinates squared.
+         */
+        inline void simplify_visvalingam(std::vector<Coordinates>& points, double min_area) {
+            const std::size_t size = points.size();
+            if (size < 3) {
+                return;
+            }
+
+            std::vector<std::size_t> prev(size);
+            std::vector<std::size_t> next(size);
+            std::vector<double> area(size, std::numeric_limits<double>::max());
+            std::vector<bool> keep(size, true);
+
+            using entry = std::pair<double, std::size_t>;
+            std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+
+            for (std::size_t i = 1; i < size - 1; ++i) {
+                prev[i] = i - 1;
+                next[i] = i + 1;
+                area[i] = detail::triangle_area(points[i - 1], points[i], points[i + 1]);
+                queue.emplace(area[i], i);
+            }
+
+            while (!queue.empty()) {
+                const entry e = queue.top();
+                queue.pop();
+
+                // skip outdated entries
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wfloat-equal"
+                if (!keep[e.second] || e.first != area[e.second]) {
+                    continue;
+                }
+#pragma GCC diagnostic pop
+
+                if (e.first >= min_area) {
+                    break;
+                }
+
+                // Remove point and update neighbours. The area of a
+                // neighbour is never set below the area of the removed point
+                // so that points are removed in the order of their
+                // "effective area".
+                const std::size_t i = e.second;
+                keep[i] = false;
+                const std::size_t p = prev[i];
+                const std::size_t n = next[i];
+                next[p] = n;
+                prev[n] = p;
+                if (p != 0) {
+                    area[p] = std::max(e.first, detail::triangle_area(points[prev[p]], points[p], points[n]));
+                    queue.emplace(area[p], p);
+                }
+                if (n != size - 1) {
+                    area[n] = std::max(e.first, detail::triangle_area(points[p], points[n], points[next[n]]));
+                    queue.emplace(area[n], n);
+                }
+            }
+
+            detail::remove_unmarked(points, keep);
+        }
+
+        /**
+         * Simplify linestring or ring with the given algorithm.
+         */
+        inline void simplify(std::vector<Coordinates>& points, simplification algorithm, double tolerance) {
+            switch (algorithm) {
+                case simplification::none:
+                    break;
+                case simplification::douglas_peucker:
+                    simplify_douglas_peucker(points, tolerance);
+                    break;
+                case simplification::visvalingam:
+                    simplify_visvalingam(points, tolerance);
+                    break;
+            }
+        }
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_SIMPLIFY_HPP
@@ -38,7 +38,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 
 #include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
 
 namespace osmium {
 
@@ -203,6 +208,162 @@ namespace osmium {
             return lhs.y < rhs.y;
         }
 
+        /**
+         * Calculates the tiles containing locations for one fixed zoom
+         * level using only integer arithmetic on the fixed-point
+         * coordinates of the locations. Use this instead of the Tile
+         * constructor if you need the tiles for many locations.
+         *
+         * The tile x coordinate is calculated directly from the longitude.
+         * For the y coordinate the constructor splits the latitude range
+         * into buckets so small that each contains at most one edge
+         * between tile rows and stores the row and that edge for each
+         * bucket. A lookup is then a shift, one table access, and one
+         * comparison. The table needs between 45 and 90 * 2^zoom bytes
+         * (about 1 MB for zoom level 14, 13 MB for zoom level 18), so the
+         * zoom level is limited to max_zoom.
+         *
+         * The result is exact for the Mercator projection. It can differ
+         * from the result of the Tile constructor for locations within a
+         * few millimeters of a tile edge, because that uses an
+         * approximation for the projection.
+         */
+        class FixedZoomTiler {
+
+            struct bucket {
+                // The row of the southernmost latitude in this bucket.
+                uint32_t row;
+                // Locations north of this are in the row above. Set to
+                // the maximum value if there is no edge in this bucket.
+                int32_t edge;
+            }; // struct bucket
+
+            // Latitudes outside this range are clamped.
+            enum : int32_t {
+                min_y = -850511287,
+                max_y = 850511287
+            };
+
+            std::vector<bucket> m_buckets;
+            uint32_t m_zoom;
+            uint32_t m_shift = 0;
+
+            // The latitude of the top edge of tile row k (in fixed-point
+            // format). A location is in row k or further south if its
+            // latitude is smaller than or equal to this.
+            static int32_t top_edge(const uint32_t zoom, const uint32_t k) {
+                const double lat = detail::y_to_lat(detail::max_coordinate_epsg3857 - k * tile_extent_in_zoom(zoom));
+                return static_cast<int32_t>(std::floor(lat * osmium::detail::coordinate_precision));
+            }
+
+        public:
+
+            enum {
+                max_zoom = 18U
+            };
+
+            /**
+             * Create a tiler for the given zoom level.
+             *
+             * @throws std::invalid_argument If zoom is larger than
+             *         max_zoom.
+             */
+            explicit FixedZoomTiler(uint32_t zoom) :
+                m_buckets(),
+                m_zoom(zoom) {
+                if (zoom > max_zoom) {
+                    throw std::invalid_argument{"zoom level too large for FixedZoomTiler"};
+                }
+
+                // Edges between rows from south to north.
+                const uint32_t num_rows = num_tiles_in_zoom(zoom);
+                std::vector<int32_t> edges;
+                edges.reserve(num_rows - 1);
+                for (uint32_t k = num_rows - 1; k > 0; --k) {
+                    edges.push_back(top_edge(zoom, k));
+                }
+
+                // The rows are narrowest at the top, the bucket size must
+                // not be larger than that.
+                if (num_rows > 1) {
+                    const int64_t min_height = static_cast<int64_t>(max_y) - edges.back();
+                    while ((2LL << m_shift) <= min_height) {
+                        ++m_shift;
+                    }
+                } else {
+                    m_shift = 31;
+                }
+
+                const auto num_buckets = static_cast<std::size_t>((static_cast<int64_t>(max_y) - min_y) >> m_shift) + 1;
+                m_buckets.reserve(num_buckets);
+                auto edge = edges.cbegin();
+                uint32_t row = num_rows - 1;
+                for (std::size_t b = 0; b < num_buckets; ++b) {
+                    const int64_t first = min_y + (static_cast<int64_t>(b) << m_shift);
+                    while (edge != edges.cend() && *edge < first) {
+                        ++edge;
+                        --row;
+                    }
+                    const int64_t last = first + (1LL << m_shift) - 1;
+                    if (edge != edges.cend() && *edge < last) {
+                        m_buckets.push_back(bucket{row, *edge});
+                    } else {
+                        m_buckets.push_back(bucket{row, std::numeric_limits<int32_t>::max()});
+                    }
+                }
+            }
+
+            /// The zoom level of this tiler.
+            uint32_t zoom() const noexcept {
+                return m_zoom;
+            }
+
+            /**
+             * Get the tile x coordinate for the given longitude in
+             * fixed-point format (as returned by Location::x()).
+             */
+            uint32_t tile_x(const int32_t x) const noexcept {
+                constexpr const int64_t half_circle = 180LL * osmium::detail::coordinate_precision;
+                const auto tx = static_cast<uint64_t>((static_cast<int64_t>(x) + half_circle) << m_zoom) /
+                                static_cast<uint64_t>(2 * half_circle);
+                return static_cast<uint32_t>(detail::clamp<uint64_t>(tx, 0, num_tiles_in_zoom(m_zoom) - 1));
+            }
+
+            /**
+             * Get the tile y coordinate for the given latitude in
+             * fixed-point format (as returned by Location::y()).
+             */
+            uint32_t tile_y(const int32_t y) const noexcept {
+                const int32_t clamped = detail::clamp<int32_t>(y, min_y, max_y);
+                const bucket& b = m_buckets[static_cast<std::size_t>((static_cast<int64_t>(clamped) - min_y) >> m_shift)];
+                return b.row - (clamped > b.edge ? 1 : 0);
+            }
+
+            /**
+             * Get the tile containing the location.
+             *
+             * @pre @code location.valid() @endcode
+             */
+            Tile operator()(const osmium::Location& location) const noexcept {
+                return Tile{m_zoom, tile_x(location.x()), tile_y(location.y())};
+            }
+
+            /**
+             * Get the tile coordinates for count locations. The x and y
+             * coordinates are written to the arrays tx and ty.
+             *
+             * @pre All locations must be valid.
+             * @pre tx and ty must have space for count values.
+             */
+            void operator()(const osmium::Location* locations, std::size_t count, uint32_t* tx, uint32_t* ty) const noexcept {
+                for (std::size_t i = 0; i < count; ++i) {
+                    tx[i] = tile_x(locations[i].x());
+                    ty[i] = tile_y(locations[i].y());
+                }
+            }
+
+        }; // class FixedZoomTiler
+
     } // namespace geom
 
 } // namespace osmium
@@ -0,0 +1,321 @@
+#ifndef OSMIUM_GEOM_TWKB_HPP
+#define OSMIUM_GEOM_TWKB_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/factory.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        namespace detail {
+
+            /// Append value as (protobuf-style) varint to str.
+            inline void str_push_varint(std::string& str, uint64_t value) {
+                while (value >= 0x80U) {
+                    str += static_cast<char>((value & 0x7fU) | 0x80U);
+                    value >>= 7U;
+                }
+                str += static_cast<char>(value);
+            }
+
+            /**
+             * Geometry factory implementation creating TWKB ("Tiny Well
+             * Known Binary", see https://github.com/TWKB/Specification).
+             * Coordinates are rounded to the given number of decimal
+             * digits (precision) and stored as zigzag encoded varint
+             * deltas to the previous point. With the IdentityProjection
+             * and the default precision of 7 the coordinates are exactly
+             * the fixed-point coordinates of the Locations.
+             *
+             * Neither bounding boxes nor sizes are written.
+             *
+             * The TOutput policy decides whether each geometry is
+             * returned as a new string (string_output) or appended to a
+             * string provided by the caller (append_output).
+             */
+            template <typename TOutput>
+            class BasicTWKBFactoryImpl {
+
+                enum twkb_type : uint8_t {
+                    twkb_point        = 1,
+                    twkb_linestring   = 2,
+                    twkb_polygon      = 3,
+                    twkb_multipolygon = 6
+                }; // enum twkb_type
+
+                TOutput m_output;
+                double m_scale;
+                uint8_t m_precision;
+
+                // Last point written, coordinates are written as deltas.
+                int64_t m_x = 0;
+                int64_t m_y = 0;
+
+                // Linestrings and multipolygons are collected here, because
+                // the number of points, rings, and polygons have to be
+                // written in front of them.
+                std::string m_points;
+                std::vector<std::size_t> m_structure;
+                std::vector<std::size_t> m_ring_ends;
+                std::size_t m_polygon_index = 0;
+                std::size_t m_ring_index = 0;
+
+                void header(std::string& str, twkb_type type) const {
+                    str += static_cast<char>(type | m_precision);
+                    str += '\0'; // no metadata
+                }
+
+                void add_point(std::string& str, const osmium::geom::Coordinates& xy) {
+                    const int64_t x = std::llround(xy.x * m_scale);
+                    const int64_t y = std::llround(xy.y * m_scale);
+                    str_push_varint(str, protozero::encode_zigzag64(x - m_x));
+                    str_push_varint(str, protozero::encode_zigzag64(y - m_y));
+                    m_x = x;
+                    m_y = y;
+                }
+
+                void ring_finish() {
+                    m_ring_ends.push_back(m_points.size());
+                }
+
+                void start(twkb_type type) {
+                    m_output.start();
+                    header(m_output.buffer(), type);
+                    m_x = 0;
+                    m_y = 0;
+                    m_points.clear();
+                }
+
+            public:
+
+                enum {
+                    default_precision = 7
+                };
+
+                using point_type        = typename TOutput::result_type;
+                using linestring_type   = typename TOutput::result_type;
+                using polygon_type      = typename TOutput::result_type;
+                using multipolygon_type = typename TOutput::result_type;
+                using ring_type         = typename TOutput::result_type;
+
+                /**
+                 * Constructor.
+                 *
+                 * @param precision Number of decimal digits kept of each
+                 *                  coordinate (-7 to 7). Use 7 for
+                 *                  lon/lat coordinates, something like
+                 *                  2 for coordinates in meters.
+                 * @throws std::invalid_argument If the precision is out of
+                 *         range.
+                 */
+                explicit BasicTWKBFactoryImpl(int /*srid*/, int precision = default_precision) :
+                    m_scale(std::pow(10.0, precision)),
+                    m_precision(static_cast<uint8_t>(protozero::encode_zigzag32(precision) << 4U)) {
+                    if (precision < -7 || precision > 7) {
+                        throw std::invalid_argument{"TWKB precision must be between -7 and 7"};
+                    }
+                }
+
+                /**
+                 * Constructor for the append_output policy. All geometries
+                 * will be appended to the string out.
+                 */
+                BasicTWKBFactoryImpl(int /*srid*/, std::string& out, int precision = default_precision) :
+                    m_output(out),
+                    m_scale(std::pow(10.0, precision)),
+                    m_precision(static_cast<uint8_t>(protozero::encode_zigzag32(precision) << 4U)) {
+                    if (precision < -7 || precision > 7) {
+                        throw std::invalid_argument{"TWKB precision must be between -7 and 7"};
+                    }
+                }
+
+                /// Discard the geometry started last if it isn't finished.
+                void rollback() noexcept {
+                    m_output.rollback();
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    return m_output.make([&](std::string& str, const std::size_t /*offset*/) {
+                        header(str, twkb_point);
+                        str_push_varint(str, protozero::encode_zigzag64(std::llround(xy.x * m_scale)));
+                        str_push_varint(str, protozero::encode_zigzag64(std::llround(xy.y * m_scale)));
+                    });
+                }
+
+                /* LineString */
+
+                void linestring_start() {
+                    start(twkb_linestring);
+                }
+
+                void linestring_add_location(const osmium::geom::Coordinates& xy) {
+                    add_point(m_points, xy);
+                }
+
+                linestring_type linestring_finish(std::size_t num_points) {
+                    str_push_varint(m_output.buffer(), num_points);
+                    m_output.buffer() += m_points;
+                    return m_output.finish();
+                }
+
+                /* Polygon */
+
+                void polygon_start() {
+                    start(twkb_polygon);
+                }
+
+                void polygon_add_location(const osmium::geom::Coordinates& xy) {
+                    add_point(m_points, xy);
+                }
+
+                polygon_type polygon_finish(std::size_t num_points) {
+                    str_push_varint(m_output.buffer(), 1); // one ring
+                    str_push_varint(m_output.buffer(), num_points);
+                    m_output.buffer() += m_points;
+                    return m_output.finish();
+                }
+
+                /* MultiPolygon */
+
+                // m_structure contains the number of rings of each polygon
+                // followed by the number of points in each of its rings,
+                // m_ring_ends the end of the points of each ring in
+                // m_points.
+
+                void multipolygon_start() {
+                    start(twkb_multipolygon);
+                    m_structure.clear();
+                    m_ring_ends.clear();
+                }
+
+                void multipolygon_polygon_start() {
+                    m_polygon_index = m_structure.size();
+                    m_structure.push_back(0);
+                }
+
+                void multipolygon_polygon_finish() {
+                }
+
+                void multipolygon_outer_ring_start() {
+                    ++m_structure[m_polygon_index];
+                    m_ring_index = m_structure.size();
+                    m_structure.push_back(0);
+                }
+
+                void multipolygon_outer_ring_finish() {
+                    ring_finish();
+                }
+
+                void multipolygon_inner_ring_start() {
+                    multipolygon_outer_ring_start();
+                }
+
+                void multipolygon_inner_ring_finish() {
+                    ring_finish();
+                }
+
+                void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
+                    add_point(m_points, xy);
+                    ++m_structure[m_ring_index];
+                }
+
+                multipolygon_type multipolygon_finish() {
+                    std::string& str = m_output.buffer();
+
+                    std::size_t num_polygons = 0;
+                    for (std::size_t i = 0; i < m_structure.size(); i += m_structure[i] + 1) {
+                        ++num_polygons;
+                    }
+                    str_push_varint(str, num_polygons);
+
+                    // The points are in m_points in the right order, the
+                    // counts have to be put in between.
+                    std::size_t ring = 0;
+                    for (std::size_t i = 0; i < m_structure.size(); i += m_structure[i] + 1) {
+                        str_push_varint(str, m_structure[i]);
+                        for (std::size_t r = i + 1; r <= i + m_structure[i]; ++r) {
+                            str_push_varint(str, m_structure[r]);
+                            const std::size_t begin = ring == 0 ? 0 : m_ring_ends[ring - 1];
+                            str.append(m_points, begin, m_ring_ends[ring] - begin);
+                            ++ring;
+                        }
+                    }
+
+                    return m_output.finish();
+                }
+
+            }; // class BasicTWKBFactoryImpl
+
+            using TWKBFactoryImpl = BasicTWKBFactoryImpl<string_output>;
+
+        } // namespace detail
+
+        /**
+         * Factory creating TWKB geometries. The precision (number of
+         * decimal digits kept) can be given as second constructor
+         * argument, for instance:
+         *
+         * @code
+         * osmium::geom::TWKBFactory<osmium::geom::MercatorProjection> factory{2};
+         * @endcode
+         */
+        template <typename TProjection = IdentityProjection>
+        using TWKBFactory = GeometryFactory<osmium::geom::detail::TWKBFactoryImpl, TProjection>;
+
+        /**
+         * TWKB factory appending all geometries to a string given to the
+         * constructor. The create_*() functions return the number of bytes
+         * appended.
+         */
+        template <typename TProjection = IdentityProjection>
+        using TWKBAppendFactory = GeometryFactory<osmium::geom::detail::BasicTWKBFactoryImpl<osmium::geom::detail::append_output>, TProjection>;
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_TWKB_HPP
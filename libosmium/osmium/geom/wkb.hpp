@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <string>
 
 namespace osmium {
@@ -76,7 +77,31 @@ namespace osmium {
                 return out;
             }
 
-            class WKBFactoryImpl {
+            /**
+             * Convert the part of the string starting at offset to hex in
+             * place. Does not need any temporary memory.
+             */
+            inline void convert_to_hex_in_place(std::string& str, const std::size_t offset) {
+                static const char* lookup_hex = "0123456789ABCDEF";
+                const std::size_t size = str.size() - offset;
+                str.resize(offset + size * 2);
+
+                // work backwards so nothing is overwritten before it is converted
+                for (std::size_t i = size; i > 0; --i) {
+                    const auto c = static_cast<unsigned int>(str[offset + i - 1]);
+                    str[offset + 2 * i - 2] = lookup_hex[(c >> 4U) & 0xfU];
+                    str[offset + 2 * i - 1] = lookup_hex[ c        & 0xfU];
+                }
+            }
+
+            /**
+             * Geometry factory implementation creating WKB. The TOutput
+             * policy decides whether each geometry is returned as a new
+             * string (string_output) or appended to a string provided by
+             * the caller (append_output).
+             */
+            template <typename TOutput>
+            class BasicWKBFactoryImpl {
 
                 /**
                 * Type of WKB geometry.
@@ -106,7 +131,7 @@ namespace osmium {
                     NDR = 1          // Little Endian
                 }; // enum class wkb_byte_order_type
 
-                std::string m_data;
+                TOutput m_output;
                 uint32_t m_points = 0;
                 int m_srid;
                 wkb_type m_wkb_type;
@@ -143,76 +168,93 @@ namespace osmium {
                         throw geometry_error{"Too many points in geometry"};
                     }
                     const auto s = static_cast<uint32_t>(size);
-                    std::copy_n(reinterpret_cast<const char*>(&s), sizeof(uint32_t), &m_data[offset]);
+                    std::copy_n(reinterpret_cast<const char*>(&s), sizeof(uint32_t), &m_output.buffer()[offset]);
+                }
+
+                std::string& data() noexcept {
+                    return m_output.buffer();
+                }
+
+                typename TOutput::result_type finish() {
+                    if (m_out_type == out_type::hex) {
+                        convert_to_hex_in_place(m_output.buffer(), m_output.start_offset());
+                    }
+                    return m_output.finish();
                 }
 
             public:
 
-                using point_type        = std::string;
-                using linestring_type   = std::string;
-                using polygon_type      = std::string;
-                using multipolygon_type = std::string;
-                using ring_type         = std::string;
+                using point_type        = typename TOutput::result_type;
+                using linestring_type   = typename TOutput::result_type;
+                using polygon_type      = typename TOutput::result_type;
+                using multipolygon_type = typename TOutput::result_type;
+                using ring_type         = typename TOutput::result_type;
 
-                explicit WKBFactoryImpl(int srid, wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) :
+                explicit BasicWKBFactoryImpl(int srid, wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) :
                     m_srid(srid),
                     m_wkb_type(wtype),
                     m_out_type(otype) {
                 }
 
-                /* Point */
+                /**
+                 * Constructor for the append_output policy. All geometries
+                 * will be appended to the string out.
+                 */
+                explicit BasicWKBFactoryImpl(int srid, std::string& out, wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) :
+                    m_output(out),
+                    m_srid(srid),
+                    m_wkb_type(wtype),
+                    m_out_type(otype) {
+                }
 
-                point_type make_point(const osmium::geom::Coordinates& xy) const {
-                    std::string data;
-                    header(data, wkbPoint, false);
-                    str_push(data, xy.x);
-                    str_push(data, xy.y);
+                /// Discard the geometry started last if it isn't finished.
+                void rollback() noexcept {
+                    m_output.rollback();
+                }
 
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
-                    }
+                /* Point */
 
-                    return data;
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    return m_output.make([&](std::string& str, const std::size_t offset) {
+                        header(str, wkbPoint, false);
+                        str_push(str, xy.x);
+                        str_push(str, xy.y);
+
+                        if (m_out_type == out_type::hex) {
+                            convert_to_hex_in_place(str, offset);
+                        }
+                    });
                 }
 
                 /* LineString */
 
                 void linestring_start() {
-                    m_data.clear();
-                    m_linestring_size_offset = header(m_data, wkbLineString, true);
+                    m_output.start();
+                    m_linestring_size_offset = header(data(), wkbLineString, true);
                 }
 
                 void linestring_add_location(const osmium::geom::Coordinates& xy) {
-                    str_push(m_data, xy.x);
-                    str_push(m_data, xy.y);
+                    str_push(data(), xy.x);
+                    str_push(data(), xy.y);
                 }
 
                 linestring_type linestring_finish(std::size_t num_points) {
                     set_size(m_linestring_size_offset, num_points);
-                    std::string data;
-
-                    using std::swap;
-                    swap(data, m_data);
-
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
-                    }
-
-                    return data;
+                    return finish();
                 }
 
                 /* MultiPolygon */
 
                 void multipolygon_start() {
-                    m_data.clear();
+                    m_output.start();
                     m_polygons = 0;
-                    m_multipolygon_size_offset = header(m_data, wkbMultiPolygon, true);
+                    m_multipolygon_size_offset = header(data(), wkbMultiPolygon, true);
                 }
 
                 void multipolygon_polygon_start() {
                     ++m_polygons;
                     m_rings = 0;
-                    m_polygon_size_offset = header(m_data, wkbPolygon, true);
+                    m_polygon_size_offset = header(data(), wkbPolygon, true);
                 }
 
                 void multipolygon_polygon_finish() {
@@ -222,8 +264,8 @@ namespace osmium {
                 void multipolygon_outer_ring_start() {
                     ++m_rings;
                     m_points = 0;
-                    m_ring_size_offset = m_data.size();
-                    str_push(m_data, static_cast<uint32_t>(0));
+                    m_ring_size_offset = data().size();
+                    str_push(data(), static_cast<uint32_t>(0));
                 }
 
                 void multipolygon_outer_ring_finish() {
@@ -233,8 +275,8 @@ namespace osmium {
                 void multipolygon_inner_ring_start() {
                     ++m_rings;
                     m_points = 0;
-                    m_ring_size_offset = m_data.size();
-                    str_push(m_data, static_cast<uint32_t>(0));
+                    m_ring_size_offset = data().size();
+                    str_push(data(), static_cast<uint32_t>(0));
                 }
 
                 void multipolygon_inner_ring_finish() {
@@ -242,32 +284,33 @@ namespace osmium {
                 }
 
                 void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
-                    str_push(m_data, xy.x);
-                    str_push(m_data, xy.y);
+                    str_push(data(), xy.x);
+                    str_push(data(), xy.y);
                     ++m_points;
                 }
 
                 multipolygon_type multipolygon_finish() {
                     set_size(m_multipolygon_size_offset, m_polygons);
-                    std::string data;
-
-                    using std::swap;
-                    swap(data, m_data);
-
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
-                    }
-
-                    return data;
+                    return finish();
                 }
 
-            }; // class WKBFactoryImpl
+            }; // class BasicWKBFactoryImpl
+
+            using WKBFactoryImpl = BasicWKBFactoryImpl<string_output>;
 
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using WKBFactory = GeometryFactory<osmium::geom::detail::WKBFactoryImpl, TProjection>;
 
+        /**
+         * WKB factory appending all geometries to a string given to the
+         * constructor. The create_*() functions return the number of bytes
+         * appended.
+         */
+        template <typename TProjection = IdentityProjection>
+        using WKBAppendFactory = GeometryFactory<osmium::geom::detail::BasicWKBFactoryImpl<osmium::geom::detail::append_output>, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
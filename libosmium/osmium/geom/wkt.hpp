@@ -52,24 +52,21 @@ namespace osmium {
 
         namespace detail {
 
-            class WKTFactoryImpl {
+            /**
+             * Geometry factory implementation creating WKT. The TOutput
+             * policy decides whether each geometry is returned as a new
+             * string (string_output) or appended to a string provided by
+             * the caller (append_output).
+             */
+            template <typename TOutput>
+            class BasicWKTFactoryImpl {
 
                 std::string m_srid_prefix;
-                std::string m_str;
+                TOutput m_output;
                 int m_precision;
                 wkt_type m_wkt_type;
 
-            public:
-
-                using point_type        = std::string;
-                using linestring_type   = std::string;
-                using polygon_type      = std::string;
-                using multipolygon_type = std::string;
-                using ring_type         = std::string;
-
-                explicit WKTFactoryImpl(int srid, int precision = 7, wkt_type wtype = wkt_type::wkt) :
-                    m_precision(precision),
-                    m_wkt_type(wtype) {
+                void set_srid_prefix(int srid) {
                     if (m_wkt_type == wkt_type::ewkt) {
                         m_srid_prefix = "SRID=";
                         m_srid_prefix += std::to_string(srid);
@@ -77,117 +74,152 @@ namespace osmium {
                     }
                 }
 
+                void start(const char* type) {
+                    m_output.start();
+                    m_output.buffer() += m_srid_prefix;
+                    m_output.buffer() += type;
+                }
+
+            public:
+
+                using point_type        = typename TOutput::result_type;
+                using linestring_type   = typename TOutput::result_type;
+                using polygon_type      = typename TOutput::result_type;
+                using multipolygon_type = typename TOutput::result_type;
+                using ring_type         = typename TOutput::result_type;
+
+                explicit BasicWKTFactoryImpl(int srid, int precision = 7, wkt_type wtype = wkt_type::wkt) :
+                    m_precision(precision),
+                    m_wkt_type(wtype) {
+                    set_srid_prefix(srid);
+                }
+
+                /**
+                 * Constructor for the append_output policy. All geometries
+                 * will be appended to the string out.
+                 */
+                explicit BasicWKTFactoryImpl(int srid, std::string& out, int precision = 7, wkt_type wtype = wkt_type::wkt) :
+                    m_output(out),
+                    m_precision(precision),
+                    m_wkt_type(wtype) {
+                    set_srid_prefix(srid);
+                }
+
+                /// Discard the geometry started last if it isn't finished.
+                void rollback() noexcept {
+                    m_output.rollback();
+                }
+
                 /* Point */
 
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
-                    std::string str{m_srid_prefix};
-                    str += "POINT";
-                    xy.append_to_string(str, '(', ' ', ')', m_precision);
-                    return str;
+                    return m_output.make([&](std::string& str, std::size_t /*offset*/) {
+                        str += m_srid_prefix;
+                        str += "POINT";
+                        xy.append_to_string(str, '(', ' ', ')', m_precision);
+                    });
                 }
 
                 /* LineString */
 
                 void linestring_start() {
-                    m_str = m_srid_prefix;
-                    m_str += "LINESTRING(";
+                    start("LINESTRING(");
                 }
 
                 void linestring_add_location(const osmium::geom::Coordinates& xy) {
-                    xy.append_to_string(m_str, ' ', m_precision);
-                    m_str += ',';
+                    xy.append_to_string(m_output.buffer(), ' ', m_precision);
+                    m_output.buffer() += ',';
                 }
 
                 linestring_type linestring_finish(size_t /* num_points */) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ')';
-                    return str;
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ')';
+                    return m_output.finish();
                 }
 
                 /* Polygon */
                 void polygon_start() {
-                    m_str = m_srid_prefix;
-                    m_str += "POLYGON((";
+                    start("POLYGON((");
                 }
 
                 void polygon_add_location(const osmium::geom::Coordinates& xy) {
-                    xy.append_to_string(m_str, ' ', m_precision);
-                    m_str += ',';
+                    xy.append_to_string(m_output.buffer(), ' ', m_precision);
+                    m_output.buffer() += ',';
                 }
 
                 polygon_type polygon_finish(size_t /* num_points */) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ')';
-                    str += ")";
-                    return str;
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ')';
+                    m_output.buffer() += ")";
+                    return m_output.finish();
                 }
 
                 /* MultiPolygon */
 
                 void multipolygon_start() {
-                    m_str = m_srid_prefix;
-                    m_str += "MULTIPOLYGON(";
+                    start("MULTIPOLYGON(");
                 }
 
                 void multipolygon_polygon_start() {
-                    m_str += '(';
+                    m_output.buffer() += '(';
                 }
 
                 void multipolygon_polygon_finish() {
-                    m_str += "),";
+                    m_output.buffer() += "),";
                 }
 
                 void multipolygon_outer_ring_start() {
-                    m_str += '(';
+                    m_output.buffer() += '(';
                 }
 
                 void multipolygon_outer_ring_finish() {
-                    assert(!m_str.empty());
-                    m_str.back() = ')';
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ')';
                 }
 
                 void multipolygon_inner_ring_start() {
-                    m_str += ",(";
+                    m_output.buffer() += ",(";
                 }
 
                 void multipolygon_inner_ring_finish() {
-                    assert(!m_str.empty());
-                    m_str.back() = ')';
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ')';
                 }
 
                 void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
-                    xy.append_to_string(m_str, ' ', m_precision);
-                    m_str += ',';
+                    xy.append_to_string(m_output.buffer(), ' ', m_precision);
+                    m_output.buffer() += ',';
                 }
 
                 multipolygon_type multipolygon_finish() {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ')';
-                    return str;
+                    assert(!m_output.buffer().empty());
+                    m_output.buffer().back() = ')';
+                    return m_output.finish();
                 }
 
-            }; // class WKTFactoryImpl
+            }; // class BasicWKTFactoryImpl
+
+            using WKTFactoryImpl = BasicWKTFactoryImpl<string_output>;
 
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using WKTFactory = GeometryFactory<osmium::geom::detail::WKTFactoryImpl, TProjection>;
 
+        /**
+         * WKT factory appending all geometries to a string given to the
+         * constructor. The create_*() functions return the number of bytes
+         * appended.
+         *
+         * @code
+         * std::string out;
+         * osmium::geom::WKTAppendFactory<> factory{out};
+         * factory.create_linestring(way); // appends to out
+         * @endcode
+         */
+        template <typename TProjection = IdentityProjection>
+        using WKTAppendFactory = GeometryFactory<osmium::geom::detail::BasicWKTFactoryImpl<osmium::geom::detail::append_output>, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
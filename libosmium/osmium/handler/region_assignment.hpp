@@ -0,0 +1,170 @@
+#ifndef OSMIUM_HANDLER_REGION_ASSIGNMENT_HPP
+#define OSMIUM_HANDLER_REGION_ASSIGNMENT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/extract/region_assigner.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace handler {
+
+        /**
+         * Handler assigning nodes to the regions of a RegionAssigner.
+         * For each node in a region callback(node_id, region_id) is
+         * called.
+         *
+         * The ids and locations of the nodes are collected and assigned
+         * in batches using the thread pool. A batch is processed when it
+         * is full, when the first way, relation or area comes along and
+         * on flush(). The callback is always called in the thread the
+         * handler is called from, in the order of the nodes and region
+         * ids.
+         *
+         * Use make_region_assignment() to create this handler with a
+         * lambda as callback.
+         */
+        template <typename TCallback>
+        class RegionAssignment : public osmium::handler::Handler {
+
+            const osmium::extract::RegionAssigner& m_assigner;
+            TCallback m_callback;
+            std::size_t m_batch_size;
+            osmium::thread::Pool& m_pool;
+
+            std::vector<osmium::object_id_type> m_ids{};
+            std::vector<osmium::Location> m_locations{};
+            std::vector<std::size_t> m_offsets{};
+            std::vector<uint32_t> m_region_ids{};
+
+            void process_batch() {
+                if (m_ids.empty()) {
+                    return;
+                }
+
+                m_assigner.assign(m_locations.data(), m_locations.size(), m_offsets, m_region_ids, m_pool);
+                for (std::size_t i = 0; i < m_ids.size(); ++i) {
+                    for (std::size_t j = m_offsets[i]; j < m_offsets[i + 1]; ++j) {
+                        m_callback(m_ids[i], m_region_ids[j]);
+                    }
+                }
+
+                m_ids.clear();
+                m_locations.clear();
+            }
+
+        public:
+
+            enum {
+                default_batch_size = 64 * 1024
+            };
+
+            /**
+             * Create the handler.
+             *
+             * @param assigner The RegionAssigner. It must be kept alive as
+             *                 long as this handler is used.
+             * @param callback Called with the node id and region id.
+             * @param batch_size Number of nodes assigned in one batch.
+             * @param pool The thread pool to use.
+             */
+            RegionAssignment(const osmium::extract::RegionAssigner& assigner,
+                             TCallback callback,
+                             std::size_t batch_size = default_batch_size,
+                             osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_assigner(assigner),
+                m_callback(std::move(callback)),
+                m_batch_size(batch_size > 0 ? batch_size : 1),
+                m_pool(pool) {
+                m_ids.reserve(m_batch_size);
+                m_locations.reserve(m_batch_size);
+            }
+
+            void node(const osmium::Node& node) {
+                m_ids.push_back(node.id());
+                m_locations.push_back(node.location());
+                if (m_ids.size() >= m_batch_size) {
+                    process_batch();
+                }
+            }
+
+            void way(const osmium::Way& /*way*/) {
+                process_batch();
+            }
+
+            void relation(const osmium::Relation& /*relation*/) {
+                process_batch();
+            }
+
+            void area(const osmium::Area& /*area*/) {
+                process_batch();
+            }
+
+            /// Process the nodes collected so far.
+            void flush() {
+                process_batch();
+            }
+
+        }; // class RegionAssignment
+
+        /**
+         * Create a RegionAssignment handler. See its constructor for the
+         * parameters.
+         */
+        template <typename TCallback, typename THandler = RegionAssignment<typename std::decay<TCallback>::type>>
+        inline THandler make_region_assignment(const osmium::extract::RegionAssigner& assigner,
+                                               TCallback&& callback,
+                                               std::size_t batch_size = THandler::default_batch_size,
+                                               osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+            return THandler{assigner, std::forward<TCallback>(callback), batch_size, pool};
+        }
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_REGION_ASSIGNMENT_HPP
@@ -0,0 +1,678 @@
+#ifndef OSMIUM_INDEX_PACKED_RTREE_HPP
+#define OSMIUM_INDEX_PACKED_RTREE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/util.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            struct packed_rtree_header {
+                char magic[8];
+                uint32_t node_size;
+                uint32_t num_levels;
+                uint64_t num_items;
+                uint64_t num_nodes;
+            }; // struct packed_rtree_header
+
+            struct packed_rtree_box {
+                int32_t min_x;
+                int32_t min_y;
+                int32_t max_x;
+                int32_t max_y;
+
+                bool intersects(const packed_rtree_box& other) const noexcept {
+                    return min_x <= other.max_x && max_x >= other.min_x &&
+                           min_y <= other.max_y && max_y >= other.min_y;
+                }
+
+                void extend(const packed_rtree_box& other) noexcept {
+                    min_x = std::min(min_x, other.min_x);
+                    min_y = std::min(min_y, other.min_y);
+                    max_x = std::max(max_x, other.max_x);
+                    max_y = std::max(max_y, other.max_y);
+                }
+
+            }; // struct packed_rtree_box
+
+            struct packed_rtree_entry {
+                packed_rtree_box box;
+                osmium::object_id_type value;
+                uint32_t hilbert;
+
+                friend bool operator<(const packed_rtree_entry& lhs, const packed_rtree_entry& rhs) noexcept {
+                    return std::tie(lhs.hilbert, lhs.value) < std::tie(rhs.hilbert, rhs.value);
+                }
+
+            }; // struct packed_rtree_entry
+
+            constexpr const char packed_rtree_magic[] = "OSMRTRE1";
+
+            /**
+             * Position of the point (x, y) on the Hilbert curve filling
+             * the 2^16 x 2^16 grid.
+             */
+            inline uint32_t hilbert_index(uint32_t x, uint32_t y) noexcept {
+                constexpr const uint32_t n = 1UL << 16U;
+                uint32_t d = 0;
+                for (uint32_t s = n / 2; s > 0; s /= 2) {
+                    const uint32_t rx = (x & s) ? 1 : 0;
+                    const uint32_t ry = (y & s) ? 1 : 0;
+                    d += s * s * ((3 * rx) ^ ry);
+                    if (ry == 0) {
+                        if (rx == 1) {
+                            x = n - 1 - x;
+                            y = n - 1 - y;
+                        }
+                        std::swap(x, y);
+                    }
+                }
+                return d;
+            }
+
+            // Squared distance between the point (x, y) and the box with the
+            // x axis scaled by x_factor.
+            inline double squared_distance(const packed_rtree_box& box, double x, double y, double x_factor) noexcept {
+                double dx = 0.0;
+                if (x < box.min_x) {
+                    dx = box.min_x - x;
+                } else if (x > box.max_x) {
+                    dx = x - box.max_x;
+                }
+                double dy = 0.0;
+                if (y < box.min_y) {
+                    dy = box.min_y - y;
+                } else if (y > box.max_y) {
+                    dy = y - box.max_y;
+                }
+                dx *= x_factor;
+                return dx * dx + dy * dy;
+            }
+
+        } // namespace detail
+
+        /**
+         * A static spatial index storing bounding boxes of objects
+         * together with a value, usually the id of the object. The boxes
+         * are sorted along a Hilbert curve and packed into a tree where
+         * each node has up to node_size children. After the tree is built
+         * it can not be changed.
+         *
+         * Use the PackedRTreeBuilder to build a tree. The tree can be
+         * written to a file with dump() and memory mapped from that file
+         * with the constructor taking a file descriptor. The file is in
+         * the native byte order of the machine and can not be used on
+         * machines with a different byte order.
+         *
+         * All queries are thread safe.
+         */
+        class PackedRTree {
+
+            // If the data is read from a file, it is kept in this mapping,
+            // otherwise it is kept in m_buffer.
+            std::unique_ptr<osmium::util::MemoryMapping> m_mapping;
+            std::vector<uint64_t> m_buffer;
+
+            const detail::packed_rtree_header* m_header = nullptr;
+            const uint64_t* m_level_starts = nullptr;
+            const detail::packed_rtree_box* m_boxes = nullptr;
+            const osmium::object_id_type* m_values = nullptr;
+
+            static std::size_t data_size(uint64_t num_levels, uint64_t num_nodes, uint64_t num_items) noexcept {
+                return sizeof(detail::packed_rtree_header) +
+                       num_levels * sizeof(uint64_t) +
+                       num_nodes * sizeof(detail::packed_rtree_box) +
+                       num_items * sizeof(osmium::object_id_type);
+            }
+
+            void set_pointers(const char* data) noexcept {
+                m_header = reinterpret_cast<const detail::packed_rtree_header*>(data);
+                data += sizeof(detail::packed_rtree_header);
+                m_level_starts = reinterpret_cast<const uint64_t*>(data);
+                data += m_header->num_levels * sizeof(uint64_t);
+                m_boxes = reinterpret_cast<const detail::packed_rtree_box*>(data);
+                data += m_header->num_nodes * sizeof(detail::packed_rtree_box);
+                m_values = reinterpret_cast<const osmium::object_id_type*>(data);
+            }
+
+            static std::size_t mapping_size(int fd) {
+                const std::size_t size = osmium::file_size(fd);
+                if (size < sizeof(detail::packed_rtree_header)) {
+                    throw std::runtime_error{"Not a packed R-tree index file"};
+                }
+                return size;
+            }
+
+            static void check_header(const detail::packed_rtree_header& header, std::size_t file_size) {
+                if (std::memcmp(header.magic, detail::packed_rtree_magic, sizeof(header.magic)) != 0) {
+                    throw std::runtime_error{"Not a packed R-tree index file"};
+                }
+                if (header.node_size < 2 ||
+                    header.num_levels > 64 ||
+                    header.num_nodes > file_size ||
+                    header.num_items > header.num_nodes ||
+                    data_size(header.num_levels, header.num_nodes, header.num_items) != file_size) {
+                    throw std::runtime_error{"Packed R-tree index file has wrong size"};
+                }
+            }
+
+            std::size_t level_size(std::size_t level) const noexcept {
+                const uint64_t end = level + 1 < m_header->num_levels ? m_level_starts[level + 1] : m_header->num_nodes;
+                return static_cast<std::size_t>(end - m_level_starts[level]);
+            }
+
+            static detail::packed_rtree_box to_box(const osmium::Box& box) noexcept {
+                return detail::packed_rtree_box{box.bottom_left().x(), box.bottom_left().y(),
+                                                box.top_right().x(), box.top_right().y()};
+            }
+
+            // Visit the children of the node with the given index in the
+            // given level. Recursion depth is the number of levels, so
+            // no memory has to be allocated for a stack.
+            template <typename TFunc>
+            void search_node(std::size_t level, std::size_t index, const detail::packed_rtree_box& query, TFunc& func) const {
+                const std::size_t child_level = level - 1;
+                const std::size_t first = index * m_header->node_size;
+                const std::size_t last = std::min(first + m_header->node_size, level_size(child_level));
+                const auto* boxes = m_boxes + m_level_starts[child_level];
+
+                for (std::size_t i = first; i < last; ++i) {
+                    if (boxes[i].intersects(query)) {
+                        if (child_level == 0) {
+                            func(m_values[i]);
+                        } else {
+                            search_node(child_level, i, query, func);
+                        }
+                    }
+                }
+            }
+
+            template <typename TFunc>
+            void search_impl(const detail::packed_rtree_box& query, TFunc&& func) const {
+                if (!empty()) {
+                    search_node(m_header->num_levels - 1, 0, query, func);
+                }
+            }
+
+            friend class PackedRTreeBuilder;
+
+            explicit PackedRTree(std::vector<uint64_t>&& buffer) :
+                m_buffer(std::move(buffer)) {
+                set_pointers(reinterpret_cast<const char*>(m_buffer.data()));
+            }
+
+        public:
+
+            /**
+             * Create an empty tree.
+             */
+            PackedRTree() = default;
+
+            /**
+             * Memory map a tree from a file written with dump(). The file
+             * must stay open while the tree is used.
+             *
+             * @throws std::runtime_error if the file is not a valid tree.
+             * @throws std::system_error if the file could not be mapped.
+             */
+            explicit PackedRTree(int fd) :
+                m_mapping(new osmium::util::MemoryMapping{mapping_size(fd), osmium::util::MemoryMapping::mapping_mode::readonly, fd}) {
+                check_header(*m_mapping->get_addr<const detail::packed_rtree_header>(), m_mapping->size());
+                set_pointers(m_mapping->get_addr<const char>());
+            }
+
+            PackedRTree(const PackedRTree&) = delete;
+            PackedRTree& operator=(const PackedRTree&) = delete;
+
+            PackedRTree(PackedRTree&& other) noexcept :
+                m_mapping(std::move(other.m_mapping)),
+                m_buffer(std::move(other.m_buffer)),
+                m_header(other.m_header),
+                m_level_starts(other.m_level_starts),
+                m_boxes(other.m_boxes),
+                m_values(other.m_values) {
+                other.m_header = nullptr;
+            }
+
+            PackedRTree& operator=(PackedRTree&& other) noexcept {
+                m_mapping = std::move(other.m_mapping);
+                m_buffer = std::move(other.m_buffer);
+                m_header = other.m_header;
+                m_level_starts = other.m_level_starts;
+                m_boxes = other.m_boxes;
+                m_values = other.m_values;
+                other.m_header = nullptr;
+                return *this;
+            }
+
+            ~PackedRTree() noexcept = default;
+
+            /// The number of items in the tree.
+            std::size_t size() const noexcept {
+                return m_header ? static_cast<std::size_t>(m_header->num_items) : 0;
+            }
+
+            /// Is the tree empty?
+            bool empty() const noexcept {
+                return size() == 0;
+            }
+
+            /// The maximum number of children of each node.
+            std::size_t node_size() const noexcept {
+                return m_header ? m_header->node_size : 0;
+            }
+
+            /**
+             * The bounding box of all items. Returns an undefined box if
+             * the tree is empty.
+             */
+            osmium::Box extent() const noexcept {
+                osmium::Box box;
+                if (!empty()) {
+                    const auto& root = m_boxes[m_header->num_nodes - 1];
+                    box.extend(osmium::Location{root.min_x, root.min_y});
+                    box.extend(osmium::Location{root.max_x, root.max_y});
+                }
+                return box;
+            }
+
+            /**
+             * Call func with the value of each item with a bounding box
+             * intersecting the given box. Items are not reported in any
+             * particular order.
+             *
+             * @pre @code box.valid() @endcode
+             */
+            template <typename TFunc>
+            void search(const osmium::Box& box, TFunc&& func) const {
+                search_impl(to_box(box), std::forward<TFunc>(func));
+            }
+
+            /**
+             * Call func with the value of each item with a bounding box
+             * containing the given location. These are the candidates for
+             * a point-in-polygon test.
+             *
+             * @pre @code location.valid() @endcode
+             */
+            template <typename TFunc>
+            void search(const osmium::Location& location, TFunc&& func) const {
+                search_impl(detail::packed_rtree_box{location.x(), location.y(), location.x(), location.y()},
+                            std::forward<TFunc>(func));
+            }
+
+            /**
+             * Return the values of all items with a bounding box
+             * intersecting the given box.
+             *
+             * @pre @code box.valid() @endcode
+             */
+            std::vector<osmium::object_id_type> search(const osmium::Box& box) const {
+                std::vector<osmium::object_id_type> result;
+                search(box, [&result](osmium::object_id_type value) {
+                    result.push_back(value);
+                });
+                return result;
+            }
+
+            /**
+             * Return the values of up to max_results items with the
+             * bounding boxes nearest to the given location, nearest first.
+             * Items whose bounding box contains the location have a
+             * distance of 0. Distances are calculated in the plane with
+             * the longitude scaled by the cosine of the latitude of the
+             * location, which is a good approximation for short distances.
+             *
+             * @pre @code location.valid() @endcode
+             */
+            std::vector<osmium::object_id_type> nearest(const osmium::Location& location, std::size_t max_results = 1) const {
+                std::vector<osmium::object_id_type> result;
+                if (empty() || max_results == 0) {
+                    return result;
+                }
+
+                const double x = location.x();
+                const double y = location.y();
+                const double x_factor = std::cos(osmium::geom::deg_to_rad(location.lat_without_check()));
+
+                struct candidate {
+                    double distance;
+                    std::size_t level;
+                    std::size_t index;
+
+                    bool operator<(const candidate& other) const noexcept {
+                        // reversed for a min-heap
+                        return distance > other.distance;
+                    }
+                };
+
+                std::priority_queue<candidate> queue;
+                queue.push(candidate{0.0, m_header->num_levels, 0});
+
+                while (!queue.empty()) {
+                    const candidate c = queue.top();
+                    queue.pop();
+
+                    if (c.level == 0) {
+                        result.push_back(m_values[c.index]);
+                        if (result.size() == max_results) {
+                            break;
+                        }
+                        continue;
+                    }
+
+                    const std::size_t child_level = c.level - 1;
+                    const std::size_t first = c.level == m_header->num_levels ? 0 : c.index * m_header->node_size;
+                    const std::size_t last = c.level == m_header->num_levels ? 1 : std::min(first + m_header->node_size, level_size(child_level));
+                    const auto* boxes = m_boxes + m_level_starts[child_level];
+
+                    for (std::size_t i = first; i < last; ++i) {
+                        queue.push(candidate{detail::squared_distance(boxes[i], x, y, x_factor), child_level, i});
+                    }
+                }
+
+                return result;
+            }
+
+            /**
+             * Write the tree to a file. It can be memory mapped later
+             * with the constructor taking a file descriptor.
+             */
+            void dump(int fd) const {
+                if (m_header) {
+                    osmium::io::detail::reliable_write(fd,
+                        reinterpret_cast<const char*>(m_header),
+                        data_size(m_header->num_levels, m_header->num_nodes, m_header->num_items));
+                }
+            }
+
+        }; // class PackedRTree
+
+        /**
+         * Collects bounding boxes and values and builds a PackedRTree
+         * from them.
+         *
+         * Usage:
+         * @code
+         * osmium::index::PackedRTreeBuilder builder;
+         * // for all ways:
+         * builder.add(way);
+         * const osmium::index::PackedRTree tree = builder.build();
+         * @endcode
+         */
+        class PackedRTreeBuilder {
+
+            std::vector<detail::packed_rtree_entry> m_entries;
+            std::size_t m_node_size;
+
+            // Chunks smaller than this are not worth handing to the
+            // thread pool.
+            enum {
+                min_chunk_size = 64 * 1024
+            };
+
+            template <typename TFunc>
+            static void run_parallel(std::size_t count, osmium::thread::Pool& pool, TFunc&& func) {
+                std::vector<std::future<void>> futures;
+                futures.reserve(count);
+                try {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        futures.push_back(pool.submit([&func, i]() {
+                            func(i);
+                        }));
+                    }
+                    for (auto& future : futures) {
+                        future.get();
+                    }
+                } catch (...) {
+                    for (auto& future : futures) {
+                        if (future.valid()) {
+                            future.wait();
+                        }
+                    }
+                    throw;
+                }
+            }
+
+            // Calculate the Hilbert indexes of all entries and sort them.
+            void sort_entries(osmium::thread::Pool& pool) {
+                detail::packed_rtree_box extent = m_entries.front().box;
+                for (const auto& entry : m_entries) {
+                    extent.extend(entry.box);
+                }
+
+                const int64_t width = std::max(int64_t(1), int64_t(extent.max_x) - int64_t(extent.min_x));
+                const int64_t height = std::max(int64_t(1), int64_t(extent.max_y) - int64_t(extent.min_y));
+
+                const auto set_hilbert = [&](detail::packed_rtree_entry& entry) {
+                    const int64_t cx = (int64_t(entry.box.min_x) + int64_t(entry.box.max_x)) / 2 - extent.min_x;
+                    const int64_t cy = (int64_t(entry.box.min_y) + int64_t(entry.box.max_y)) / 2 - extent.min_y;
+                    entry.hilbert = detail::hilbert_index(static_cast<uint32_t>(cx * 0xffff / width),
+                                                          static_cast<uint32_t>(cy * 0xffff / height));
+                };
+
+                const std::size_t num_chunks = std::min(static_cast<std::size_t>(pool.num_threads()),
+                                                        m_entries.size() / min_chunk_size);
+
+                if (num_chunks <= 1) {
+                    std::for_each(m_entries.begin(), m_entries.end(), set_hilbert);
+                    std::sort(m_entries.begin(), m_entries.end());
+                    return;
+                }
+
+                std::vector<std::size_t> bounds;
+                for (std::size_t i = 0; i <= num_chunks; ++i) {
+                    bounds.push_back(m_entries.size() * i / num_chunks);
+                }
+
+                run_parallel(num_chunks, pool, [&](std::size_t chunk) {
+                    const auto begin = m_entries.begin() + bounds[chunk];
+                    const auto end = m_entries.begin() + bounds[chunk + 1];
+                    std::for_each(begin, end, set_hilbert);
+                    std::sort(begin, end);
+                });
+
+                // Merge neighbouring sorted chunks until only one is left.
+                for (std::size_t step = 1; step < num_chunks; step *= 2) {
+                    run_parallel((num_chunks + 2 * step - 1) / (2 * step), pool, [&](std::size_t n) {
+                        const std::size_t first = n * 2 * step;
+                        const std::size_t middle = std::min(first + step, num_chunks);
+                        const std::size_t last = std::min(first + 2 * step, num_chunks);
+                        std::inplace_merge(m_entries.begin() + bounds[first],
+                                           m_entries.begin() + bounds[middle],
+                                           m_entries.begin() + bounds[last]);
+                    });
+                }
+            }
+
+        public:
+
+            enum {
+                default_node_size = 16
+            };
+
+            /**
+             * Create a builder.
+             *
+             * @param node_size The maximum number of children of each
+             *                  node in the tree.
+             * @throws std::invalid_argument if node_size is smaller than 2.
+             */
+            explicit PackedRTreeBuilder(std::size_t node_size = default_node_size) :
+                m_node_size(node_size) {
+                if (node_size < 2 || node_size > std::numeric_limits<uint32_t>::max()) {
+                    throw std::invalid_argument{"node size of packed R-tree must be at least 2"};
+                }
+            }
+
+            /// The number of items added so far.
+            std::size_t size() const noexcept {
+                return m_entries.size();
+            }
+
+            /// Reserve space for the given number of items.
+            void reserve(std::size_t size) {
+                m_entries.reserve(size);
+            }
+
+            /**
+             * Add an item with the given bounding box and value. Invalid
+             * boxes are ignored.
+             *
+             * @returns Whether the item was added.
+             */
+            bool add(const osmium::Box& box, osmium::object_id_type value) {
+                if (!box.valid()) {
+                    return false;
+                }
+                m_entries.push_back(detail::packed_rtree_entry{PackedRTree::to_box(box), value, 0});
+                return true;
+            }
+
+            /**
+             * Add the envelope of a way with its id as value. The node
+             * locations must be set on the way. Ways without any valid
+             * location are ignored.
+             *
+             * @returns Whether the way was added.
+             */
+            bool add(const osmium::Way& way) {
+                return add(way.envelope(), way.id());
+            }
+
+            /**
+             * Add the envelope of an area with its id as value. Areas
+             * without any valid location are ignored.
+             *
+             * @returns Whether the area was added.
+             */
+            bool add(const osmium::Area& area) {
+                return add(area.envelope(), area.id());
+            }
+
+            /**
+             * Build the tree from all items added. The Hilbert indexes
+             * are calculated and the items sorted in parallel using the
+             * thread pool. The builder is empty afterwards.
+             */
+            PackedRTree build(osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+                const uint64_t num_items = m_entries.size();
+
+                std::vector<uint64_t> level_starts;
+                uint64_t num_nodes = 0;
+                if (num_items > 0) {
+                    uint64_t level_size = num_items;
+                    do {
+                        level_starts.push_back(num_nodes);
+                        num_nodes += level_size;
+                        level_size = (level_size + m_node_size - 1) / m_node_size;
+                    } while (level_starts.size() < 2 || level_starts.back() + 1 != num_nodes);
+                    sort_entries(pool);
+                }
+
+                const std::size_t size = PackedRTree::data_size(level_starts.size(), num_nodes, num_items);
+                std::vector<uint64_t> buffer((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+                char* data = reinterpret_cast<char*>(buffer.data());
+
+                auto* header = reinterpret_cast<detail::packed_rtree_header*>(data);
+                std::memcpy(header->magic, detail::packed_rtree_magic, sizeof(header->magic));
+                header->node_size = static_cast<uint32_t>(m_node_size);
+                header->num_levels = static_cast<uint32_t>(level_starts.size());
+                header->num_items = num_items;
+                header->num_nodes = num_nodes;
+                data += sizeof(detail::packed_rtree_header);
+
+                std::copy(level_starts.begin(), level_starts.end(), reinterpret_cast<uint64_t*>(data));
+                data += level_starts.size() * sizeof(uint64_t);
+
+                auto* boxes = reinterpret_cast<detail::packed_rtree_box*>(data);
+                auto* values = reinterpret_cast<osmium::object_id_type*>(data + num_nodes * sizeof(detail::packed_rtree_box));
+                for (std::size_t i = 0; i < num_items; ++i) {
+                    boxes[i] = m_entries[i].box;
+                    values[i] = m_entries[i].value;
+                }
+
+                for (std::size_t level = 1; level < level_starts.size(); ++level) {
+                    const auto* children = boxes + level_starts[level - 1];
+                    const std::size_t num_children = level_starts[level] - level_starts[level - 1];
+                    auto* nodes = boxes + level_starts[level];
+                    for (std::size_t i = 0; i < num_children; ++i) {
+                        if (i % m_node_size == 0) {
+                            nodes[i / m_node_size] = children[i];
+                        } else {
+                            nodes[i / m_node_size].extend(children[i]);
+                        }
+                    }
+                }
+
+                m_entries.clear();
+                m_entries.shrink_to_fit();
+
+                return PackedRTree{std::move(buffer)};
+            }
+
+        }; // class PackedRTreeBuilder
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_PACKED_RTREE_HPP
@@ -0,0 +1,248 @@
+#ifndef OSMIUM_IO_CHANGESET_FILTER_HPP
+#define OSMIUM_IO_CHANGESET_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/changeset.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * A filter for changesets that can be handed to the Reader as an
+         * additional option. Input formats supporting it (currently only
+         * XML) evaluate it on the attributes of each changeset and never
+         * build the changesets that don't match. They also don't build the
+         * discussions or comment texts if you tell the filter you don't
+         * need them. This makes reading large changeset dumps much faster
+         * if you only need a few of the changesets or only some of their
+         * data.
+         *
+         * All other input formats ignore this filter, so if you might read
+         * those, check the changesets you get with matches() again.
+         *
+         * A changeset is kept if
+         * * the time between its creation and closing overlaps the time
+         *   range (open changesets are treated as never closed),
+         * * no bounding box is set or its bounds intersect the bounding
+         *   box (empty changesets without bounds never match),
+         * * no uids were added or its uid is one of them, and
+         * * it has at least min_comments() comments.
+         *
+         * @code
+         * osmium::io::ChangesetFilter filter;
+         * filter.set_min_comments(1).set_read_comment_text(false);
+         * osmium::io::Reader reader{"changesets.osm.bz2", osmium::osm_entity_bits::changeset, filter};
+         * @endcode
+         */
+        class ChangesetFilter {
+
+            std::vector<osmium::user_id_type> m_uids;
+            osmium::Box m_bbox{};
+            osmium::Timestamp m_from = osmium::start_of_time();
+            osmium::Timestamp m_to = osmium::end_of_time();
+            osmium::num_comments_type m_min_comments = 0;
+            bool m_read_discussions = true;
+            bool m_read_comment_text = true;
+
+            static bool intersects(const osmium::Box& a, const osmium::Box& b) noexcept {
+                return a.bottom_left().x() <= b.top_right().x() &&
+                       a.top_right().x() >= b.bottom_left().x() &&
+                       a.bottom_left().y() <= b.top_right().y() &&
+                       a.top_right().y() >= b.bottom_left().y();
+            }
+
+        public:
+
+            /**
+             * Create a filter that accepts all changesets with all their
+             * data.
+             */
+            ChangesetFilter() = default;
+
+            /**
+             * Only keep changesets that were open at some point in the
+             * time range [from, to].
+             *
+             * @returns A reference to this filter for chaining.
+             * @throws std::invalid_argument If from is after to.
+             */
+            ChangesetFilter& set_time_range(const osmium::Timestamp& from, const osmium::Timestamp& to) {
+                if (from > to) {
+                    throw std::invalid_argument{"start of time range must not be after its end"};
+                }
+                m_from = from;
+                m_to = to;
+                return *this;
+            }
+
+            /**
+             * Only keep changesets whose bounds intersect this bounding
+             * box. An invalid (default constructed) box disables this
+             * check.
+             */
+            ChangesetFilter& set_bbox(const osmium::Box& bbox) noexcept {
+                m_bbox = bbox;
+                return *this;
+            }
+
+            /**
+             * Only keep changesets created by this user. Can be called
+             * several times to keep changesets of several users.
+             */
+            ChangesetFilter& add_uid(const osmium::user_id_type uid) {
+                const auto it = std::lower_bound(m_uids.begin(), m_uids.end(), uid);
+                if (it == m_uids.end() || *it != uid) {
+                    m_uids.insert(it, uid);
+                }
+                return *this;
+            }
+
+            /**
+             * Only keep changesets with at least this many comments. Set
+             * to 1 to only get changesets with discussions. This uses the
+             * comments_count attribute, so it works even if the
+             * discussions are not read.
+             */
+            ChangesetFilter& set_min_comments(const osmium::num_comments_type min_comments) noexcept {
+                m_min_comments = min_comments;
+                return *this;
+            }
+
+            /**
+             * Read the discussions of the changesets (default) or skip
+             * them. The number of comments is still available if the
+             * discussions are skipped.
+             */
+            ChangesetFilter& set_read_discussions(const bool read_discussions) noexcept {
+                m_read_discussions = read_discussions;
+                return *this;
+            }
+
+            /**
+             * Read the texts of the discussion comments (default) or skip
+             * them. If they are skipped, all comments have an empty text,
+             * but their date and user are still available.
+             */
+            ChangesetFilter& set_read_comment_text(const bool read_comment_text) noexcept {
+                m_read_comment_text = read_comment_text;
+                return *this;
+            }
+
+            const osmium::Timestamp& from() const noexcept {
+                return m_from;
+            }
+
+            const osmium::Timestamp& to() const noexcept {
+                return m_to;
+            }
+
+            const osmium::Box& bbox() const noexcept {
+                return m_bbox;
+            }
+
+            const std::vector<osmium::user_id_type>& uids() const noexcept {
+                return m_uids;
+            }
+
+            osmium::num_comments_type min_comments() const noexcept {
+                return m_min_comments;
+            }
+
+            bool read_discussions() const noexcept {
+                return m_read_discussions;
+            }
+
+            bool read_comment_text() const noexcept {
+                return m_read_comment_text;
+            }
+
+            /**
+             * Check a changeset given by its attributes against this
+             * filter. Used by the input formats before the changeset is
+             * built.
+             *
+             * @param created_at Creation time of the changeset.
+             * @param closed_at Closing time of the changeset, invalid for
+             *                  open changesets.
+             * @param uid User id of the changeset.
+             * @param bounds Bounds of the changeset.
+             * @param num_comments Number of comments of the changeset.
+             */
+            bool matches(const osmium::Timestamp& created_at,
+                         const osmium::Timestamp& closed_at,
+                         const osmium::user_id_type uid,
+                         const osmium::Box& bounds,
+                         const osmium::num_comments_type num_comments) const noexcept {
+                if (num_comments < m_min_comments) {
+                    return false;
+                }
+
+                if (created_at > m_to || (closed_at.valid() && closed_at < m_from)) {
+                    return false;
+                }
+
+                if (m_bbox.valid() && !(bounds.valid() && intersects(bounds, m_bbox))) {
+                    return false;
+                }
+
+                return m_uids.empty() || std::binary_search(m_uids.begin(), m_uids.end(), uid);
+            }
+
+            /**
+             * Check a changeset against this filter.
+             */
+            bool matches(const osmium::Changeset& changeset) const noexcept {
+                return matches(changeset.created_at(),
+                               changeset.closed_at(),
+                               changeset.uid(),
+                               changeset.bounds(),
+                               changeset.num_comments());
+            }
+
+        }; // class ChangesetFilter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_CHANGESET_FILTER_HPP
@@ -0,0 +1,244 @@
+#ifndef OSMIUM_IO_DATA_RANGES_HPP
+#define OSMIUM_IO_DATA_RANGES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * The ranges of the ids (for each object type) and of the
+         * timestamps of the objects in a file. They can be stored in the
+         * file header, so tools can find out cheaply whether files
+         * overlap without decoding them.
+         *
+         * Ids are compared as signed values, so negative ids extend the
+         * range downwards. Objects without (valid) timestamp don't extend
+         * the timestamp range.
+         *
+         * The ranges are written into the header by the PBF writer and
+         * read back by the PBF reader. Because the header is written
+         * before any data, the writer can not compute them, they have to
+         * be set on the header with Header::data_ranges() before the
+         * Writer is created. Ranges read from a file are never written
+         * out again. Tools that have all data before writing (like the
+         * osmium::io::ExternalSorter) set them automatically.
+         */
+        class DataRanges {
+
+            struct id_range {
+                osmium::object_id_type min = std::numeric_limits<osmium::object_id_type>::max();
+                osmium::object_id_type max = std::numeric_limits<osmium::object_id_type>::min();
+            };
+
+            std::array<id_range, 3> m_ids{};
+            osmium::Timestamp m_min_timestamp = osmium::end_of_time();
+            osmium::Timestamp m_max_timestamp = osmium::start_of_time();
+
+            static std::size_t index(const osmium::item_type type) noexcept {
+                assert(type == osmium::item_type::node || type == osmium::item_type::way || type == osmium::item_type::relation);
+                return static_cast<std::size_t>(type) - 1;
+            }
+
+        public:
+
+            /**
+             * Create empty ranges.
+             */
+            DataRanges() = default;
+
+            /**
+             * Extend the id range for the type so that it contains the
+             * range [min, max].
+             *
+             * @pre type must be node, way, or relation.
+             * @pre min <= max
+             */
+            DataRanges& add_ids(const osmium::item_type type, const osmium::object_id_type min, const osmium::object_id_type max) noexcept {
+                assert(min <= max);
+                auto& range = m_ids[index(type)];
+                range.min = std::min(range.min, min);
+                range.max = std::max(range.max, max);
+                return *this;
+            }
+
+            /**
+             * Extend the timestamp range so that it contains the range
+             * [min, max].
+             *
+             * @pre min <= max
+             */
+            DataRanges& add_timestamps(const osmium::Timestamp& min, const osmium::Timestamp& max) noexcept {
+                assert(min <= max);
+                m_min_timestamp = std::min(m_min_timestamp, min);
+                m_max_timestamp = std::max(m_max_timestamp, max);
+                return *this;
+            }
+
+            /**
+             * Extend the ranges so that they contain the id and timestamp
+             * of the object.
+             */
+            DataRanges& add(const osmium::OSMObject& object) noexcept {
+                add_ids(object.type(), object.id(), object.id());
+                if (object.timestamp().valid()) {
+                    add_timestamps(object.timestamp(), object.timestamp());
+                }
+                return *this;
+            }
+
+            /**
+             * Extend the ranges so that they contain the ids and
+             * timestamps of all objects in the buffer.
+             */
+            DataRanges& add(const osmium::memory::Buffer& buffer) noexcept {
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    add(object);
+                }
+                return *this;
+            }
+
+            /**
+             * Are all ranges empty?
+             */
+            bool empty() const noexcept {
+                return !has_ids(osmium::item_type::node) &&
+                       !has_ids(osmium::item_type::way) &&
+                       !has_ids(osmium::item_type::relation) &&
+                       !has_timestamps();
+            }
+
+            /**
+             * Is there an id range for this type?
+             *
+             * @pre type must be node, way, or relation.
+             */
+            bool has_ids(const osmium::item_type type) const noexcept {
+                const auto& range = m_ids[index(type)];
+                return range.min <= range.max;
+            }
+
+            /**
+             * The smallest id of this type.
+             *
+             * @pre has_ids(type)
+             */
+            osmium::object_id_type min_id(const osmium::item_type type) const noexcept {
+                return m_ids[index(type)].min;
+            }
+
+            /**
+             * The largest id of this type.
+             *
+             * @pre has_ids(type)
+             */
+            osmium::object_id_type max_id(const osmium::item_type type) const noexcept {
+                return m_ids[index(type)].max;
+            }
+
+            /**
+             * Is there a timestamp range?
+             */
+            bool has_timestamps() const noexcept {
+                return m_min_timestamp <= m_max_timestamp;
+            }
+
+            /**
+             * The smallest timestamp.
+             *
+             * @pre has_timestamps()
+             */
+            osmium::Timestamp min_timestamp() const noexcept {
+                return m_min_timestamp;
+            }
+
+            /**
+             * The largest timestamp.
+             *
+             * @pre has_timestamps()
+             */
+            osmium::Timestamp max_timestamp() const noexcept {
+                return m_max_timestamp;
+            }
+
+            /**
+             * Is the id in the id range of its type?
+             *
+             * @pre type must be node, way, or relation.
+             */
+            bool contains_id(const osmium::item_type type, const osmium::object_id_type id) const noexcept {
+                const auto& range = m_ids[index(type)];
+                return range.min <= id && id <= range.max;
+            }
+
+            /**
+             * Do the id ranges of any type overlap? If this returns false,
+             * files with these ranges can not contain the same objects.
+             */
+            bool ids_overlap(const DataRanges& other) const noexcept {
+                for (std::size_t i = 0; i < m_ids.size(); ++i) {
+                    if (m_ids[i].min <= other.m_ids[i].max && other.m_ids[i].min <= m_ids[i].max) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * Do the timestamp ranges overlap?
+             */
+            bool timestamps_overlap(const DataRanges& other) const noexcept {
+                return m_min_timestamp <= other.m_max_timestamp && other.m_min_timestamp <= m_max_timestamp;
+            }
+
+        }; // class DataRanges
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DATA_RANGES_HPP
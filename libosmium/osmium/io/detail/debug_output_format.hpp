@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/data_ranges.hpp>
 #include <osmium/io/detail/output_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/detail/string_util.hpp>
@@ -568,6 +569,29 @@ namespace osmium {
                         box.top_right().as_string(std::back_inserter(out));
                         out += '\n';
                     }
+                    const auto& ranges = header.data_ranges();
+                    if (!ranges.empty()) {
+                        write_fieldname(out, "data ranges");
+                        out += '\n';
+                        for (const auto type : {osmium::item_type::node, osmium::item_type::way, osmium::item_type::relation}) {
+                            if (ranges.has_ids(type)) {
+                                out += "    ";
+                                out += osmium::item_type_to_name(type);
+                                out += " ids: ";
+                                out += std::to_string(ranges.min_id(type));
+                                out += " - ";
+                                out += std::to_string(ranges.max_id(type));
+                                out += '\n';
+                            }
+                        }
+                        if (ranges.has_timestamps()) {
+                            out += "    timestamps: ";
+                            out += ranges.min_timestamp().to_iso();
+                            out += " - ";
+                            out += ranges.max_timestamp().to_iso();
+                            out += '\n';
+                        }
+                    }
                     write_fieldname(out, "options");
                     out += '\n';
                     for (const auto& opt : header) {
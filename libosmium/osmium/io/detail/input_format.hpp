@@ -33,11 +33,13 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/changeset_filter.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/pushdown_filter.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
@@ -63,6 +65,9 @@ namespace osmium {
                 std::promise<osmium::io::Header>& header_promise;
                 osmium::osm_entity_bits::type read_which_entities;
                 osmium::io::read_meta read_metadata;
+                const osmium::io::PushdownFilter* filter;
+                const osmium::io::ChangesetFilter* changeset_filter;
+                osmium::io::add_key_signatures key_signatures;
             };
 
             class Parser {
@@ -73,6 +78,9 @@ namespace osmium {
                 queue_wrapper<std::string> m_input_queue;
                 osmium::osm_entity_bits::type m_read_which_entities;
                 osmium::io::read_meta m_read_metadata;
+                const osmium::io::PushdownFilter* m_filter;
+                const osmium::io::ChangesetFilter* m_changeset_filter;
+                osmium::io::add_key_signatures m_key_signatures;
                 bool m_header_is_done;
 
             protected:
@@ -89,6 +97,26 @@ namespace osmium {
                     return m_read_metadata;
                 }
 
+                /**
+                 * The filter pushed down from the Reader or nullptr if
+                 * there is none.
+                 */
+                const osmium::io::PushdownFilter* pushdown_filter() const noexcept {
+                    return m_filter;
+                }
+
+                /**
+                 * The changeset filter from the Reader or nullptr if there
+                 * is none.
+                 */
+                const osmium::io::ChangesetFilter* changeset_filter() const noexcept {
+                    return m_changeset_filter;
+                }
+
+                osmium::io::add_key_signatures key_signatures() const noexcept {
+                    return m_key_signatures;
+                }
+
                 bool header_is_done() const noexcept {
                     return m_header_is_done;
                 }
@@ -127,6 +155,9 @@ namespace osmium {
                     m_input_queue(args.input_queue),
                     m_read_which_entities(args.read_which_entities),
                     m_read_metadata(args.read_metadata),
+                    m_filter(args.filter),
+                    m_changeset_filter(args.changeset_filter),
+                    m_key_signatures(args.key_signatures),
                     m_header_is_done(false) {
                 }
 
@@ -34,15 +34,18 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/data_ranges.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
 #include <osmium/io/detail/protobuf_tags.hpp>
 #include <osmium/io/detail/zlib.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/pushdown_filter.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/osm/item_type.hpp>
+#include <osmium/osm/key_signature.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node.hpp>
 #include <osmium/osm/object.hpp>
@@ -56,6 +59,7 @@ DEALINGS IN THE SOFTWARE.
 #include <protozero/pbf_message.hpp>
 #include <protozero/types.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <limits>
@@ -98,6 +102,27 @@ namespace osmium {
 
                 osmium::io::read_meta m_read_metadata;
 
+                // Filter pushed down from the Reader (or nullptr). The tag
+                // rules are evaluated lazily once per string table entry,
+                // the results are cached in the masks.
+                const osmium::io::PushdownFilter* m_filter;
+                std::vector<uint64_t> m_key_masks{};
+                std::vector<uint64_t> m_value_masks{};
+                std::vector<unsigned char> m_classified{};
+                std::string m_scratch{};
+
+                enum : unsigned char {
+                    key_classified   = 0x01U,
+                    value_classified = 0x02U
+                };
+
+                // Add a KeySignature to each object? The key bits are
+                // calculated lazily once per string table entry, zero
+                // means not calculated yet (every key sets at least one
+                // bit).
+                osmium::io::add_key_signatures m_key_signatures;
+                std::vector<uint64_t> m_key_bits{};
+
                 void decode_stringtable(const data_view& data) {
                     if (!m_stringtable.empty()) {
                         throw osmium::pbf_error{"more than one stringtable in pbf file"};
@@ -136,6 +161,40 @@ namespace osmium {
                                 pbf_primitive_block.skip();
                         }
                     }
+
+                    if (m_filter) {
+                        m_key_masks.resize(m_stringtable.size());
+                        m_value_masks.resize(m_stringtable.size());
+                        m_classified.resize(m_stringtable.size());
+                    }
+
+                    if (m_key_signatures == osmium::io::add_key_signatures::yes) {
+                        m_key_bits.resize(m_stringtable.size());
+                    }
+                }
+
+                uint64_t key_mask(const uint32_t index) {
+                    const auto& str = m_stringtable.at(index);
+                    if (!(m_classified[index] & key_classified)) {
+                        m_scratch.assign(str.first, str.second);
+                        m_key_masks[index] = m_filter->key_mask(m_scratch.c_str());
+                        m_classified[index] |= key_classified;
+                    }
+                    return m_key_masks[index];
+                }
+
+                uint64_t value_mask(const uint32_t index) {
+                    const auto& str = m_stringtable.at(index);
+                    if (!(m_classified[index] & value_classified)) {
+                        m_scratch.assign(str.first, str.second);
+                        m_value_masks[index] = m_filter->value_mask(m_scratch.c_str());
+                        m_classified[index] |= value_classified;
+                    }
+                    return m_value_masks[index];
+                }
+
+                bool tag_matches(const uint32_t key, const uint32_t value) {
+                    return m_filter->result(key_mask(key) & value_mask(value));
                 }
 
                 void decode_primitive_block_data() {
@@ -243,6 +302,121 @@ namespace osmium {
 
                 using kv_type = protozero::iterator_range<protozero::pbf_reader::const_uint32_iterator>;
 
+                bool tags_match(const kv_type& keys, const kv_type& vals) {
+                    auto vit = vals.begin();
+                    for (const auto key : keys) {
+                        if (vit == vals.end()) {
+                            // this is against the spec, must have same number of elements
+                            throw osmium::pbf_error{"PBF format error"};
+                        }
+                        if (tag_matches(key, *vit++)) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                // Check whether a way or relation matches the filter
+                // before building it. Only looks at the tags.
+                template <typename TMessage>
+                bool object_matches(const data_view& data, const osmium::osm_entity_bits::type type) {
+                    if (!m_filter->filters_tags(type)) {
+                        return true;
+                    }
+
+                    kv_type keys;
+                    kv_type vals;
+
+                    protozero::pbf_message<TMessage> pbf_object{data};
+                    while (pbf_object.next()) {
+                        switch (pbf_object.tag_and_type()) {
+                            case protozero::tag_and_type(TMessage::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
+                                keys = pbf_object.get_packed_uint32();
+                                break;
+                            case protozero::tag_and_type(TMessage::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
+                                vals = pbf_object.get_packed_uint32();
+                                break;
+                            default:
+                                pbf_object.skip();
+                        }
+                    }
+
+                    return tags_match(keys, vals);
+                }
+
+                // Check whether a (non-dense) node matches the filter
+                // before building it.
+                bool node_matches(const data_view& data) {
+                    kv_type keys;
+                    kv_type vals;
+                    int64_t lon = std::numeric_limits<int64_t>::max();
+                    int64_t lat = std::numeric_limits<int64_t>::max();
+
+                    protozero::pbf_message<OSMFormat::Node> pbf_node{data};
+                    while (pbf_node.next()) {
+                        switch (pbf_node.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::Node::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
+                                keys = pbf_node.get_packed_uint32();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
+                                vals = pbf_node.get_packed_uint32();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_lat, protozero::pbf_wire_type::varint):
+                                lat = pbf_node.get_sint64();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_lon, protozero::pbf_wire_type::varint):
+                                lon = pbf_node.get_sint64();
+                                break;
+                            default:
+                                pbf_node.skip();
+                        }
+                    }
+
+                    if (m_filter->bbox()) {
+                        if (lon == std::numeric_limits<int64_t>::max() ||
+                            lat == std::numeric_limits<int64_t>::max() ||
+                            !m_filter->location_matches(osmium::Location{convert_pbf_lon(lon), convert_pbf_lat(lat)})) {
+                            return false;
+                        }
+                    }
+
+                    return !m_filter->filters_tags(osmium::osm_entity_bits::node) || tags_match(keys, vals);
+                }
+
+                uint64_t key_bits(const uint32_t index) {
+                    const auto& str = m_stringtable.at(index);
+                    uint64_t& bits = m_key_bits[index];
+                    if (bits == 0) {
+                        bits = osmium::KeySignature::key_bits(str.first, str.second);
+                    }
+                    return bits;
+                }
+
+                void add_key_signature(osmium::builder::Builder& builder, const kv_type& keys) {
+                    if (m_key_signatures == osmium::io::add_key_signatures::yes) {
+                        uint64_t bits = 0;
+                        for (const auto key : keys) {
+                            bits |= key_bits(key);
+                        }
+                        builder.add_item(osmium::KeySignature{bits});
+                    }
+                }
+
+                // The tag iterator is taken by value, so it is not advanced.
+                void add_dense_node_key_signature(osmium::builder::Builder& builder, protozero::pbf_reader::const_int32_iterator it, const protozero::pbf_reader::const_int32_iterator last) {
+                    if (m_key_signatures == osmium::io::add_key_signatures::yes) {
+                        uint64_t bits = 0;
+                        while (it != last && *it != 0) {
+                            bits |= key_bits(*it++);
+                            if (it == last) {
+                                break;
+                            }
+                            ++it;
+                        }
+                        builder.add_item(osmium::KeySignature{bits});
+                    }
+                }
+
                 void build_tag_list(osmium::builder::Builder& parent, const kv_type& keys, const kv_type& vals) {
                     if (!keys.empty()) {
                         osmium::builder::TagListBuilder builder{parent};
@@ -269,6 +443,10 @@ namespace osmium {
                 }
 
                 void decode_node(const data_view& data) {
+                    if (m_filter && !node_matches(data)) {
+                        return;
+                    }
+
                     osmium::builder::NodeBuilder builder{m_buffer};
                     osmium::Node& node = builder.object();
 
@@ -321,11 +499,16 @@ namespace osmium {
                     }
 
                     builder.set_user(user.first, user.second);
+                    add_key_signature(builder, keys);
 
                     build_tag_list(builder, keys, vals);
                 }
 
                 void decode_way(const data_view& data) {
+                    if (m_filter && !object_matches<OSMFormat::Way>(data, osmium::osm_entity_bits::way)) {
+                        return;
+                    }
+
                     osmium::builder::WayBuilder builder{m_buffer};
 
                     kv_type keys;
@@ -370,6 +553,7 @@ namespace osmium {
                     }
 
                     builder.set_user(user.first, user.second);
+                    add_key_signature(builder, keys);
 
                     if (!refs.empty()) {
                         osmium::builder::WayNodeListBuilder wnl_builder{builder};
@@ -398,6 +582,10 @@ namespace osmium {
                 }
 
                 void decode_relation(const data_view& data) {
+                    if (m_filter && !object_matches<OSMFormat::Relation>(data, osmium::osm_entity_bits::relation)) {
+                        return;
+                    }
+
                     osmium::builder::RelationBuilder builder{m_buffer};
 
                     kv_type keys;
@@ -442,6 +630,7 @@ namespace osmium {
                     }
 
                     builder.set_user(user.first, user.second);
+                    add_key_signature(builder, keys);
 
                     if (!refs.empty()) {
                         osmium::builder::RelationMemberListBuilder rml_builder{builder};
@@ -483,6 +672,40 @@ namespace osmium {
                     }
                 }
 
+                // Check whether the next dense node matches the filter. The
+                // tag iterator is taken by value, so it is not advanced.
+                bool dense_node_matches(protozero::pbf_reader::const_int32_iterator it, const protozero::pbf_reader::const_int32_iterator last, const osmium::Location& location) {
+                    if (!m_filter->location_matches(location)) {
+                        return false;
+                    }
+
+                    if (!m_filter->filters_tags(osmium::osm_entity_bits::node)) {
+                        return true;
+                    }
+
+                    while (it != last && *it != 0) {
+                        const auto key = static_cast<uint32_t>(*it++);
+                        if (it == last) {
+                            throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
+                        }
+                        if (tag_matches(key, static_cast<uint32_t>(*it++))) {
+                            return true;
+                        }
+                    }
+
+                    return false;
+                }
+
+                static void skip_dense_node_tags(protozero::pbf_reader::const_int32_iterator& it, const protozero::pbf_reader::const_int32_iterator last) {
+                    while (it != last && *it != 0) {
+                        ++it;
+                    }
+
+                    if (it != last) {
+                        ++it;
+                    }
+                }
+
                 void decode_dense_nodes_without_metadata(const data_view& data) {
                     protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> ids;
                     protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> lats;
@@ -523,21 +746,32 @@ namespace osmium {
                             throw osmium::pbf_error{"PBF format error"};
                         }
 
+                        const auto id = dense_id.update(ids.front());
+                        ids.drop_front();
+
+                        const auto lon = dense_longitude.update(lons.front());
+                        lons.drop_front();
+                        const auto lat = dense_latitude.update(lats.front());
+                        lats.drop_front();
+
+                        const osmium::Location location{
+                            convert_pbf_lon(lon),
+                            convert_pbf_lat(lat)
+                        };
+
+                        if (m_filter && !dense_node_matches(tag_it, tags.end(), location)) {
+                            skip_dense_node_tags(tag_it, tags.end());
+                            continue;
+                        }
+
                         {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.front()));
-                            ids.drop_front();
+                            node.set_id(id);
+                            node.set_location(location);
 
-                            const auto lon = dense_longitude.update(lons.front());
-                            lons.drop_front();
-                            const auto lat = dense_latitude.update(lats.front());
-                            lats.drop_front();
-                            builder.object().set_location(osmium::Location{
-                                    convert_pbf_lon(lon),
-                                    convert_pbf_lat(lat)
-                            });
+                            add_dense_node_key_signature(builder, tag_it, tags.end());
 
                             if (tag_it != tags.end()) {
                                 build_tag_list_from_dense_nodes(builder, tag_it, tags.end());
@@ -631,14 +865,58 @@ namespace osmium {
                             throw osmium::pbf_error{"PBF format error"};
                         }
 
+                        const auto id = dense_id.update(ids.front());
+                        ids.drop_front();
+
+                        // even if the node isn't visible, there's still a record
+                        // of its lat/lon in the dense arrays.
+                        const auto lon = dense_longitude.update(lons.front());
+                        lons.drop_front();
+                        const auto lat = dense_latitude.update(lats.front());
+                        lats.drop_front();
+
+                        const osmium::Location location{
+                            convert_pbf_lon(lon),
+                            convert_pbf_lat(lat)
+                        };
+
+                        if (m_filter && !dense_node_matches(tag_it, tags.end(), location)) {
+                            skip_dense_node_tags(tag_it, tags.end());
+                            if (has_info) {
+                                // keep the delta decoders in sync
+                                if (!versions.empty()) {
+                                    versions.drop_front();
+                                }
+                                if (!changesets.empty()) {
+                                    dense_changeset.update(changesets.front());
+                                    changesets.drop_front();
+                                }
+                                if (!timestamps.empty()) {
+                                    dense_timestamp.update(timestamps.front());
+                                    timestamps.drop_front();
+                                }
+                                if (!uids.empty()) {
+                                    dense_uid.update(uids.front());
+                                    uids.drop_front();
+                                }
+                                if (!visibles.empty()) {
+                                    visibles.drop_front();
+                                }
+                                if (!user_sids.empty()) {
+                                    dense_user_sid.update(user_sids.front());
+                                    user_sids.drop_front();
+                                }
+                            }
+                            continue;
+                        }
+
                         bool visible = true;
 
                         {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.front()));
-                            ids.drop_front();
+                            node.set_id(id);
 
                             if (has_info) {
                                 if (!versions.empty()) {
@@ -692,19 +970,12 @@ namespace osmium {
                                 }
                             }
 
-                            // even if the node isn't visible, there's still a record
-                            // of its lat/lon in the dense arrays.
-                            const auto lon = dense_longitude.update(lons.front());
-                            lons.drop_front();
-                            const auto lat = dense_latitude.update(lats.front());
-                            lats.drop_front();
                             if (visible) {
-                                builder.object().set_location(osmium::Location{
-                                        convert_pbf_lon(lon),
-                                        convert_pbf_lat(lat)
-                                });
+                                node.set_location(location);
                             }
 
+                            add_dense_node_key_signature(builder, tag_it, tags.end());
+
                             if (tag_it != tags.end()) {
                                 build_tag_list_from_dense_nodes(builder, tag_it, tags.end());
                             }
@@ -715,10 +986,12 @@ namespace osmium {
 
             public:
 
-                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, const osmium::io::PushdownFilter* filter = nullptr, const osmium::io::add_key_signatures key_signatures = osmium::io::add_key_signatures::no) :
                     m_data(data),
-                    m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_types(filter ? (read_types & filter->entities()) : read_types),
+                    m_read_metadata(read_metadata),
+                    m_filter(filter),
+                    m_key_signatures(key_signatures) {
                 }
 
                 PBFPrimitiveBlockDecoder(const PBFPrimitiveBlockDecoder&) = delete;
@@ -825,6 +1098,60 @@ namespace osmium {
                     return box;
             }
 
+            inline osmium::io::DataRanges decode_data_ranges(const data_view& data) {
+                // Only ranges with both ends are used.
+                constexpr const int64_t none = std::numeric_limits<int64_t>::max();
+                int64_t ids[3][2] = {{none, none}, {none, none}, {none, none}};
+                int64_t timestamps[2] = {none, none};
+
+                protozero::pbf_message<OSMFormat::OsmiumDataRanges> pbf_ranges{data};
+                while (pbf_ranges.next()) {
+                    switch (pbf_ranges.tag_and_type()) {
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_sint64_min_node_id, protozero::pbf_wire_type::varint):
+                            ids[0][0] = pbf_ranges.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_sint64_max_node_id, protozero::pbf_wire_type::varint):
+                            ids[0][1] = pbf_ranges.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_sint64_min_way_id, protozero::pbf_wire_type::varint):
+                            ids[1][0] = pbf_ranges.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_sint64_max_way_id, protozero::pbf_wire_type::varint):
+                            ids[1][1] = pbf_ranges.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_sint64_min_relation_id, protozero::pbf_wire_type::varint):
+                            ids[2][0] = pbf_ranges.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_sint64_max_relation_id, protozero::pbf_wire_type::varint):
+                            ids[2][1] = pbf_ranges.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_int64_min_timestamp, protozero::pbf_wire_type::varint):
+                            timestamps[0] = pbf_ranges.get_int64();
+                            break;
+                        case protozero::tag_and_type(OSMFormat::OsmiumDataRanges::optional_int64_max_timestamp, protozero::pbf_wire_type::varint):
+                            timestamps[1] = pbf_ranges.get_int64();
+                            break;
+                        default:
+                            pbf_ranges.skip();
+                    }
+                }
+
+                osmium::io::DataRanges ranges;
+
+                const osmium::item_type types[3] = {osmium::item_type::node, osmium::item_type::way, osmium::item_type::relation};
+                for (std::size_t i = 0; i < 3; ++i) {
+                    if (ids[i][0] != none && ids[i][1] != none && ids[i][0] <= ids[i][1]) {
+                        ranges.add_ids(types[i], ids[i][0], ids[i][1]);
+                    }
+                }
+
+                if (timestamps[0] != none && timestamps[1] != none && timestamps[0] <= timestamps[1]) {
+                    ranges.add_timestamps(osmium::Timestamp{timestamps[0]}, osmium::Timestamp{timestamps[1]});
+                }
+
+                return ranges;
+            }
+
             inline osmium::io::Header decode_header_block(const data_view& data) {
                 osmium::io::Header header;
                 int i = 0;
@@ -875,6 +1202,9 @@ namespace osmium {
                         case protozero::tag_and_type(OSMFormat::HeaderBlock::optional_string_osmosis_replication_base_url, protozero::pbf_wire_type::length_delimited):
                             header.set("osmosis_replication_base_url", pbf_header_block.get_string());
                             break;
+                        case protozero::tag_and_type(OSMFormat::HeaderBlock::optional_OsmiumDataRanges_data_ranges, protozero::pbf_wire_type::length_delimited):
+                            header.data_ranges(decode_data_ranges(pbf_header_block.get_view()), false);
+                            break;
                         default:
                             pbf_header_block.skip();
                     }
@@ -901,18 +1231,22 @@ namespace osmium {
                 std::shared_ptr<std::string> m_input_buffer;
                 osmium::osm_entity_bits::type m_read_types;
                 osmium::io::read_meta m_read_metadata;
+                const osmium::io::PushdownFilter* m_filter;
+                osmium::io::add_key_signatures m_key_signatures;
 
             public:
 
-                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, const osmium::io::PushdownFilter* filter = nullptr, const osmium::io::add_key_signatures key_signatures = osmium::io::add_key_signatures::no) :
                     m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_filter(filter),
+                    m_key_signatures(key_signatures) {
                 }
 
                 osmium::memory::Buffer operator()() {
                     std::string output;
-                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata};
+                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata, m_filter, m_key_signatures};
                     return decoder();
                 }
 
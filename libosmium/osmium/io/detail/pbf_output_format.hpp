@@ -599,6 +599,27 @@ namespace osmium {
                         pbf_header_block.add_string(OSMFormat::HeaderBlock::optional_string_osmosis_replication_base_url, osmosis_replication_base_url);
                     }
 
+                    const auto& ranges = header.data_ranges();
+                    if (header.write_data_ranges() && !ranges.empty()) {
+                        protozero::pbf_builder<OSMFormat::OsmiumDataRanges> pbf_ranges{pbf_header_block, OSMFormat::HeaderBlock::optional_OsmiumDataRanges_data_ranges};
+                        if (ranges.has_ids(osmium::item_type::node)) {
+                            pbf_ranges.add_sint64(OSMFormat::OsmiumDataRanges::optional_sint64_min_node_id, ranges.min_id(osmium::item_type::node));
+                            pbf_ranges.add_sint64(OSMFormat::OsmiumDataRanges::optional_sint64_max_node_id, ranges.max_id(osmium::item_type::node));
+                        }
+                        if (ranges.has_ids(osmium::item_type::way)) {
+                            pbf_ranges.add_sint64(OSMFormat::OsmiumDataRanges::optional_sint64_min_way_id, ranges.min_id(osmium::item_type::way));
+                            pbf_ranges.add_sint64(OSMFormat::OsmiumDataRanges::optional_sint64_max_way_id, ranges.max_id(osmium::item_type::way));
+                        }
+                        if (ranges.has_ids(osmium::item_type::relation)) {
+                            pbf_ranges.add_sint64(OSMFormat::OsmiumDataRanges::optional_sint64_min_relation_id, ranges.min_id(osmium::item_type::relation));
+                            pbf_ranges.add_sint64(OSMFormat::OsmiumDataRanges::optional_sint64_max_relation_id, ranges.max_id(osmium::item_type::relation));
+                        }
+                        if (ranges.has_timestamps()) {
+                            pbf_ranges.add_int64(OSMFormat::OsmiumDataRanges::optional_int64_min_timestamp, uint32_t(ranges.min_timestamp()));
+                            pbf_ranges.add_int64(OSMFormat::OsmiumDataRanges::optional_int64_max_timestamp, uint32_t(ranges.max_timestamp()));
+                        }
+                    }
+
                     m_output_queue.push(m_pool.submit(
                         SerializeBlob{std::move(data),
                                       pbf_blob_type::header,
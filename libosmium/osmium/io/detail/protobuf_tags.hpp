@@ -74,7 +74,20 @@ namespace osmium {
                     optional_string_source            = 17,
                     optional_int64_osmosis_replication_timestamp       = 32,
                     optional_int64_osmosis_replication_sequence_number = 33,
-                    optional_string_osmosis_replication_base_url       = 34
+                    optional_string_osmosis_replication_base_url       = 34,
+                    optional_OsmiumDataRanges_data_ranges              = 1000 // Osmium extension
+                };
+
+                // Osmium extension, unknown to other readers which skip it.
+                enum class OsmiumDataRanges : protozero::pbf_tag_type {
+                    optional_sint64_min_node_id      = 1,
+                    optional_sint64_max_node_id      = 2,
+                    optional_sint64_min_way_id       = 3,
+                    optional_sint64_max_way_id       = 4,
+                    optional_sint64_min_relation_id  = 5,
+                    optional_sint64_max_relation_id  = 6,
+                    optional_int64_min_timestamp     = 7,
+                    optional_int64_max_timestamp     = 8
                 };
 
                 enum class HeaderBBox : protozero::pbf_tag_type {
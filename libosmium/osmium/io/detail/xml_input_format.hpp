@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/builder/builder.hpp>
 #include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/changeset_filter.hpp>
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/error.hpp>
@@ -332,6 +333,46 @@ namespace osmium {
                     builder.set_bounds(box);
                 }
 
+                // Check the attributes of a changeset against the
+                // changeset filter before anything is built.
+                static bool changeset_matches(const osmium::io::ChangesetFilter& filter, const XML_Char** attrs) {
+                    osmium::Box box;
+                    osmium::Timestamp created_at;
+                    osmium::Timestamp closed_at;
+                    osmium::user_id_type uid = 0;
+                    osmium::num_comments_type num_comments = 0;
+
+                    check_attributes(attrs, [&](const XML_Char* name, const XML_Char* value) {
+                        if (!std::strcmp(name, "min_lon")) {
+                            box.bottom_left().set_lon(value);
+                        } else if (!std::strcmp(name, "min_lat")) {
+                            box.bottom_left().set_lat(value);
+                        } else if (!std::strcmp(name, "max_lon")) {
+                            box.top_right().set_lon(value);
+                        } else if (!std::strcmp(name, "max_lat")) {
+                            box.top_right().set_lat(value);
+                        } else if (!std::strcmp(name, "created_at")) {
+                            created_at = osmium::Timestamp{value};
+                        } else if (!std::strcmp(name, "closed_at")) {
+                            closed_at = osmium::Timestamp{value};
+                        } else if (!std::strcmp(name, "uid")) {
+                            uid = osmium::string_to_uid(value);
+                        } else if (!std::strcmp(name, "comments_count")) {
+                            num_comments = osmium::string_to_num_comments(value);
+                        }
+                    });
+
+                    return filter.matches(created_at, closed_at, uid, box, num_comments);
+                }
+
+                bool read_discussions() const noexcept {
+                    return !changeset_filter() || changeset_filter()->read_discussions();
+                }
+
+                bool read_comment_text() const noexcept {
+                    return !changeset_filter() || changeset_filter()->read_comment_text();
+                }
+
                 void get_tag(osmium::builder::Builder& builder, const XML_Char** attrs) {
                     const char* k = "";
                     const char* v = "";
@@ -430,7 +471,8 @@ namespace osmium {
                     if (!std::strcmp(element, "changeset")) {
                         m_context_stack.push_back(context::changeset);
                         mark_header_as_done();
-                        if (read_types() & osmium::osm_entity_bits::changeset) {
+                        if ((read_types() & osmium::osm_entity_bits::changeset) &&
+                            (!changeset_filter() || changeset_matches(*changeset_filter(), attrs))) {
                             m_changeset_builder.reset(new osmium::builder::ChangesetBuilder{m_buffer});
                             init_changeset(*m_changeset_builder, attrs);
                         }
@@ -591,15 +633,15 @@ namespace osmium {
                         case context::changeset:
                             if (!std::strcmp(element, "discussion")) {
                                 m_context_stack.push_back(context::discussion);
-                                if (read_types() & osmium::osm_entity_bits::changeset) {
+                                if (m_changeset_builder) {
                                     m_tl_builder.reset();
-                                    if (!m_changeset_discussion_builder) {
+                                    if (!m_changeset_discussion_builder && read_discussions()) {
                                         m_changeset_discussion_builder.reset(new osmium::builder::ChangesetDiscussionBuilder{*m_changeset_builder});
                                     }
                                 }
                             } else if (!std::strcmp(element, "tag")) {
                                 m_context_stack.push_back(context::tag);
-                                if (read_types() & osmium::osm_entity_bits::changeset) {
+                                if (m_changeset_builder) {
                                     m_changeset_discussion_builder.reset();
                                     get_tag(*m_changeset_builder, attrs);
                                 }
@@ -610,7 +652,7 @@ namespace osmium {
                         case context::discussion:
                             if (!std::strcmp(element, "comment")) {
                                 m_context_stack.push_back(context::comment);
-                                if (read_types() & osmium::osm_entity_bits::changeset) {
+                                if (m_changeset_discussion_builder) {
                                     osmium::Timestamp date;
                                     osmium::user_id_type uid = 0;
                                     const char* user = "";
@@ -708,7 +750,7 @@ namespace osmium {
                             break;
                         case context::changeset:
                             assert(!std::strcmp(element, "changeset"));
-                            if (read_types() & osmium::osm_entity_bits::changeset) {
+                            if (m_changeset_builder) {
                                 m_tl_builder.reset();
                                 m_changeset_discussion_builder.reset();
                                 m_changeset_builder.reset();
@@ -724,7 +766,7 @@ namespace osmium {
                             break;
                         case context::text:
                             assert(!std::strcmp(element, "text"));
-                            if (read_types() & osmium::osm_entity_bits::changeset) {
+                            if (m_changeset_discussion_builder) {
                                 m_changeset_discussion_builder->add_comment_text(m_comment_text);
                                 m_comment_text.clear();
                             }
@@ -742,7 +784,8 @@ namespace osmium {
                 }
 
                 void characters(const XML_Char* text, int len) {
-                    if ((read_types() & osmium::osm_entity_bits::changeset) &&
+                    if (m_changeset_discussion_builder &&
+                        read_comment_text() &&
                         !m_context_stack.empty() &&
                         m_context_stack.back() == context::text) {
                         m_comment_text.append(text, len);
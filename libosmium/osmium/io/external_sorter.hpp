@@ -0,0 +1,601 @@
+#ifndef OSMIUM_IO_EXTERNAL_SORTER_HPP
+#define OSMIUM_IO_EXTERNAL_SORTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/data_ranges.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/misc.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Configuration for the ExternalSorter.
+         */
+        struct ExternalSorterConfig {
+
+            /**
+             * Approximate amount of memory used for the input data and
+             * the sort keys. If the input needs more than this, it is
+             * sorted in several runs which are written to temporary
+             * files and merged at the end.
+             */
+            std::size_t memory_budget = 1024UL * 1024UL * 1024UL;
+
+            /**
+             * Size of the buffers used for reading back the runs and of
+             * the buffers handed to the Writer.
+             */
+            std::size_t buffer_size = 1024UL * 1024UL;
+
+            /**
+             * Allow overwriting of an existing output file?
+             */
+            osmium::io::overwrite overwrite = osmium::io::overwrite::no;
+
+        }; // struct ExternalSorterConfig
+
+        /**
+         * Statistics about one run of the ExternalSorter.
+         */
+        struct ExternalSorterStats {
+
+            /// Number of objects sorted.
+            std::size_t objects = 0;
+
+            /// Number of sorted runs written to temporary files.
+            std::size_t runs = 0;
+
+            /// Number of bytes written to temporary files.
+            std::size_t bytes_spilled = 0;
+
+            /// Wall clock time of the whole run in seconds.
+            double seconds = 0.0;
+
+            /// Throughput of the run: Number of objects per second.
+            double objects_per_second() const noexcept {
+                if (seconds <= 0.0) {
+                    return 0.0;
+                }
+                return static_cast<double>(objects) / seconds;
+            }
+
+        }; // struct ExternalSorterStats
+
+        namespace detail {
+
+            /**
+             * Sort key for an object. Sorting these compact keys is much
+             * faster than sorting pointers to objects, because the
+             * objects don't have to be accessed. The order is the same
+             * as the one from object_order_type_id_version.
+             */
+            struct sort_key {
+
+                uint32_t type_sign;
+                uint32_t version;
+                uint64_t id;
+                uint32_t timestamp;
+                const osmium::OSMObject* object;
+
+                explicit sort_key(const osmium::OSMObject& obj) noexcept :
+                    type_sign((static_cast<uint32_t>(obj.type()) << 1U) | (obj.id() > 0 ? 1U : 0U)),
+                    version(obj.version()),
+                    id(obj.positive_id()),
+                    timestamp(obj.timestamp().valid() ? uint32_t(obj.timestamp()) : 0U),
+                    object(&obj) {
+                }
+
+                friend bool operator<(const sort_key& lhs, const sort_key& rhs) noexcept {
+                    return const_tie(lhs.type_sign, lhs.id, lhs.version, lhs.timestamp) <
+                           const_tie(rhs.type_sign, rhs.id, rhs.version, rhs.timestamp);
+                }
+
+            }; // struct sort_key
+
+            template <typename TFunc>
+            inline void sorter_run_parallel(std::size_t count, osmium::thread::Pool& pool, TFunc&& func) {
+                if (count <= 1) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        func(i);
+                    }
+                    return;
+                }
+
+                std::vector<std::future<void>> futures;
+                futures.reserve(count);
+                try {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        futures.push_back(pool.submit([&func, i]() {
+                            func(i);
+                        }));
+                    }
+                    for (auto& future : futures) {
+                        future.get();
+                    }
+                } catch (...) {
+                    for (auto& future : futures) {
+                        if (future.valid()) {
+                            future.wait();
+                        }
+                    }
+                    throw;
+                }
+            }
+
+            /**
+             * Sort the keys using all threads of the pool: Parts of the
+             * keys are sorted in parallel, then neighbouring parts are
+             * merged in parallel until only one is left.
+             */
+            inline void parallel_sort(std::vector<sort_key>& keys, osmium::thread::Pool& pool) {
+                constexpr const std::size_t min_part_size = 64UL * 1024UL;
+                const std::size_t num_parts = std::min(static_cast<std::size_t>(pool.num_threads()), keys.size() / min_part_size);
+                if (num_parts <= 1) {
+                    std::sort(keys.begin(), keys.end());
+                    return;
+                }
+
+                std::vector<std::size_t> bounds;
+                for (std::size_t i = 0; i <= num_parts; ++i) {
+                    bounds.push_back(keys.size() * i / num_parts);
+                }
+
+                sorter_run_parallel(num_parts, pool, [&](std::size_t part) {
+                    std::sort(keys.begin() + bounds[part], keys.begin() + bounds[part + 1]);
+                });
+
+                while (bounds.size() > 2) {
+                    const std::size_t num_merges = (bounds.size() - 1) / 2;
+                    sorter_run_parallel(num_merges, pool, [&](std::size_t merge) {
+                        std::inplace_merge(keys.begin() + bounds[2 * merge],
+                                           keys.begin() + bounds[2 * merge + 1],
+                                           keys.begin() + bounds[2 * merge + 2]);
+                    });
+                    std::vector<std::size_t> new_bounds;
+                    for (std::size_t i = 0; i < bounds.size(); i += 2) {
+                        new_bounds.push_back(bounds[i]);
+                    }
+                    if (new_bounds.back() != bounds.back()) {
+                        new_bounds.push_back(bounds.back());
+                    }
+                    bounds = std::move(new_bounds);
+                }
+            }
+
+            /**
+             * A sorted run in a temporary file. The objects are stored
+             * one after the other in their internal format, so they can
+             * be used directly after reading them back.
+             */
+            class sorted_run {
+
+                int m_fd;
+                std::unique_ptr<unsigned char[]> m_data;
+                std::size_t m_capacity;
+                std::size_t m_size = 0;
+                std::size_t m_pos = 0;
+                std::size_t m_bytes = 0;
+                bool m_eof = false;
+
+                // Make sure there are at least count bytes available at
+                // the current position. This invalidates all objects
+                // returned before.
+                bool ensure(std::size_t count) {
+                    if (m_size - m_pos >= count) {
+                        return true;
+                    }
+
+                    std::memmove(m_data.get(), m_data.get() + m_pos, m_size - m_pos);
+                    m_size -= m_pos;
+                    m_pos = 0;
+
+                    if (count > m_capacity) {
+                        std::unique_ptr<unsigned char[]> data{new unsigned char[count]};
+                        std::copy_n(m_data.get(), m_size, data.get());
+                        m_data = std::move(data);
+                        m_capacity = count;
+                    }
+
+                    while (!m_eof && m_size < count) {
+                        const auto nread = osmium::io::detail::reliable_read(m_fd, reinterpret_cast<char*>(m_data.get() + m_size), static_cast<unsigned int>(m_capacity - m_size));
+                        if (nread == 0) {
+                            m_eof = true;
+                        }
+                        m_size += static_cast<std::size_t>(nread);
+                    }
+
+                    return m_size >= count;
+                }
+
+            public:
+
+                /**
+                 * Write the objects in the order of the keys to a new
+                 * temporary file.
+                 */
+                sorted_run(const std::vector<sort_key>& keys, std::size_t buffer_size) :
+                    m_fd(osmium::detail::create_tmp_file()),
+                    m_data(new unsigned char[buffer_size]),
+                    m_capacity(buffer_size) {
+                    for (const auto& key : keys) {
+                        const auto size = key.object->padded_size();
+                        m_bytes += size;
+                        if (m_size + size > m_capacity) {
+                            osmium::io::detail::reliable_write(m_fd, m_data.get(), m_size);
+                            m_size = 0;
+                        }
+                        if (size > m_capacity) {
+                            osmium::io::detail::reliable_write(m_fd, key.object->data(), size);
+                        } else {
+                            std::copy_n(key.object->data(), size, m_data.get() + m_size);
+                            m_size += size;
+                        }
+                    }
+                    osmium::io::detail::reliable_write(m_fd, m_data.get(), m_size);
+                    m_size = 0;
+                    osmium::util::file_seek(m_fd, 0);
+                }
+
+                sorted_run(const sorted_run&) = delete;
+                sorted_run& operator=(const sorted_run&) = delete;
+
+                sorted_run(sorted_run&& other) noexcept :
+                    m_fd(other.m_fd),
+                    m_data(std::move(other.m_data)),
+                    m_capacity(other.m_capacity),
+                    m_size(other.m_size),
+                    m_pos(other.m_pos),
+                    m_bytes(other.m_bytes),
+                    m_eof(other.m_eof) {
+                    other.m_fd = -1;
+                }
+
+                sorted_run& operator=(sorted_run&&) = delete;
+
+                ~sorted_run() noexcept {
+                    try {
+                        osmium::io::detail::reliable_close(m_fd);
+                    } catch (...) { // NOLINT(bugprone-empty-catch)
+                        // Ignore errors when closing a temporary file.
+                    }
+                }
+
+                /// Number of bytes in the temporary file.
+                std::size_t bytes() const noexcept {
+                    return m_bytes;
+                }
+
+                /**
+                 * Get the next object or nullptr at the end. The object
+                 * is valid until the next call.
+                 */
+                const osmium::OSMObject* next() {
+                    if (!ensure(sizeof(osmium::memory::Item))) {
+                        return nullptr;
+                    }
+                    const auto size = reinterpret_cast<const osmium::memory::Item*>(m_data.get() + m_pos)->padded_size();
+                    if (!ensure(size)) {
+                        return nullptr;
+                    }
+                    const auto* object = reinterpret_cast<const osmium::OSMObject*>(m_data.get() + m_pos);
+                    m_pos += size;
+                    return object;
+                }
+
+            }; // class sorted_run
+
+            struct sorter_merge_entry {
+                sort_key key;
+                std::size_t source;
+            };
+
+            struct sorter_merge_entry_greater {
+
+                bool operator()(const sorter_merge_entry& lhs, const sorter_merge_entry& rhs) const noexcept {
+                    return rhs.key < lhs.key || (!(lhs.key < rhs.key) && rhs.source < lhs.source);
+                }
+
+            }; // struct sorter_merge_entry_greater
+
+        } // namespace detail
+
+        /**
+         * Sort OSM files by type, id, and version (and timestamp), also
+         * if they don't fit into memory.
+         *
+         * The input is decoded in parallel by the Reader and kept in
+         * memory until the memory budget is used up. Then compact sort
+         * keys for all objects are sorted using all threads of the pool
+         * and the objects are written in that order to a temporary file
+         * in their internal format, so they don't have to be encoded or
+         * decoded again. At the end all these runs are merged with a
+         * k-way merge and written out through a Writer. If all data fits
+         * into memory, no temporary files are used.
+         *
+         * Temporary files are created with tmpfile(), so they are in the
+         * default directory for temporary files of the system and are
+         * removed automatically.
+         *
+         * The result can be a history file if the input contains several
+         * versions of the same object. Use osmium::handler::CheckOrder or
+         * the object_order_type_id_version comparison to check whether a
+         * file is sorted.
+         *
+         * @code
+         * osmium::io::ExternalSorterConfig config;
+         * config.memory_budget = 4UL * 1024UL * 1024UL * 1024UL;
+         * osmium::io::ExternalSorter sorter{osmium::io::File{"unsorted.osm.pbf"}, config};
+         * const auto stats = sorter(osmium::io::File{"sorted.osm.pbf"});
+         * @endcode
+         */
+        class ExternalSorter {
+
+            std::vector<osmium::io::File> m_inputs{};
+            osmium::io::Header m_header{};
+            ExternalSorterConfig m_config;
+
+            static std::vector<detail::sort_key> make_keys(const std::vector<osmium::memory::Buffer>& buffers, std::size_t count) {
+                std::vector<detail::sort_key> keys;
+                keys.reserve(count);
+                for (const auto& buffer : buffers) {
+                    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                        keys.emplace_back(object);
+                    }
+                }
+                return keys;
+            }
+
+        public:
+
+            /**
+             * Create a sorter for the given input file.
+             */
+            explicit ExternalSorter(const osmium::io::File& input, const ExternalSorterConfig& config = ExternalSorterConfig{}) :
+                m_config(config) {
+                m_inputs.push_back(input);
+            }
+
+            /**
+             * Add another input file. The objects from all inputs are
+             * sorted together. The header of the output is taken from
+             * the first input.
+             */
+            void add_input(const osmium::io::File& input) {
+                m_inputs.push_back(input);
+            }
+
+            /**
+             * The header of the first input. Available after sort() has
+             * read the inputs, ie. when it calls the sink for the first
+             * time.
+             */
+            const osmium::io::Header& header() const noexcept {
+                return m_header;
+            }
+
+            /**
+             * Read all inputs, sort them, and hand the sorted objects to
+             * the sink in buffers of about ExternalSorterConfig::buffer_size
+             * bytes. All inputs are read completely before the sink is
+             * called for the first time.
+             *
+             * @param sink Something callable with a buffer, usually an
+             *             osmium::io::Writer.
+             * @param pool Thread pool used for sorting.
+             * @returns Statistics about this run.
+             * @throws Any exception the Readers or the sink throw.
+             * @throws std::system_error If there is a problem with a
+             *         temporary file.
+             */
+            template <typename TSink>
+            ExternalSorterStats sort(TSink&& sink, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+                ExternalSorterStats stats;
+                const auto start = std::chrono::steady_clock::now();
+
+                std::vector<detail::sorted_run> runs;
+                std::vector<osmium::memory::Buffer> buffers;
+                osmium::io::DataRanges ranges;
+                std::size_t memory = 0;
+                std::size_t count = 0;
+                bool collecting = false; // Is the last buffer one we copy into?
+
+                const auto spill = [&]() {
+                    std::vector<detail::sort_key> keys{make_keys(buffers, count)};
+                    detail::parallel_sort(keys, pool);
+                    runs.emplace_back(keys, m_config.buffer_size);
+                    ++stats.runs;
+                    stats.bytes_spilled += runs.back().bytes();
+                    buffers.clear();
+                    memory = 0;
+                    count = 0;
+                    collecting = false;
+                };
+
+                for (std::size_t i = 0; i < m_inputs.size(); ++i) {
+                    osmium::io::Reader reader{m_inputs[i], osmium::osm_entity_bits::nwr};
+                    if (i == 0) {
+                        m_header = reader.header();
+                    }
+                    while (osmium::memory::Buffer buffer = reader.read()) {
+                        count += buffer.select<osmium::OSMObject>().size();
+                        ranges.add(buffer);
+                        if (buffer.committed() < buffer.capacity() / 2) {
+                            // Copy the contents of mostly empty buffers
+                            // together, so they don't use up the memory
+                            // budget.
+                            if (!collecting || buffers.back().capacity() - buffers.back().committed() < buffer.committed()) {
+                                buffers.emplace_back(std::max(m_config.buffer_size, buffer.committed()), osmium::memory::Buffer::auto_grow::no);
+                                memory += buffers.back().capacity();
+                                collecting = true;
+                            }
+                            buffers.back().add_buffer(buffer);
+                            buffers.back().commit();
+                        } else {
+                            memory += buffer.capacity();
+                            buffers.push_back(std::move(buffer));
+                            collecting = false;
+                        }
+                        if (memory + count * sizeof(detail::sort_key) >= m_config.memory_budget) {
+                            stats.objects += count;
+                            spill();
+                        }
+                    }
+                    reader.close();
+                }
+                stats.objects += count;
+
+                // All data is known before anything is written, so the
+                // header can have the exact ranges.
+                m_header.data_ranges(ranges);
+
+                // The objects still in memory are sorted, too, and take
+                // part in the merge without being written out.
+                std::vector<detail::sort_key> keys{make_keys(buffers, count)};
+                detail::parallel_sort(keys, pool);
+
+                osmium::memory::Buffer out{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                const auto write = [&](const osmium::OSMObject& object) {
+                    out.add_item(object);
+                    out.commit();
+                    if (out.committed() >= m_config.buffer_size) {
+                        std::forward<TSink>(sink)(std::move(out));
+                        out = osmium::memory::Buffer{m_config.buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                    }
+                };
+
+                if (runs.empty()) {
+                    for (const auto& key : keys) {
+                        write(*key.object);
+                    }
+                } else {
+                    // Source i < runs.size() is run i, the last source
+                    // are the keys still in memory.
+                    std::size_t key_pos = 0;
+                    const auto next = [&](const std::size_t source) -> const osmium::OSMObject* {
+                        if (source < runs.size()) {
+                            return runs[source].next();
+                        }
+                        return key_pos < keys.size() ? keys[key_pos++].object : nullptr;
+                    };
+
+                    std::priority_queue<detail::sorter_merge_entry, std::vector<detail::sorter_merge_entry>, detail::sorter_merge_entry_greater> queue;
+                    for (std::size_t source = 0; source <= runs.size(); ++source) {
+                        if (const osmium::OSMObject* object = next(source)) {
+                            queue.push(detail::sorter_merge_entry{detail::sort_key{*object}, source});
+                        }
+                    }
+
+                    // The object popped last has to be written before
+                    // the next object of its run is read, because that
+                    // can invalidate it.
+                    while (!queue.empty()) {
+                        const detail::sorter_merge_entry entry = queue.top();
+                        queue.pop();
+                        write(*entry.key.object);
+                        if (const osmium::OSMObject* object = next(entry.source)) {
+                            queue.push(detail::sorter_merge_entry{detail::sort_key{*object}, entry.source});
+                        }
+                    }
+                }
+
+                if (out.committed() > 0) {
+                    std::forward<TSink>(sink)(std::move(out));
+                }
+
+                stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return stats;
+            }
+
+            /**
+             * Read all inputs, sort them, and write the result to the
+             * output file. The output file is only created after all
+             * inputs have been read.
+             *
+             * @returns Statistics about this run.
+             * @throws Any exception the Readers or the Writer throw.
+             * @throws std::system_error If there is a problem with a
+             *         temporary file.
+             */
+            ExternalSorterStats operator()(const osmium::io::File& output,
+                                           osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+                std::unique_ptr<osmium::io::Writer> writer;
+                const auto open = [&]() {
+                    if (!writer) {
+                        writer.reset(new osmium::io::Writer{output, m_header, m_config.overwrite});
+                    }
+                };
+
+                const ExternalSorterStats stats = sort([&](osmium::memory::Buffer&& buffer) {
+                    open();
+                    (*writer)(std::move(buffer));
+                }, pool);
+
+                open();
+                writer->close();
+
+                return stats;
+            }
+
+        }; // class ExternalSorter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_EXTERNAL_SORTER_HPP
@@ -56,6 +56,11 @@ namespace osmium {
             yes = 1
         };
 
+        enum class add_key_signatures {
+            no  = 0,
+            yes = 1
+        };
+
         inline const char* as_string(const file_format format) noexcept {
             switch (format) {
                 case file_format::xml:
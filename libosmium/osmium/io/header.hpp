@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/data_ranges.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/util/options.hpp>
 
@@ -58,6 +59,13 @@ namespace osmium {
          * files. Not all OSM file formats can distinguish between those
          * cases, so the flag might be wrong.
          *
+         * The header can contain the ranges of the ids and timestamps of
+         * the objects in the file (see DataRanges). Currently only the PBF
+         * format stores them. Ranges read from a file are not written out
+         * again when the header is copied to a Writer, because they don't
+         * necessarily hold for the new data. They have to be set
+         * explicitly with data_ranges() for every file written.
+         *
          * In addition the header can contain any number of key-value pairs
          * with additional information. Most often this is used to set the
          * "generator", the program that generated the file. Depending on
@@ -77,6 +85,12 @@ namespace osmium {
              */
             bool m_has_multiple_object_versions = false;
 
+            /// Ranges of ids and timestamps
+            osmium::io::DataRanges m_data_ranges{};
+
+            /// Should the writer write the ranges?
+            bool m_write_data_ranges = false;
+
         public:
 
             Header() = default;
@@ -160,6 +174,39 @@ namespace osmium {
                 return *this;
             }
 
+            /**
+             * Get the ranges of ids and timestamps of the objects in the
+             * file. They are empty if the file doesn't have them.
+             */
+            const osmium::io::DataRanges& data_ranges() const noexcept {
+                return m_data_ranges;
+            }
+
+            /**
+             * Set the ranges of ids and timestamps of the objects in the
+             * file.
+             *
+             * @param data_ranges The ranges.
+             * @param write Should writers write the ranges into the file?
+             *              Only set this if the ranges are known to hold
+             *              for all objects written.
+             * @returns The header itself to allow chaining.
+             */
+            Header& data_ranges(const osmium::io::DataRanges& data_ranges, bool write = true) noexcept {
+                m_data_ranges = data_ranges;
+                m_write_data_ranges = write;
+                return *this;
+            }
+
+            /**
+             * Will writers write the data ranges into the file? This is
+             * only the case if they were set with data_ranges(), not if
+             * they were read from a file.
+             */
+            bool write_data_ranges() const noexcept {
+                return m_write_data_ranges;
+            }
+
         }; // class Header
 
     } // namespace io
@@ -0,0 +1,321 @@
+#ifndef OSMIUM_IO_PUSHDOWN_FILTER_HPP
+#define OSMIUM_IO_PUSHDOWN_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/util/string_matcher.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * A filter that can be handed to the Reader as an additional
+         * option and is "pushed down" into the input format. Input formats
+         * supporting it (currently only PBF) evaluate it while decoding and
+         * never build the objects that don't match. The PBF decoder
+         * evaluates the tag rules only once for every distinct string in
+         * the string table of a block instead of once for every tag.
+         *
+         * All other input formats ignore this filter, so if you might read
+         * those, check the objects you get with matches() again.
+         *
+         * An object is kept if
+         * * its type is in entities(),
+         * * it is a node and no bounding box is set or its location is
+         *   inside the bounding box, and
+         * * its type is not in tagged_types(), there are no tag rules, or
+         *   the tag rules return true for at least one of its tags.
+         *
+         * The tag rules work like in the TagsFilter: The first rule
+         * matching a tag sets the result for that tag, if no rule matches,
+         * the default result is used. There can be at most 64 rules.
+         *
+         * @code
+         * osmium::io::PushdownFilter filter;
+         * filter.add_rule(true, osmium::StringMatcher::equal{"highway"});
+         * filter.set_tagged_types(osmium::osm_entity_bits::way);
+         * osmium::io::Reader reader{"input.osm.pbf", filter};
+         * @endcode
+         */
+        class PushdownFilter {
+
+        public:
+
+            /// Maximum number of tag rules in a filter.
+            enum {
+                max_rules = 64
+            };
+
+        private:
+
+            struct rule {
+
+                osmium::StringMatcher key;
+                osmium::StringMatcher value;
+                bool has_value;
+                bool invert;
+
+                rule(osmium::StringMatcher&& k, osmium::StringMatcher&& v, bool hv, bool inv) :
+                    key(std::move(k)),
+                    value(std::move(v)),
+                    has_value(hv),
+                    invert(inv) {
+                }
+
+            }; // struct rule
+
+            std::vector<rule> m_rules;
+            uint64_t m_true_rules = 0;
+            osmium::Box m_bbox{};
+            osmium::osm_entity_bits::type m_entities = osmium::osm_entity_bits::all;
+            osmium::osm_entity_bits::type m_tagged_types = osmium::osm_entity_bits::nwr;
+            bool m_default_result = false;
+
+            void add_rule_impl(const bool result, rule&& r) {
+                if (m_rules.size() == max_rules) {
+                    throw std::length_error{"too many rules in PushdownFilter (max 64)"};
+                }
+                if (result) {
+                    m_true_rules |= 1ULL << m_rules.size();
+                }
+                m_rules.push_back(std::move(r));
+            }
+
+        public:
+
+            /**
+             * Create a filter that accepts everything.
+             */
+            PushdownFilter() = default;
+
+            /**
+             * Add a rule matching only the key.
+             *
+             * @param result The result for tags matching this rule.
+             * @param key_matcher StringMatcher for the key.
+             * @returns A reference to this filter for chaining.
+             * @throws std::length_error If there are already max_rules rules.
+             */
+            PushdownFilter& add_rule(const bool result, osmium::StringMatcher key_matcher) {
+                add_rule_impl(result, rule{std::move(key_matcher), osmium::StringMatcher{}, false, false});
+                return *this;
+            }
+
+            /**
+             * Add a rule matching key and value.
+             *
+             * @param result The result for tags matching this rule.
+             * @param key_matcher StringMatcher for the key.
+             * @param value_matcher StringMatcher for the value.
+             * @param invert If set to true, invert the result of the
+             *               value_matcher.
+             * @returns A reference to this filter for chaining.
+             * @throws std::length_error If there are already max_rules rules.
+             */
+            PushdownFilter& add_rule(const bool result, osmium::StringMatcher key_matcher, osmium::StringMatcher value_matcher, const bool invert = false) {
+                add_rule_impl(result, rule{std::move(key_matcher), std::move(value_matcher), true, invert});
+                return *this;
+            }
+
+            /**
+             * Set the result for tags not matching any rule.
+             */
+            PushdownFilter& set_default_result(const bool default_result) noexcept {
+                m_default_result = default_result;
+                return *this;
+            }
+
+            /**
+             * Only keep objects of these types. Default: all.
+             */
+            PushdownFilter& set_entities(const osmium::osm_entity_bits::type entities) noexcept {
+                m_entities = entities;
+                return *this;
+            }
+
+            /**
+             * The tag rules are only applied to objects of these types.
+             * Default: nodes, ways, and relations.
+             */
+            PushdownFilter& set_tagged_types(const osmium::osm_entity_bits::type types) noexcept {
+                m_tagged_types = types;
+                return *this;
+            }
+
+            /**
+             * Only keep nodes inside this box. Set an undefined box to
+             * disable this check (the default).
+             */
+            PushdownFilter& set_bbox(const osmium::Box& bbox) noexcept {
+                m_bbox = bbox;
+                return *this;
+            }
+
+            osmium::osm_entity_bits::type entities() const noexcept {
+                return m_entities;
+            }
+
+            osmium::osm_entity_bits::type tagged_types() const noexcept {
+                return m_tagged_types;
+            }
+
+            const osmium::Box& bbox() const noexcept {
+                return m_bbox;
+            }
+
+            bool default_result() const noexcept {
+                return m_default_result;
+            }
+
+            /// The number of tag rules in this filter.
+            std::size_t count() const noexcept {
+                return m_rules.size();
+            }
+
+            /**
+             * Are tags of objects of the specified type checked?
+             */
+            bool filters_tags(const osmium::osm_entity_bits::type type) const noexcept {
+                return !m_rules.empty() && (m_tagged_types & type);
+            }
+
+            /**
+             * Is the location inside the bounding box (or is there no
+             * bounding box)?
+             */
+            bool location_matches(const osmium::Location& location) const noexcept {
+                return !m_bbox || (location && m_bbox.contains(location));
+            }
+
+            /**
+             * Get the set of rules (as bit mask) whose key matcher matches
+             * the specified string.
+             */
+            uint64_t key_mask(const char* key) const noexcept {
+                uint64_t mask = 0;
+                uint64_t bit = 1;
+                for (const auto& r : m_rules) {
+                    if (r.key(key)) {
+                        mask |= bit;
+                    }
+                    bit <<= 1U;
+                }
+                return mask;
+            }
+
+            /**
+             * Get the set of rules (as bit mask) whose value matcher matches
+             * the specified string. Rules without value matcher always match.
+             */
+            uint64_t value_mask(const char* value) const noexcept {
+                uint64_t mask = 0;
+                uint64_t bit = 1;
+                for (const auto& r : m_rules) {
+                    if (!r.has_value || (r.value(value) != r.invert)) {
+                        mask |= bit;
+                    }
+                    bit <<= 1U;
+                }
+                return mask;
+            }
+
+            /**
+             * Get the result for a tag given the bit mask of all rules
+             * matching it (ie. key_mask() & value_mask()). The result of
+             * the lowest numbered rule wins.
+             */
+            bool result(const uint64_t matching_rules) const noexcept {
+                if (matching_rules == 0) {
+                    return m_default_result;
+                }
+                return (matching_rules & (~matching_rules + 1)) & m_true_rules;
+            }
+
+            /**
+             * Check a single tag against the tag rules.
+             */
+            bool operator()(const char* key, const char* value) const noexcept {
+                return result(key_mask(key) & value_mask(value));
+            }
+
+            /**
+             * Check tags against the tag rules.
+             *
+             * @returns true if any of the tags matches.
+             */
+            bool operator()(const osmium::TagList& tags) const noexcept {
+                for (const auto& tag : tags) {
+                    if (operator()(tag.key(), tag.value())) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * Check an object against this filter. This applies the same
+             * checks as the PBF decoder does, so it can be used on the
+             * objects from input formats that don't support this filter.
+             */
+            bool matches(const osmium::OSMObject& object) const noexcept {
+                const auto type = osmium::osm_entity_bits::from_item_type(object.type());
+                if (!(m_entities & type)) {
+                    return false;
+                }
+                if (type == osmium::osm_entity_bits::node &&
+                    !location_matches(static_cast<const osmium::Node&>(object).location())) {
+                    return false;
+                }
+                return !filters_tags(type) || (*this)(object.tags());
+            }
+
+        }; // class PushdownFilter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PUSHDOWN_FILTER_HPP
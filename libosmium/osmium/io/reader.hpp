@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/changeset_filter.hpp>
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
@@ -41,6 +42,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/pushdown_filter.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
@@ -121,12 +123,18 @@ namespace osmium {
             std::future<osmium::io::Header> m_header_future{};
             osmium::io::Header m_header{};
 
+            // Must be declared before m_thread, because the parser thread
+            // uses them.
+            std::unique_ptr<osmium::io::PushdownFilter> m_filter{};
+            std::unique_ptr<osmium::io::ChangesetFilter> m_changeset_filter{};
+
             osmium::thread::thread_handler m_thread{};
 
             std::size_t m_file_size = 0;
 
             osmium::osm_entity_bits::type m_read_which_entities = osmium::osm_entity_bits::all;
             osmium::io::read_meta m_read_metadata = osmium::io::read_meta::yes;
+            osmium::io::add_key_signatures m_key_signatures = osmium::io::add_key_signatures::no;
 
             void set_option(osmium::thread::Pool& pool) noexcept {
                 m_pool = &pool;
@@ -140,6 +148,18 @@ namespace osmium {
                 m_read_metadata = value;
             }
 
+            void set_option(osmium::io::add_key_signatures value) noexcept {
+                m_key_signatures = value;
+            }
+
+            void set_option(const osmium::io::PushdownFilter& filter) {
+                m_filter.reset(new osmium::io::PushdownFilter{filter});
+            }
+
+            void set_option(const osmium::io::ChangesetFilter& filter) {
+                m_changeset_filter.reset(new osmium::io::ChangesetFilter{filter});
+            }
+
             // This function will run in a separate thread.
             static void parser_thread(osmium::thread::Pool& pool,
                                       const detail::ParserFactory::create_parser_type& creator,
@@ -147,7 +167,10 @@ namespace osmium {
                                       detail::future_buffer_queue_type& osmdata_queue,
                                       std::promise<osmium::io::Header>&& header_promise,
                                       osmium::osm_entity_bits::type read_which_entities,
-                                      osmium::io::read_meta read_metadata) {
+                                      osmium::io::read_meta read_metadata,
+                                      const osmium::io::PushdownFilter* filter,
+                                      const osmium::io::ChangesetFilter* changeset_filter,
+                                      osmium::io::add_key_signatures key_signatures) {
                 std::promise<osmium::io::Header> promise{std::move(header_promise)};
                 osmium::io::detail::parser_arguments args = {
                     pool,
@@ -155,7 +178,10 @@ namespace osmium {
                     osmdata_queue,
                     promise,
                     read_which_entities,
-                    read_metadata
+                    read_metadata,
+                    filter,
+                    changeset_filter,
+                    key_signatures
                 };
                 creator(args)->parse();
             }
@@ -249,6 +275,20 @@ namespace osmium {
              *      osmium::io::read_meta::no, meta data (like version, uid,
              *      etc.) is not read possibly speeding up the read. Not all
              *      file formats use this setting.
+             * * osmium::io::PushdownFilter: Filter evaluated while
+             *      decoding the input, objects not matching it are never
+             *      built. The Reader keeps a copy of the filter. Only some
+             *      file formats (currently PBF) use this setting, with
+             *      other formats you get all objects.
+             * * osmium::io::ChangesetFilter: Filter for changesets
+             *      evaluated while parsing the input, it can also skip
+             *      discussions and comment texts. The Reader keeps a copy
+             *      of the filter. Only some file formats (currently XML)
+             *      use this setting.
+             * * osmium::io::add_key_signatures: Add a KeySignature (see
+             *      osm/key_signature.hpp) as first subitem to each object.
+             *      The default is osmium::io::add_key_signatures::no. Only
+             *      some file formats (currently PBF) use this setting.
              * * osmium::thread::Pool&: Reference to a thread pool that should
              *      be used for reading instead of the default pool. Usually
              *      it is okay to use the statically initialized shared
@@ -282,7 +322,7 @@ namespace osmium {
 
                 std::promise<osmium::io::Header> header_promise;
                 m_header_future = header_promise.get_future();
-                m_thread = osmium::thread::thread_handler{parser_thread, std::ref(*m_pool), std::ref(m_creator), std::ref(m_input_queue), std::ref(m_osmdata_queue), std::move(header_promise), m_read_which_entities, m_read_metadata};
+                m_thread = osmium::thread::thread_handler{parser_thread, std::ref(*m_pool), std::ref(m_creator), std::ref(m_input_queue), std::ref(m_osmdata_queue), std::move(header_promise), m_read_which_entities, m_read_metadata, m_filter.get(), m_changeset_filter.get(), m_key_signatures};
             }
 
             template <typename... TArgs>
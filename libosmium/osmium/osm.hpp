@@ -38,6 +38,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/entity.hpp> // IWYU pragma: export
 #include <osmium/osm/entity_bits.hpp> // IWYU pragma: export
 #include <osmium/osm/item_type.hpp> // IWYU pragma: export
+#include <osmium/osm/key_signature.hpp> // IWYU pragma: export
 #include <osmium/osm/location.hpp> // IWYU pragma: export
 #include <osmium/osm/node.hpp> // IWYU pragma: export
 #include <osmium/osm/node_ref.hpp> // IWYU pragma: export
@@ -49,6 +49,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/util/endian.hpp>
 
 #include <cstdint>
+#include <cstring>
 
 namespace osmium {
 
@@ -94,7 +95,13 @@ namespace osmium {
      *
      * Typically you will either use the boost::crc_32_type from the Boost
      * CRC library or the osmium::CRC_zlib class which uses the zlib library
-     * for this, but other checksums are possible.
+     * for this, but other checksums are possible. If you only need to find
+     * out whether objects changed, the osmium::CRC32C or osmium::Hash64
+     * classes are much faster.
+     *
+     * Strings and node reference lists (on little endian machines) are
+     * handed to the policy class in one piece, not byte by byte, so policy
+     * classes with a fast process_bytes() are fast here.
      *
      * @tparam TCRC A CRC type.
      */
@@ -149,9 +156,7 @@ namespace osmium {
         }
 
         void update_string(const char* str) noexcept {
-            while (*str) {
-                m_crc.process_byte(*str++);
-            }
+            m_crc.process_bytes(str, std::strlen(str));
         }
 
         void update(const Timestamp& timestamp) noexcept {
@@ -159,8 +164,13 @@ namespace osmium {
         }
 
         void update(const osmium::Location& location) noexcept {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            const int32_t data[2] = {location.x(), location.y()};
+            m_crc.process_bytes(data, sizeof(data));
+#else
             update_int32(location.x());
             update_int32(location.y());
+#endif
         }
 
         void update(const osmium::Box& box) noexcept {
@@ -174,9 +184,19 @@ namespace osmium {
         }
 
         void update(const NodeRefList& node_refs) noexcept {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            // The in-memory layout of the node refs is the same as
+            // the one used by update(const NodeRef&), so they can be
+            // processed in one piece.
+            static_assert(sizeof(NodeRef) == sizeof(osmium::object_id_type) + 2 * sizeof(int32_t), "NodeRef must not contain padding");
+            if (!node_refs.empty()) {
+                m_crc.process_bytes(&*node_refs.cbegin(), node_refs.size() * sizeof(NodeRef));
+            }
+#else
             for (const NodeRef& node_ref : node_refs) {
                 update(node_ref);
             }
+#endif
         }
 
         void update(const TagList& tags) noexcept {
@@ -199,11 +219,23 @@ namespace osmium {
         }
 
         void update(const osmium::OSMObject& object) noexcept {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            // Same bytes as the individual updates below, but handed
+            // to the policy class in one piece.
+            unsigned char data[sizeof(uint64_t) + 1 + 3 * sizeof(uint32_t)];
+            const uint64_t id = static_cast<uint64_t>(object.id());
+            const uint32_t fields[3] = {object.version(), uint32_t(object.timestamp()), object.uid()};
+            std::memcpy(data, &id, sizeof(id));
+            data[sizeof(id)] = object.visible();
+            std::memcpy(data + sizeof(id) + 1, fields, sizeof(fields));
+            m_crc.process_bytes(data, sizeof(data));
+#else
             update_int64(object.id());
             update_bool(object.visible());
             update_int32(object.version());
             update(object.timestamp());
             update_int32(object.uid());
+#endif
             update_string(object.user());
             update(object.tags());
         }
@@ -0,0 +1,185 @@
+#ifndef OSMIUM_OSM_CRC32C_HPP
+#define OSMIUM_OSM_CRC32C_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/util/endian.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+# include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+# include <arm_acle.h>
+#endif
+
+namespace osmium {
+
+    namespace detail {
+
+        /**
+         * Lookup tables for the software implementation of CRC32C
+         * ("slicing by 8").
+         */
+        class crc32c_tables {
+
+            uint32_t m_table[8][256];
+
+            crc32c_tables() noexcept {
+                constexpr const uint32_t polynomial = 0x82F63B78U; // reversed Castagnoli polynomial
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t crc = i;
+                    for (int j = 0; j < 8; ++j) {
+                        crc = (crc >> 1U) ^ ((crc & 1U) ? polynomial : 0U);
+                    }
+                    m_table[0][i] = crc;
+                }
+                for (uint32_t i = 0; i < 256; ++i) {
+                    for (int t = 1; t < 8; ++t) {
+                        m_table[t][i] = (m_table[t - 1][i] >> 8U) ^ m_table[0][m_table[t - 1][i] & 0xffU];
+                    }
+                }
+            }
+
+        public:
+
+            static const crc32c_tables& instance() noexcept {
+                static const crc32c_tables tables;
+                return tables;
+            }
+
+            uint32_t process_byte(uint32_t crc, const unsigned char byte) const noexcept {
+                return (crc >> 8U) ^ m_table[0][(crc ^ byte) & 0xffU];
+            }
+
+            uint32_t process_bytes(uint32_t crc, const unsigned char* data, std::size_t count) const noexcept {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+                for (; count >= 8; count -= 8, data += 8) {
+                    uint32_t low;
+                    uint32_t high;
+                    std::memcpy(&low, data, sizeof(low));
+                    std::memcpy(&high, data + 4, sizeof(high));
+                    low ^= crc;
+                    crc = m_table[7][low & 0xffU] ^
+                          m_table[6][(low >> 8U) & 0xffU] ^
+                          m_table[5][(low >> 16U) & 0xffU] ^
+                          m_table[4][low >> 24U] ^
+                          m_table[3][high & 0xffU] ^
+                          m_table[2][(high >> 8U) & 0xffU] ^
+                          m_table[1][(high >> 16U) & 0xffU] ^
+                          m_table[0][high >> 24U];
+                }
+#endif
+                for (; count > 0; --count) {
+                    crc = process_byte(crc, *data++);
+                }
+                return crc;
+            }
+
+        }; // class crc32c_tables
+
+    } // namespace detail
+
+    /**
+     * This class is used together with the CRC class to implement a CRC32C
+     * (Castagnoli) checksum. If the code is compiled for a CPU with CRC32C
+     * instructions (x86 with SSE 4.2, for instance with -msse4.2 or
+     * -march=native, or ARMv8 with the CRC extension) these instructions
+     * are used, otherwise a table-driven software implementation. Both
+     * give the same results.
+     *
+     * This is much faster than CRC_zlib, but the checksums are different,
+     * so don't mix them.
+     *
+     * Usage:
+     *
+     * @code
+     * osmium::CRC<osmium::CRC32C> crc32c;
+     * const osmium::Node& node = ...;
+     * crc32c.update(node);
+     * std::cout << crc32c().checksum() << '\n';
+     * @endcode
+     */
+    class CRC32C {
+
+        uint32_t m_crc = 0xffffffffU;
+
+    public:
+
+        void process_byte(const unsigned char byte) noexcept {
+#if defined(__SSE4_2__)
+            m_crc = _mm_crc32_u8(m_crc, byte);
+#elif defined(__ARM_FEATURE_CRC32)
+            m_crc = __crc32cb(m_crc, byte);
+#else
+            m_crc = detail::crc32c_tables::instance().process_byte(m_crc, byte);
+#endif
+        }
+
+        void process_bytes(const void* buffer, std::size_t byte_count) noexcept {
+            const auto* data = reinterpret_cast<const unsigned char*>(buffer);
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+# if defined(__SSE4_2__) && (defined(__x86_64__) || defined(_M_X64))
+            uint64_t crc = m_crc;
+            for (; byte_count >= 8; byte_count -= 8, data += 8) {
+                uint64_t value;
+                std::memcpy(&value, data, sizeof(value));
+                crc = _mm_crc32_u64(crc, value);
+            }
+            m_crc = static_cast<uint32_t>(crc);
+# elif defined(__ARM_FEATURE_CRC32)
+            for (; byte_count >= 8; byte_count -= 8, data += 8) {
+                uint64_t value;
+                std::memcpy(&value, data, sizeof(value));
+                m_crc = __crc32cd(m_crc, value);
+            }
+# endif
+            for (; byte_count > 0; --byte_count) {
+                process_byte(*data++);
+            }
+#else
+            m_crc = detail::crc32c_tables::instance().process_bytes(m_crc, data, byte_count);
+#endif
+        }
+
+        uint32_t checksum() const noexcept {
+            return ~m_crc;
+        }
+
+    }; // class CRC32C
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_CRC32C_HPP
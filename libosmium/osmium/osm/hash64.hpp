@@ -0,0 +1,235 @@
+#ifndef OSMIUM_OSM_HASH64_HPP
+#define OSMIUM_OSM_HASH64_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/util/endian.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace osmium {
+
+    namespace detail {
+
+        constexpr const uint64_t xxh64_prime1 = 0x9E3779B185EBCA87ULL;
+        constexpr const uint64_t xxh64_prime2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr const uint64_t xxh64_prime3 = 0x165667B19E3779F9ULL;
+        constexpr const uint64_t xxh64_prime4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr const uint64_t xxh64_prime5 = 0x27D4EB2F165667C5ULL;
+
+        inline uint64_t xxh64_rotl(const uint64_t value, const unsigned int bits) noexcept {
+            return (value << bits) | (value >> (64U - bits));
+        }
+
+        inline uint64_t xxh64_read64(const unsigned char* data) noexcept {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+#else
+            uint64_t value = 0;
+            for (int i = 7; i >= 0; --i) {
+                value = (value << 8U) | data[i];
+            }
+            return value;
+#endif
+        }
+
+        inline uint32_t xxh64_read32(const unsigned char* data) noexcept {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+#else
+            return  static_cast<uint32_t>(data[0])        |
+                   (static_cast<uint32_t>(data[1]) << 8U)  |
+                   (static_cast<uint32_t>(data[2]) << 16U) |
+                   (static_cast<uint32_t>(data[3]) << 24U);
+#endif
+        }
+
+        inline uint64_t xxh64_round(uint64_t acc, const uint64_t input) noexcept {
+            acc += input * xxh64_prime2;
+            acc = xxh64_rotl(acc, 31);
+            return acc * xxh64_prime1;
+        }
+
+        inline uint64_t xxh64_merge_round(uint64_t acc, const uint64_t value) noexcept {
+            acc ^= xxh64_round(0, value);
+            return acc * xxh64_prime1 + xxh64_prime4;
+        }
+
+    } // namespace detail
+
+    /**
+     * This class is used together with the CRC class to compute a 64 bit
+     * non-cryptographic hash of OSM data. It implements the XXH64
+     * algorithm (https://github.com/Cyan4973/xxHash), results are the same
+     * as those from the xxHash library with seed 0.
+     *
+     * Data is processed in 32 byte blocks in four independent lanes,
+     * so the CPU can work on them in parallel. Small pieces of data
+     * (as they are typical for OSM objects) are collected in a small
+     * internal buffer first. This is much faster than CRC_zlib and has
+     * fewer collisions than any 32 bit checksum, which makes it a good
+     * choice for finding changed objects.
+     *
+     * Usage:
+     *
+     * @code
+     * osmium::CRC<osmium::Hash64> hash;
+     * const osmium::Node& node = ...;
+     * hash.update(node);
+     * std::cout << hash().checksum() << '\n';
+     * @endcode
+     */
+    class Hash64 {
+
+        enum {
+            block_size = 32
+        };
+
+        uint64_t m_v1;
+        uint64_t m_v2;
+        uint64_t m_v3;
+        uint64_t m_v4;
+        uint64_t m_total = 0;
+        unsigned char m_buffer[block_size];
+        std::size_t m_buffer_size = 0;
+
+        const unsigned char* process_blocks(const unsigned char* data, const unsigned char* end) noexcept {
+            uint64_t v1 = m_v1;
+            uint64_t v2 = m_v2;
+            uint64_t v3 = m_v3;
+            uint64_t v4 = m_v4;
+            for (; data + block_size <= end; data += block_size) {
+                v1 = detail::xxh64_round(v1, detail::xxh64_read64(data));
+                v2 = detail::xxh64_round(v2, detail::xxh64_read64(data + 8));
+                v3 = detail::xxh64_round(v3, detail::xxh64_read64(data + 16));
+                v4 = detail::xxh64_round(v4, detail::xxh64_read64(data + 24));
+            }
+            m_v1 = v1;
+            m_v2 = v2;
+            m_v3 = v3;
+            m_v4 = v4;
+            return data;
+        }
+
+    public:
+
+        explicit Hash64(const uint64_t seed = 0) noexcept :
+            m_v1(seed + detail::xxh64_prime1 + detail::xxh64_prime2),
+            m_v2(seed + detail::xxh64_prime2),
+            m_v3(seed),
+            m_v4(seed - detail::xxh64_prime1),
+            m_buffer() {
+        }
+
+        void process_byte(const unsigned char byte) noexcept {
+            process_bytes(&byte, 1);
+        }
+
+        void process_bytes(const void* buffer, std::size_t byte_count) noexcept {
+            const auto* data = reinterpret_cast<const unsigned char*>(buffer);
+            const unsigned char* const end = data + byte_count;
+            m_total += byte_count;
+
+            if (m_buffer_size + byte_count < block_size) {
+                std::memcpy(m_buffer + m_buffer_size, data, byte_count);
+                m_buffer_size += byte_count;
+                return;
+            }
+
+            if (m_buffer_size > 0) {
+                const std::size_t fill = block_size - m_buffer_size;
+                std::memcpy(m_buffer + m_buffer_size, data, fill);
+                data += fill;
+                process_blocks(m_buffer, m_buffer + block_size);
+                m_buffer_size = 0;
+            }
+
+            data = process_blocks(data, end);
+
+            m_buffer_size = static_cast<std::size_t>(end - data);
+            if (m_buffer_size > 0) {
+                std::memcpy(m_buffer, data, m_buffer_size);
+            }
+        }
+
+        uint64_t checksum() const noexcept {
+            uint64_t hash;
+            if (m_total >= block_size) {
+                hash = detail::xxh64_rotl(m_v1, 1) + detail::xxh64_rotl(m_v2, 7) +
+                       detail::xxh64_rotl(m_v3, 12) + detail::xxh64_rotl(m_v4, 18);
+                hash = detail::xxh64_merge_round(hash, m_v1);
+                hash = detail::xxh64_merge_round(hash, m_v2);
+                hash = detail::xxh64_merge_round(hash, m_v3);
+                hash = detail::xxh64_merge_round(hash, m_v4);
+            } else {
+                hash = m_v3 + detail::xxh64_prime5;
+            }
+
+            hash += m_total;
+
+            const unsigned char* data = m_buffer;
+            const unsigned char* const end = m_buffer + m_buffer_size;
+            for (; data + 8 <= end; data += 8) {
+                hash ^= detail::xxh64_round(0, detail::xxh64_read64(data));
+                hash = detail::xxh64_rotl(hash, 27) * detail::xxh64_prime1 + detail::xxh64_prime4;
+            }
+            if (data + 4 <= end) {
+                hash ^= static_cast<uint64_t>(detail::xxh64_read32(data)) * detail::xxh64_prime1;
+                hash = detail::xxh64_rotl(hash, 23) * detail::xxh64_prime2 + detail::xxh64_prime3;
+                data += 4;
+            }
+            for (; data < end; ++data) {
+                hash ^= static_cast<uint64_t>(*data) * detail::xxh64_prime5;
+                hash = detail::xxh64_rotl(hash, 11) * detail::xxh64_prime1;
+            }
+
+            hash ^= hash >> 33U;
+            hash *= detail::xxh64_prime2;
+            hash ^= hash >> 29U;
+            hash *= detail::xxh64_prime3;
+            hash ^= hash >> 32U;
+
+            return hash;
+        }
+
+    }; // class Hash64
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_HASH64_HPP
@@ -51,6 +51,7 @@ namespace osmium {
         tag_list                               = 0x11,
         way_node_list                          = 0x12,
         relation_member_list                   = 0x13,
+        key_signature                          = 0x14,
         relation_member_list_with_full_members = 0x23,
         outer_ring                             = 0x40,
         inner_ring                             = 0x41,
@@ -105,6 +106,8 @@ namespace osmium {
                 return item_type::relation_member_list;
             case 'F':
                 return item_type::relation_member_list_with_full_members;
+            case 'K':
+                return item_type::key_signature;
             case 'O':
                 return item_type::outer_ring;
             case 'I':
@@ -137,6 +140,8 @@ namespace osmium {
                 return 'M';
             case item_type::relation_member_list_with_full_members:
                 return 'F';
+            case item_type::key_signature:
+                return 'K';
             case item_type::outer_ring:
                 return 'O';
             case item_type::inner_ring:
@@ -169,6 +174,8 @@ namespace osmium {
                 return "relation_member_list";
             case item_type::relation_member_list_with_full_members:
                 return "relation_member_list_with_full_members";
+            case item_type::key_signature:
+                return "key_signature";
             case item_type::outer_ring:
                 return "outer_ring";
             case item_type::inner_ring:
@@ -0,0 +1,159 @@
+#ifndef OSMIUM_OSM_KEY_SIGNATURE_HPP
+#define OSMIUM_OSM_KEY_SIGNATURE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace osmium {
+
+    /**
+     * A small Bloom filter over the keys of the tags of an OSM object.
+     *
+     * If present, it is stored as the first subitem of the object, before
+     * the WayNodeList, RelationMemberList, and TagList. It allows a quick
+     * check whether an object can possibly have a tag with some key
+     * without scanning the TagList. False positives are possible, false
+     * negatives are not, so if may_have_key() returns true you still have
+     * to look at the tags.
+     *
+     * Each key sets two of the 64 bits. Compute the bits for a key once
+     * with key_bits() and reuse them for all objects.
+     *
+     * Signatures are only added by the input formats that support them
+     * (currently PBF) when the osmium::io::add_key_signatures::yes option
+     * is given to the Reader. Code modifying the tags of an object must
+     * drop or recalculate the signature.
+     */
+    class KeySignature : public osmium::memory::Item {
+
+        uint64_t m_bits;
+
+    public:
+
+        static constexpr osmium::item_type itemtype = osmium::item_type::key_signature;
+
+        constexpr static bool is_compatible_to(osmium::item_type t) noexcept {
+            return t == itemtype;
+        }
+
+        /**
+         * Get the bits for a key of the given length. Uses the 64 bit
+         * FNV-1a hash, the low and high halves select one bit each.
+         */
+        static uint64_t key_bits(const char* key, std::size_t length) noexcept {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (std::size_t i = 0; i < length; ++i) {
+                hash ^= static_cast<unsigned char>(key[i]);
+                hash *= 0x100000001b3ULL;
+            }
+            return (1ULL << (hash & 63U)) | (1ULL << ((hash >> 32U) & 63U));
+        }
+
+        /// Get the bits for a zero-terminated key.
+        static uint64_t key_bits(const char* key) noexcept {
+            return key_bits(key, std::strlen(key));
+        }
+
+        /// Get the signature bits for all keys in a TagList.
+        static uint64_t tags_bits(const osmium::TagList& tags) noexcept {
+            uint64_t bits = 0;
+            for (const auto& tag : tags) {
+                bits |= key_bits(tag.key());
+            }
+            return bits;
+        }
+
+        explicit KeySignature(uint64_t bits = 0) noexcept :
+            Item(sizeof(KeySignature), itemtype),
+            m_bits(bits) {
+        }
+
+        /// The signature bits.
+        uint64_t bits() const noexcept {
+            return m_bits;
+        }
+
+        /**
+         * Can the object have a tag with a key with the given bits (as
+         * returned by key_bits())?
+         */
+        bool may_have_key(uint64_t key_bits) const noexcept {
+            return (m_bits & key_bits) == key_bits;
+        }
+
+    }; // class KeySignature
+
+    static_assert(sizeof(KeySignature) % osmium::memory::align_bytes == 0, "Class osmium::KeySignature has wrong size to be aligned properly!");
+
+    /**
+     * Get the key signature of an object. Returns nullptr if the object
+     * has none.
+     */
+    inline const KeySignature* get_key_signature(const osmium::OSMObject& object) noexcept {
+        const auto it = object.cbegin();
+        if (it != object.cend() && it->type() == item_type::key_signature) {
+            return reinterpret_cast<const KeySignature*>(&*it);
+        }
+        return nullptr;
+    }
+
+    /**
+     * Can this object have a tag with a key with the given bits (as
+     * returned by KeySignature::key_bits())? Always returns true if the
+     * object has no key signature.
+     */
+    inline bool may_have_key(const osmium::OSMObject& object, uint64_t key_bits) noexcept {
+        const KeySignature* signature = get_key_signature(object);
+        return !signature || signature->may_have_key(key_bits);
+    }
+
+    /**
+     * Can this object have a tag with the given key? Always returns true
+     * if the object has no key signature.
+     */
+    inline bool may_have_key(const osmium::OSMObject& object, const char* key) noexcept {
+        const KeySignature* signature = get_key_signature(object);
+        return !signature || signature->may_have_key(KeySignature::key_bits(key));
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_KEY_SIGNATURE_HPP
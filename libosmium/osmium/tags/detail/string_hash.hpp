@@ -0,0 +1,78 @@
+#ifndef OSMIUM_TAGS_DETAIL_STRING_HASH_HPP
+#define OSMIUM_TAGS_DETAIL_STRING_HASH_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstring>
+
+namespace osmium {
+
+    namespace tags {
+
+        namespace detail {
+
+            /**
+             * Hash function for null terminated strings, used as hash in
+             * hash tables with const char* keys.
+             */
+            struct str_hash {
+
+                std::size_t operator()(const char* str) const noexcept {
+                    std::size_t hash = 5381;
+                    int c;
+
+                    while ((c = *str++)) {
+                        hash = ((hash << 5U) + hash) + c; /* hash * 33 + c */
+                    }
+
+                    return hash;
+                }
+
+            }; // struct str_hash
+
+            struct str_equal {
+
+                bool operator()(const char* lhs, const char* rhs) const noexcept {
+                    return lhs == rhs || std::strcmp(lhs, rhs) == 0;
+                }
+
+            }; // struct str_equal
+
+        } // namespace detail
+
+    } // namespace tags
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_DETAIL_STRING_HASH_HPP
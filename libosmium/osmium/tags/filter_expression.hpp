@@ -0,0 +1,724 @@
+#ifndef OSMIUM_TAGS_FILTER_EXPRESSION_HPP
+#define OSMIUM_TAGS_FILTER_EXPRESSION_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/pushdown_filter.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/key_signature.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/tags/matcher.hpp>
+#include <osmium/util/compatibility.hpp>
+#include <osmium/util/string_matcher.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a filter expression can not be parsed.
+     */
+    struct filter_expression_error : public std::runtime_error {
+
+        std::size_t position;
+
+        filter_expression_error(const std::string& what, std::size_t pos) :
+            std::runtime_error(std::string{"filter expression error: "} + what + " at position " + std::to_string(pos)),
+            position(pos) {
+        }
+
+    }; // struct filter_expression_error
+
+    namespace tags {
+
+        /**
+         * A filter for OSM objects described by a small expression
+         * language. The expression is parsed once into a tree of
+         * TagMatchers, type and bounding box checks, which is then used to
+         * check objects. It can also be turned into a PushdownFilter for
+         * the Reader, so input formats supporting that don't even build
+         * most of the objects not matching.
+         *
+         * Grammar:
+         *
+         * * `EXPR and EXPR`, `EXPR or EXPR`, `not EXPR`, `( EXPR )`: The
+         *   usual boolean operators, "not" binds tighter than "and" which
+         *   binds tighter than "or".
+         * * `[TYPES/]KEY`: Objects having a tag with this key.
+         * * `[TYPES/]KEY=VALUE[,VALUE...]`: Objects having a tag with this
+         *   key and one of the values.
+         * * `[TYPES/]KEY!=VALUE[,VALUE...]`: Objects having a tag with this
+         *   key and a value that is none of the values.
+         * * `TYPES/`: Objects of these types.
+         * * `bbox(MINLON,MINLAT,MAXLON,MAXLAT)`: Nodes inside this box.
+         *   Ways, relations, and areas always match, because their
+         *   locations are not known when reading them.
+         *
+         * TYPES is any combination of the letters n (node), w (way), r
+         * (relation), and a (area). Without TYPES, objects of all these
+         * types are checked. Keys and values can end in a `*` to match
+         * all strings with that prefix or can start and end with `*` to
+         * match all strings containing the text in between. A `*` alone
+         * matches anything. Strings in double quotes (with backslash
+         * escapes for `"` and `\`) are matched exactly, use them for
+         * strings containing spaces or any of `=!,()"*` and for keys named
+         * like the keywords "and", "or", "not".
+         *
+         * Exact keys are checked against the KeySignature of an object
+         * first if there is one. The "and" and "or" operands are
+         * reordered so that the cheap type and bbox checks are done first.
+         *
+         * @code
+         * osmium::tags::FilterExpression expr{"w/highway=primary,secondary and not w/access=no"};
+         * osmium::io::Reader reader{"input.osm.pbf", expr.pushdown()};
+         * while (osmium::memory::Buffer buffer = reader.read()) {
+         *     for (const auto& object : buffer.select<osmium::OSMObject>()) {
+         *         if (expr(object)) {
+         *             ...
+         *         }
+         *     }
+         * }
+         * @endcode
+         */
+        class FilterExpression {
+
+            enum class node_kind : unsigned char {
+                types  = 0,
+                bbox   = 1,
+                tags   = 2,
+                negate = 3,
+                all_of = 4,
+                any_of = 5
+            };
+
+            struct expr_node {
+
+                node_kind kind;
+                osmium::osm_entity_bits::type types = osmium::osm_entity_bits::nwra;
+
+                // operands of negate, all_of, and any_of
+                std::vector<std::size_t> children{};
+
+                // tags: the value matchers are empty if only the key is
+                // checked, if invert is set there is exactly one
+                osmium::StringMatcher key{};
+                std::vector<osmium::StringMatcher> values{};
+                bool invert = false;
+                uint64_t key_bits = 0; // only set for exact keys
+                std::vector<osmium::TagMatcher> matchers{};
+
+                osmium::Box box{};
+
+                explicit expr_node(const node_kind k) :
+                    kind(k) {
+                }
+
+            }; // struct expr_node
+
+            // Approximation of a subexpression for one object type used
+            // when building the PushdownFilter. It matches none or all of
+            // the objects or those having a tag matching any of the tag
+            // nodes in atoms. If exact is not set, the approximation can
+            // match more objects than the subexpression (never less).
+            struct approximation {
+
+                enum kind_type : unsigned char {
+                    none,
+                    all,
+                    tags
+                };
+
+                kind_type kind;
+                bool exact;
+                std::vector<std::size_t> atoms;
+
+                explicit approximation(const kind_type k = none, const bool e = true) :
+                    kind(k),
+                    exact(e),
+                    atoms() {
+                }
+
+            }; // struct approximation
+
+            using type_approximations = std::array<approximation, 4>;
+
+            std::string m_expression;
+            std::vector<expr_node> m_nodes;
+            std::size_t m_root = 0;
+
+            OSMIUM_NORETURN void error(const std::string& what, const char* s) const {
+                throw filter_expression_error{what, static_cast<std::size_t>(s - m_expression.c_str())};
+            }
+
+            static bool is_space(const char c) noexcept {
+                return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+            }
+
+            static bool is_special(const char c) noexcept {
+                return c == '\0' || is_space(c) || std::strchr("=!,()\"", c) != nullptr;
+            }
+
+            static void skip_space(const char** s) noexcept {
+                while (is_space(**s)) {
+                    ++*s;
+                }
+            }
+
+            static bool at_end_of_operand(const char* s) noexcept {
+                return *s == '\0' || *s == ')' || is_space(*s);
+            }
+
+            // Consume the keyword if it is next in the input.
+            static bool keyword(const char** s, const char* word) noexcept {
+                const auto len = std::strlen(word);
+                if (std::strncmp(*s, word, len) != 0) {
+                    return false;
+                }
+                const char c = (*s)[len];
+                if (c != '\0' && c != '(' && !is_space(c)) {
+                    return false;
+                }
+                *s += len;
+                return true;
+            }
+
+            std::size_t add_node(expr_node&& node) {
+                m_nodes.push_back(std::move(node));
+                return m_nodes.size() - 1;
+            }
+
+            // Cheap checks first, the relative order of the other
+            // operands is kept.
+            std::size_t add_operator(const node_kind kind, std::vector<std::size_t>&& children) {
+                if (children.size() == 1) {
+                    return children.front();
+                }
+                std::stable_sort(children.begin(), children.end(), [this](const std::size_t a, const std::size_t b) {
+                    return m_nodes[a].kind < m_nodes[b].kind;
+                });
+                expr_node node{kind};
+                node.children = std::move(children);
+                return add_node(std::move(node));
+            }
+
+            std::string parse_string(const char** s, bool* quoted) const {
+                std::string str;
+                *quoted = (**s == '"');
+                if (*quoted) {
+                    const char* start = *s;
+                    ++*s;
+                    while (**s != '"') {
+                        if (**s == '\0') {
+                            error("unterminated string", start);
+                        }
+                        if (**s == '\\' && (*s)[1] != '\0') {
+                            ++*s;
+                        }
+                        str += **s;
+                        ++*s;
+                    }
+                    ++*s;
+                    return str;
+                }
+
+                while (!is_special(**s)) {
+                    str += **s;
+                    ++*s;
+                }
+                if (str.empty()) {
+                    error("expected string", *s);
+                }
+                return str;
+            }
+
+            // Parse a string into a StringMatcher. If the matcher only
+            // matches this one string, exact is set to true and str is
+            // set to the string.
+            osmium::StringMatcher parse_matcher(const char** s, bool* exact, std::string* str_out) const {
+                const char* start = *s;
+                bool quoted = false;
+                std::string str = parse_string(s, &quoted);
+                *exact = quoted || str.find('*') == std::string::npos;
+                if (*exact) {
+                    *str_out = str;
+                    return osmium::StringMatcher::equal{std::move(str)};
+                }
+
+                if (str == "*") {
+                    return osmium::StringMatcher::always_true{};
+                }
+                const bool leading = str.front() == '*';
+                const bool trailing = str.back() == '*';
+                str = str.substr(leading ? 1 : 0, str.size() - (leading ? 1 : 0) - (trailing ? 1 : 0));
+                if (!trailing || str.find('*') != std::string::npos) {
+                    error("'*' is only allowed at the end or at both ends of a string", start);
+                }
+                if (leading) {
+                    return osmium::StringMatcher::substring{str};
+                }
+                return osmium::StringMatcher::prefix{str};
+            }
+
+            std::size_t parse_tag_test(const char** s, const osmium::osm_entity_bits::type types) {
+                expr_node node{node_kind::tags};
+                node.types = types;
+
+                bool exact = false;
+                std::string str;
+                node.key = parse_matcher(s, &exact, &str);
+                if (exact) {
+                    node.key_bits = osmium::KeySignature::key_bits(str.c_str(), str.size());
+                }
+
+                if (**s == '!' && (*s)[1] == '=') {
+                    node.invert = true;
+                    ++*s;
+                } else if (**s != '=') {
+                    if (!at_end_of_operand(*s)) {
+                        error("expected '=', '!=', or end of tag test", *s);
+                    }
+                    node.matchers.emplace_back(node.key);
+                    return add_node(std::move(node));
+                }
+                ++*s;
+
+                // All exact values go into one list matcher.
+                const char* values_start = *s;
+                std::vector<std::string> exact_values;
+                while (true) {
+                    osmium::StringMatcher matcher = parse_matcher(s, &exact, &str);
+                    if (exact) {
+                        exact_values.push_back(std::move(str));
+                    } else {
+                        node.values.push_back(std::move(matcher));
+                    }
+                    if (**s != ',') {
+                        break;
+                    }
+                    ++*s;
+                }
+                if (!at_end_of_operand(*s)) {
+                    error("expected ',' or end of tag test", *s);
+                }
+
+                if (exact_values.size() == 1) {
+                    node.values.emplace_back(osmium::StringMatcher::equal{exact_values.front()});
+                } else if (!exact_values.empty()) {
+                    node.values.emplace_back(osmium::StringMatcher::list{std::move(exact_values)});
+                }
+
+                if (node.invert && node.values.size() > 1) {
+                    error("'!=' with several values can't contain wildcards", values_start);
+                }
+
+                for (const auto& value : node.values) {
+                    node.matchers.emplace_back(node.key, value, node.invert);
+                }
+
+                return add_node(std::move(node));
+            }
+
+            std::size_t parse_bbox(const char** s) {
+                const char* start = *s;
+                std::array<int32_t, 4> coordinates;
+                for (std::size_t i = 0; i < coordinates.size(); ++i) {
+                    skip_space(s);
+                    try {
+                        coordinates[i] = osmium::detail::string_to_location_coordinate(s);
+                    } catch (const osmium::invalid_location&) {
+                        error("expected coordinate", *s);
+                    }
+                    skip_space(s);
+                    if (**s != (i == coordinates.size() - 1 ? ')' : ',')) {
+                        error(i == coordinates.size() - 1 ? "expected ')'" : "expected ','", *s);
+                    }
+                    ++*s;
+                }
+
+                const osmium::Location bottom_left{coordinates[0], coordinates[1]};
+                const osmium::Location top_right{coordinates[2], coordinates[3]};
+                if (!bottom_left.valid() || !top_right.valid() ||
+                    coordinates[0] > coordinates[2] || coordinates[1] > coordinates[3]) {
+                    error("invalid bounding box", start);
+                }
+
+                expr_node node{node_kind::bbox};
+                node.box = osmium::Box{bottom_left, top_right};
+                return add_node(std::move(node));
+            }
+
+            std::size_t parse_operand(const char** s) {
+                skip_space(s);
+
+                if (keyword(s, "not")) {
+                    expr_node node{node_kind::negate};
+                    node.children.push_back(parse_operand(s));
+                    return add_node(std::move(node));
+                }
+
+                if (**s == '(') {
+                    ++*s;
+                    const std::size_t index = parse_or(s);
+                    skip_space(s);
+                    if (**s != ')') {
+                        error("expected ')'", *s);
+                    }
+                    ++*s;
+                    return index;
+                }
+
+                if (!std::strncmp(*s, "bbox(", 5)) {
+                    *s += 5;
+                    return parse_bbox(s);
+                }
+
+                // optional types followed by a slash
+                osmium::osm_entity_bits::type types = osmium::osm_entity_bits::nothing;
+                const char* p = *s;
+                for (; *p != '\0'; ++p) {
+                    const char* letter = std::strchr("nwra", *p);
+                    if (!letter) {
+                        break;
+                    }
+                    types |= static_cast<osmium::osm_entity_bits::type>(1U << static_cast<unsigned>(letter - "nwra"));
+                }
+                if (p != *s && *p == '/') {
+                    *s = p + 1;
+                    if (at_end_of_operand(*s)) {
+                        expr_node node{node_kind::types};
+                        node.types = types;
+                        return add_node(std::move(node));
+                    }
+                    return parse_tag_test(s, types);
+                }
+
+                if (at_end_of_operand(*s)) {
+                    error("expected tag test", *s);
+                }
+                return parse_tag_test(s, osmium::osm_entity_bits::nwra);
+            }
+
+            std::size_t parse_and(const char** s) {
+                std::vector<std::size_t> children;
+                children.push_back(parse_operand(s));
+                while (skip_space(s), keyword(s, "and")) {
+                    children.push_back(parse_operand(s));
+                }
+                return add_operator(node_kind::all_of, std::move(children));
+            }
+
+            std::size_t parse_or(const char** s) {
+                std::vector<std::size_t> children;
+                children.push_back(parse_and(s));
+                while (skip_space(s), keyword(s, "or")) {
+                    children.push_back(parse_and(s));
+                }
+                return add_operator(node_kind::any_of, std::move(children));
+            }
+
+            bool evaluate(const std::size_t index, const osmium::OSMObject& object, const osmium::osm_entity_bits::type type) const {
+                const expr_node& node = m_nodes[index];
+                switch (node.kind) {
+                    case node_kind::types:
+                        return (node.types & type) != 0;
+                    case node_kind::bbox: {
+                            if (type != osmium::osm_entity_bits::node) {
+                                return true;
+                            }
+                            const auto location = static_cast<const osmium::Node&>(object).location();
+                            return location.valid() && node.box.contains(location);
+                        }
+                    case node_kind::tags:
+                        if (!(node.types & type)) {
+                            return false;
+                        }
+                        if (node.key_bits && !osmium::may_have_key(object, node.key_bits)) {
+                            return false;
+                        }
+                        for (const auto& matcher : node.matchers) {
+                            if (matcher(object.tags())) {
+                                return true;
+                            }
+                        }
+                        return false;
+                    case node_kind::negate:
+                        return !evaluate(node.children.front(), object, type);
+                    case node_kind::all_of:
+                        for (const auto child : node.children) {
+                            if (!evaluate(child, object, type)) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    case node_kind::any_of:
+                        for (const auto child : node.children) {
+                            if (evaluate(child, object, type)) {
+                                return true;
+                            }
+                        }
+                        return false;
+                }
+                return false;
+            }
+
+            static approximation approximate_or(approximation&& a, approximation&& b) {
+                if (a.kind == approximation::none) {
+                    return std::move(b);
+                }
+                if (b.kind == approximation::none) {
+                    return std::move(a);
+                }
+                if (a.kind == approximation::all || b.kind == approximation::all) {
+                    return approximation{approximation::all, (a.kind == approximation::all && a.exact) ||
+                                                             (b.kind == approximation::all && b.exact)};
+                }
+                a.exact = a.exact && b.exact;
+                a.atoms.insert(a.atoms.end(), b.atoms.begin(), b.atoms.end());
+                return std::move(a);
+            }
+
+            static approximation approximate_and(approximation&& a, approximation&& b) {
+                if (a.kind == approximation::none || b.kind == approximation::none) {
+                    return approximation{};
+                }
+                if (a.kind == approximation::all) {
+                    b.exact = b.exact && a.exact;
+                    return std::move(b);
+                }
+                if (b.kind == approximation::all) {
+                    a.exact = a.exact && b.exact;
+                    return std::move(a);
+                }
+                // Both need some tag, use the shorter list of them.
+                approximation& result = a.atoms.size() <= b.atoms.size() ? a : b;
+                result.exact = false;
+                return std::move(result);
+            }
+
+            static approximation approximate_not(const approximation& a) {
+                if (a.exact && a.kind == approximation::none) {
+                    return approximation{approximation::all, true};
+                }
+                if (a.exact && a.kind == approximation::all) {
+                    return approximation{};
+                }
+                return approximation{approximation::all, false};
+            }
+
+            type_approximations approximate(const std::size_t index) const {
+                const expr_node& node = m_nodes[index];
+                type_approximations result;
+                switch (node.kind) {
+                    case node_kind::types:
+                    case node_kind::tags:
+                        for (std::size_t t = 0; t < result.size(); ++t) {
+                            if (node.types & (1U << t)) {
+                                result[t] = approximation{node.kind == node_kind::types ? approximation::all : approximation::tags, true};
+                                if (node.kind == node_kind::tags) {
+                                    result[t].atoms.push_back(index);
+                                }
+                            }
+                        }
+                        break;
+                    case node_kind::bbox:
+                        // handled in pushdown() if it is on the top level
+                        result[0] = approximation{approximation::all, false};
+                        for (std::size_t t = 1; t < result.size(); ++t) {
+                            result[t] = approximation{approximation::all, true};
+                        }
+                        break;
+                    case node_kind::negate: {
+                            const type_approximations child = approximate(node.children.front());
+                            for (std::size_t t = 0; t < result.size(); ++t) {
+                                result[t] = approximate_not(child[t]);
+                            }
+                        }
+                        break;
+                    case node_kind::all_of:
+                    case node_kind::any_of:
+                        result = approximate(node.children.front());
+                        for (std::size_t i = 1; i < node.children.size(); ++i) {
+                            type_approximations child = approximate(node.children[i]);
+                            for (std::size_t t = 0; t < result.size(); ++t) {
+                                result[t] = node.kind == node_kind::all_of ? approximate_and(std::move(result[t]), std::move(child[t]))
+                                                                           : approximate_or(std::move(result[t]), std::move(child[t]));
+                            }
+                        }
+                        break;
+                }
+                return result;
+            }
+
+            static std::size_t number_of_rules(const expr_node& node) noexcept {
+                return node.values.empty() ? 1 : node.values.size();
+            }
+
+        public:
+
+            /**
+             * Parse a filter expression.
+             *
+             * @throws osmium::filter_expression_error If the expression
+             *         can not be parsed.
+             */
+            explicit FilterExpression(const std::string& expression) :
+                m_expression(expression),
+                m_nodes() {
+                const char* s = m_expression.c_str();
+                m_root = parse_or(&s);
+                skip_space(&s);
+                if (*s != '\0') {
+                    error("unexpected input", s);
+                }
+            }
+
+            explicit FilterExpression(const char* expression) :
+                FilterExpression(std::string{expression}) {
+            }
+
+            /// The expression this filter was created from.
+            const std::string& expression() const noexcept {
+                return m_expression;
+            }
+
+            /**
+             * Check an object against this filter expression.
+             */
+            bool operator()(const osmium::OSMObject& object) const {
+                return evaluate(m_root, object, osmium::osm_entity_bits::from_item_type(object.type()));
+            }
+
+            /**
+             * The types of objects that can possibly match. Use this as
+             * the entities option to the Reader if you don't use the
+             * pushdown() filter, which contains the same information.
+             */
+            osmium::osm_entity_bits::type entities() const {
+                const type_approximations approx = approximate(m_root);
+                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nothing;
+                for (std::size_t t = 0; t < approx.size(); ++t) {
+                    if (approx[t].kind != approximation::none) {
+                        entities |= static_cast<osmium::osm_entity_bits::type>(1U << t);
+                    }
+                }
+                return entities;
+            }
+
+            /**
+             * Build a PushdownFilter from this expression. It keeps all
+             * objects matching the expression but, depending on the
+             * expression, possibly some more, because it can only
+             * express checks of the form "object of one of these types
+             * with any tag matching one of these rules". Always check
+             * the objects you get from the Reader with this filter
+             * expression.
+             */
+            osmium::io::PushdownFilter pushdown() const {
+                const type_approximations approx = approximate(m_root);
+
+                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nothing;
+                osmium::osm_entity_bits::type tagged_types = osmium::osm_entity_bits::nothing;
+                std::vector<std::size_t> atoms;
+                for (std::size_t t = 0; t < approx.size(); ++t) {
+                    const auto bit = static_cast<osmium::osm_entity_bits::type>(1U << t);
+                    if (approx[t].kind != approximation::none) {
+                        entities |= bit;
+                    }
+                    if (approx[t].kind == approximation::tags) {
+                        tagged_types |= bit;
+                        for (const auto atom : approx[t].atoms) {
+                            if (std::find(atoms.begin(), atoms.end(), atom) == atoms.end()) {
+                                atoms.push_back(atom);
+                            }
+                        }
+                    }
+                }
+
+                osmium::io::PushdownFilter filter;
+                filter.set_entities(entities);
+
+                std::size_t rules = 0;
+                for (const auto atom : atoms) {
+                    rules += number_of_rules(m_nodes[atom]);
+                }
+                if (rules <= osmium::io::PushdownFilter::max_rules) {
+                    filter.set_tagged_types(tagged_types);
+                    for (const auto atom : atoms) {
+                        const expr_node& node = m_nodes[atom];
+                        if (node.values.empty()) {
+                            filter.add_rule(true, node.key);
+                        }
+                        for (const auto& value : node.values) {
+                            filter.add_rule(true, node.key, value, node.invert);
+                        }
+                    }
+                } else {
+                    // Too many rules, don't check tags while reading.
+                    filter.set_tagged_types(osmium::osm_entity_bits::nothing);
+                }
+
+                const expr_node& root = m_nodes[m_root];
+                if (root.kind == node_kind::bbox) {
+                    filter.set_bbox(root.box);
+                } else if (root.kind == node_kind::all_of) {
+                    for (const auto child : root.children) {
+                        if (m_nodes[child].kind == node_kind::bbox) {
+                            filter.set_bbox(m_nodes[child].box);
+                            break;
+                        }
+                    }
+                }
+
+                return filter;
+            }
+
+        }; // class FilterExpression
+
+    } // namespace tags
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_FILTER_EXPRESSION_HPP
@@ -0,0 +1,474 @@
+#ifndef OSMIUM_TAGS_TAG_REWRITER_HPP
+#define OSMIUM_TAGS_TAG_REWRITER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/entity.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/key_signature.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/tags/detail/string_hash.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/string_matcher.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace tags {
+
+        /**
+         * Rewrites tags of OSM objects according to a set of rules:
+         *
+         * * remove_key(): Remove tags with this key.
+         * * remove_keys(): Remove tags with keys matching a StringMatcher.
+         * * rename_key(): Change the key of tags, keep the value.
+         * * replace_tag(): Replace a tag with a specific key and value by
+         *   another tag.
+         * * add_tag(): Add a tag to all objects of some types that don't
+         *   have a tag with that key (after the other rules were applied).
+         *
+         * For each tag the rules for its exact key are checked first
+         * (replace_tag, then remove_key, then rename_key), the
+         * remove_keys() matchers only for tags not affected by those. Rules
+         * are stored in a hash table indexed by key when they are added,
+         * so checking a tag needs only one lookup.
+         *
+         * Objects not changed by any rule are copied into the output
+         * buffer as they are, only the others are rebuilt. The rewriter
+         * doesn't check whether rules create duplicate keys. The
+         * KeySignature of rebuilt objects is recalculated.
+         *
+         * @code
+         * osmium::tags::TagRewriter rewriter;
+         * rewriter.remove_key("created_by")
+         *         .replace_tag("landuse", "forest", "natural", "wood");
+         *
+         * osmium::memory::Buffer output = rewriter(input);
+         * @endcode
+         */
+        class TagRewriter {
+
+            struct key_rules {
+                // value -> replacement tag
+                std::unordered_map<std::string, std::pair<std::string, std::string>> replace;
+                std::string rename_to;
+                bool remove = false;
+                bool rename = false;
+            }; // struct key_rules
+
+            struct add_rule {
+                std::string key;
+                std::string value;
+                osmium::osm_entity_bits::type entities;
+            }; // struct add_rule
+
+            // The keys of m_rules point to strings in m_keys.
+            std::deque<std::string> m_keys;
+            std::unordered_map<const char*, key_rules, detail::str_hash, detail::str_equal> m_rules;
+            std::vector<osmium::StringMatcher> m_remove_matchers;
+            std::vector<add_rule> m_add_rules;
+
+            key_rules& rules_for(const std::string& key) {
+                const auto it = m_rules.find(key.c_str());
+                if (it != m_rules.end()) {
+                    return it->second;
+                }
+                m_keys.push_back(key);
+                return m_rules[m_keys.back().c_str()];
+            }
+
+            const key_rules* find_rules(const char* key) const {
+                const auto it = m_rules.find(key);
+                return it == m_rules.end() ? nullptr : &it->second;
+            }
+
+            bool matches_remove_matcher(const char* key) const noexcept {
+                for (const auto& matcher : m_remove_matchers) {
+                    if (matcher(key)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Get the key and value the tag will have after rewriting.
+            // Returns false if the tag is removed.
+            bool rewrite_tag(const osmium::Tag& tag, const char** key, const char** value) const {
+                const key_rules* rules = find_rules(tag.key());
+                if (rules) {
+                    if (!rules->replace.empty()) {
+                        const auto it = rules->replace.find(tag.value());
+                        if (it != rules->replace.end()) {
+                            *key = it->second.first.c_str();
+                            *value = it->second.second.c_str();
+                            return true;
+                        }
+                    }
+                    if (rules->remove) {
+                        return false;
+                    }
+                    *key = rules->rename ? rules->rename_to.c_str() : tag.key();
+                    *value = tag.value();
+                    return true;
+                }
+
+                if (matches_remove_matcher(tag.key())) {
+                    return false;
+                }
+
+                *key = tag.key();
+                *value = tag.value();
+                return true;
+            }
+
+            bool has_key_after_rewrite(const osmium::TagList& tags, const std::string& key) const {
+                const char* k = nullptr;
+                const char* v = nullptr;
+                for (const auto& tag : tags) {
+                    if (rewrite_tag(tag, &k, &v) && key == k) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // The KeySignature bits for the tags the object will have after
+            // rewriting.
+            uint64_t key_bits_after_rewrite(const osmium::OSMObject& object) const {
+                uint64_t bits = 0;
+                const char* key = nullptr;
+                const char* value = nullptr;
+                for (const auto& tag : object.tags()) {
+                    if (rewrite_tag(tag, &key, &value)) {
+                        bits |= osmium::KeySignature::key_bits(key);
+                    }
+                }
+
+                const auto type = osmium::osm_entity_bits::from_item_type(object.type());
+                for (const auto& rule : m_add_rules) {
+                    if (rule.entities & type) {
+                        bits |= osmium::KeySignature::key_bits(rule.key.c_str());
+                    }
+                }
+                return bits;
+            }
+
+            void write_tags(osmium::builder::Builder& parent, const osmium::OSMObject& object) const {
+                osmium::builder::TagListBuilder builder{parent};
+
+                const char* key = nullptr;
+                const char* value = nullptr;
+                for (const auto& tag : object.tags()) {
+                    if (rewrite_tag(tag, &key, &value)) {
+                        builder.add_tag(key, value);
+                    }
+                }
+
+                const auto type = osmium::osm_entity_bits::from_item_type(object.type());
+                for (const auto& rule : m_add_rules) {
+                    if ((rule.entities & type) && !has_key_after_rewrite(object.tags(), rule.key)) {
+                        builder.add_tag(rule.key, rule.value);
+                    }
+                }
+            }
+
+            template <typename TBuilder>
+            static void copy_attributes(TBuilder& builder, const osmium::OSMObject& object) {
+                builder.set_id(object.id())
+                    .set_version(object.version())
+                    .set_changeset(object.changeset())
+                    .set_timestamp(object.timestamp())
+                    .set_uid(object.uid())
+                    .set_visible(object.visible())
+                    .set_user(object.user());
+            }
+
+            template <typename TBuilder>
+            void rebuild_subitems(TBuilder& builder, const osmium::OSMObject& object) const {
+                bool has_tags = false;
+                for (const auto& item : object) {
+                    if (item.type() == osmium::item_type::tag_list) {
+                        write_tags(builder, object);
+                        has_tags = true;
+                    } else if (item.type() == osmium::item_type::key_signature) {
+                        builder.add_item(osmium::KeySignature{key_bits_after_rewrite(object)});
+                    } else {
+                        builder.add_item(item);
+                    }
+                }
+                if (!has_tags) {
+                    write_tags(builder, object);
+                }
+            }
+
+            void rebuild(const osmium::OSMObject& object, osmium::memory::Buffer& buffer) const {
+                switch (object.type()) {
+                    case osmium::item_type::node: {
+                            osmium::builder::NodeBuilder builder{buffer};
+                            copy_attributes(builder, object);
+                            builder.set_location(static_cast<const osmium::Node&>(object).location());
+                            rebuild_subitems(builder, object);
+                        }
+                        break;
+                    case osmium::item_type::way: {
+                            osmium::builder::WayBuilder builder{buffer};
+                            copy_attributes(builder, object);
+                            rebuild_subitems(builder, object);
+                        }
+                        break;
+                    case osmium::item_type::relation: {
+                            osmium::builder::RelationBuilder builder{buffer};
+                            copy_attributes(builder, object);
+                            rebuild_subitems(builder, object);
+                        }
+                        break;
+                    default: { // osmium::item_type::area
+                            osmium::builder::AreaBuilder builder{buffer};
+                            copy_attributes(builder, object);
+                            rebuild_subitems(builder, object);
+                        }
+                        break;
+                }
+            }
+
+        public:
+
+            TagRewriter() = default;
+
+            /**
+             * Remove all tags with the specified key.
+             */
+            TagRewriter& remove_key(const std::string& key) {
+                rules_for(key).remove = true;
+                return *this;
+            }
+
+            /**
+             * Remove all tags with keys matching the StringMatcher.
+             */
+            TagRewriter& remove_keys(osmium::StringMatcher matcher) {
+                m_remove_matchers.push_back(std::move(matcher));
+                return *this;
+            }
+
+            /**
+             * Change the key of all tags with key "from" to "to".
+             */
+            TagRewriter& rename_key(const std::string& from, const std::string& to) {
+                auto& rules = rules_for(from);
+                rules.rename = true;
+                rules.rename_to = to;
+                return *this;
+            }
+
+            /**
+             * Replace the tag key=value by new_key=new_value.
+             */
+            TagRewriter& replace_tag(const std::string& key, const std::string& value, const std::string& new_key, const std::string& new_value) {
+                rules_for(key).replace[value] = std::make_pair(new_key, new_value);
+                return *this;
+            }
+
+            /**
+             * Add the tag key=value to all objects of the specified types
+             * that don't have this key.
+             */
+            TagRewriter& add_tag(const std::string& key, const std::string& value, const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nwr) {
+                m_add_rules.push_back(add_rule{key, value, entities});
+                return *this;
+            }
+
+            /**
+             * Are there no rules in this rewriter?
+             */
+            bool empty() const noexcept {
+                return m_rules.empty() && m_remove_matchers.empty() && m_add_rules.empty();
+            }
+
+            /**
+             * Will the rules change the tags of this object? Rules that
+             * don't apply to the actual tags (like a replace_tag() rule
+             * for another value) don't count.
+             */
+            bool changes(const osmium::OSMObject& object) const {
+                const char* key = nullptr;
+                const char* value = nullptr;
+                for (const auto& tag : object.tags()) {
+                    if (!rewrite_tag(tag, &key, &value)) {
+                        return true;
+                    }
+                    if ((key != tag.key() && std::strcmp(key, tag.key())) ||
+                        (value != tag.value() && std::strcmp(value, tag.value()))) {
+                        return true;
+                    }
+                }
+
+                const auto type = osmium::osm_entity_bits::from_item_type(object.type());
+                for (const auto& rule : m_add_rules) {
+                    if ((rule.entities & type) && !object.tags().has_key(rule.key.c_str())) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            /**
+             * Add a (possibly rewritten) copy of the object to the buffer
+             * and commit it.
+             */
+            void rewrite(const osmium::OSMObject& object, osmium::memory::Buffer& buffer) const {
+                if (changes(object)) {
+                    rebuild(object, buffer);
+                } else {
+                    buffer.add_item(object);
+                }
+                buffer.commit();
+            }
+
+            /**
+             * Rewrite all objects in the input buffer. Other entities (ie.
+             * changesets) are copied unchanged.
+             *
+             * @returns New buffer with the same items in the same order.
+             */
+            osmium::memory::Buffer operator()(const osmium::memory::Buffer& input) const {
+                osmium::memory::Buffer output{input.committed() + 1024, osmium::memory::Buffer::auto_grow::yes};
+
+                for (const auto& entity : input) {
+                    switch (entity.type()) {
+                        case osmium::item_type::node:
+                        case osmium::item_type::way:
+                        case osmium::item_type::relation:
+                        case osmium::item_type::area:
+                            rewrite(static_cast<const osmium::OSMObject&>(entity), output);
+                            break;
+                        default:
+                            output.add_item(entity);
+                            output.commit();
+                    }
+                }
+
+                return output;
+            }
+
+        }; // class TagRewriter
+
+        namespace detail {
+
+            class TagRewriterTask {
+
+                std::shared_ptr<osmium::memory::Buffer> m_buffer;
+                const TagRewriter* m_rewriter;
+
+            public:
+
+                TagRewriterTask(osmium::memory::Buffer&& buffer, const TagRewriter& rewriter) :
+                    m_buffer(std::make_shared<osmium::memory::Buffer>(std::move(buffer))),
+                    m_rewriter(&rewriter) {
+                }
+
+                osmium::memory::Buffer operator()() const {
+                    return (*m_rewriter)(*m_buffer);
+                }
+
+            }; // class TagRewriterTask
+
+        } // namespace detail
+
+        /**
+         * Read all buffers from the source, rewrite them in parallel using
+         * the thread pool and hand the results to the sink in the original
+         * order. The number of buffers in flight is limited to twice the
+         * number of threads in the pool.
+         *
+         * @param source Something with a read() function returning buffers,
+         *               usually an osmium::io::Reader.
+         * @param sink Something callable with a buffer, usually an
+         *             osmium::io::Writer.
+         * @param rewriter The rules.
+         * @param pool Thread pool to use.
+         * @throws Any exception thrown by the source or sink.
+         */
+        template <typename TSource, typename TSink>
+        void rewrite_tags(TSource& source, TSink& sink, const TagRewriter& rewriter, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+            const auto max_in_flight = 2 * static_cast<std::size_t>(pool.num_threads());
+            std::deque<std::future<osmium::memory::Buffer>> futures;
+
+            try {
+                while (auto buffer = source.read()) {
+                    if (futures.size() >= max_in_flight) {
+                        sink(futures.front().get());
+                        futures.pop_front();
+                    }
+                    futures.push_back(pool.submit(detail::TagRewriterTask{std::move(buffer), rewriter}));
+                }
+                while (!futures.empty()) {
+                    sink(futures.front().get());
+                    futures.pop_front();
+                }
+            } catch (...) {
+                // tasks refer to the rewriter, wait for them before unwinding
+                for (auto& future : futures) {
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                }
+                throw;
+            }
+        }
+
+    } // namespace tags
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_TAG_REWRITER_HPP
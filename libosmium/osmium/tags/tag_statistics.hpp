@@ -0,0 +1,745 @@
+#ifndef OSMIUM_TAGS_TAG_STATISTICS_HPP
+#define OSMIUM_TAGS_TAG_STATISTICS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/tags/detail/string_hash.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace tags {
+
+        namespace detail {
+
+            /**
+             * Storage for lots of strings. Memory is allocated in chunks,
+             * strings never move once they are added. Strings larger than
+             * the chunk size get a chunk of their own.
+             */
+            class StringArena {
+
+                enum {
+                    default_chunk_size = 64U * 1024U
+                };
+
+                std::vector<std::unique_ptr<char[]>> m_chunks;
+                std::size_t m_chunk_size;
+                std::size_t m_used; // bytes used in last chunk
+                std::size_t m_bytes = 0; // bytes used overall
+
+                char* reserve(const std::size_t size) {
+                    m_bytes += size;
+
+                    if (size > m_chunk_size) {
+                        // Put big chunk in front so the last chunk can
+                        // still be filled up.
+                        m_chunks.emplace(m_chunks.begin(), new char[size]);
+                        return m_chunks.front().get();
+                    }
+
+                    if (m_used + size > m_chunk_size) {
+                        m_chunks.emplace_back(new char[m_chunk_size]);
+                        m_used = 0;
+                    }
+
+                    char* ptr = m_chunks.back().get() + m_used;
+                    m_used += size;
+                    return ptr;
+                }
+
+            public:
+
+                explicit StringArena(const std::size_t chunk_size = default_chunk_size) :
+                    m_chunk_size(chunk_size),
+                    m_used(chunk_size) {
+                }
+
+                /**
+                 * Add a null terminated string to the arena.
+                 *
+                 * @returns Pointer to the copy of the string.
+                 */
+                const char* add(const char* str) {
+                    const std::size_t len = std::strlen(str) + 1;
+                    char* ptr = reserve(len);
+                    std::memcpy(ptr, str, len);
+                    return ptr;
+                }
+
+                /**
+                 * Add two null terminated strings to the arena, one right
+                 * after the other.
+                 *
+                 * @returns Pointer to the copy of the first string.
+                 */
+                const char* add(const char* key, const char* value) {
+                    const std::size_t key_len = std::strlen(key) + 1;
+                    const std::size_t value_len = std::strlen(value) + 1;
+                    char* ptr = reserve(key_len + value_len);
+                    std::memcpy(ptr, key, key_len);
+                    std::memcpy(ptr + key_len, value, value_len);
+                    return ptr;
+                }
+
+                /// Number of bytes used by the strings in this arena.
+                std::size_t used_memory() const noexcept {
+                    return m_bytes;
+                }
+
+                void clear() noexcept {
+                    m_chunks.clear();
+                    m_used = m_chunk_size;
+                    m_bytes = 0;
+                }
+
+            }; // class StringArena
+
+            /**
+             * Reference to a key and a value somewhere in memory. Used as
+             * key in hash tables.
+             */
+            struct tag_ref {
+                const char* key;
+                const char* value;
+            }; // struct tag_ref
+
+            struct tag_ref_hash {
+
+                std::size_t operator()(const tag_ref& tag) const noexcept {
+                    const str_hash hash;
+                    const std::size_t h = hash(tag.key);
+                    return h ^ (hash(tag.value) + 0x9e3779b9U + (h << 6U) + (h >> 2U));
+                }
+
+            }; // struct tag_ref_hash
+
+            struct tag_ref_equal {
+
+                bool operator()(const tag_ref& lhs, const tag_ref& rhs) const noexcept {
+                    return str_equal{}(lhs.key, rhs.key) && str_equal{}(lhs.value, rhs.value);
+                }
+
+            }; // struct tag_ref_equal
+
+            /**
+             * Approximate counting of the most frequent tags in bounded
+             * memory using the Space-Saving algorithm (Metwally, Agrawal,
+             * El Abbadi: "Efficient Computation of Frequent and Top-k
+             * Elements in Data Streams", 2005).
+             *
+             * At most capacity() tags are tracked. If a new tag comes in
+             * and there is no space left, the tag with the smallest count
+             * is replaced and the new tag inherits its count. Counts are
+             * never too small, they are too large by at most the error
+             * stored with each counter. Every tag that occurs more than
+             * N/capacity() times in a stream of N tags is guaranteed to be
+             * in the summary.
+             */
+            class SpaceSaving {
+
+            public:
+
+                struct counter {
+                    tag_ref tag;
+                    uint64_t count;
+                    uint64_t error;
+                }; // struct counter
+
+            private:
+
+                // The counters never move, m_heap is a min-heap (by count)
+                // of indexes into m_counters, m_pos is the reverse mapping.
+                std::vector<counter> m_counters;
+                std::vector<std::size_t> m_heap;
+                std::vector<std::size_t> m_pos;
+                std::unordered_map<tag_ref, std::size_t, tag_ref_hash, tag_ref_equal> m_index;
+                StringArena m_arena;
+                std::size_t m_live_bytes = 0;
+                std::size_t m_capacity;
+
+                uint64_t count_at(const std::size_t heap_pos) const noexcept {
+                    return m_counters[m_heap[heap_pos]].count;
+                }
+
+                void swap_heap(const std::size_t a, const std::size_t b) noexcept {
+                    std::swap(m_heap[a], m_heap[b]);
+                    m_pos[m_heap[a]] = a;
+                    m_pos[m_heap[b]] = b;
+                }
+
+                void sift_up(std::size_t pos) noexcept {
+                    while (pos > 0) {
+                        const std::size_t parent = (pos - 1) / 2;
+                        if (count_at(parent) <= count_at(pos)) {
+                            return;
+                        }
+                        swap_heap(pos, parent);
+                        pos = parent;
+                    }
+                }
+
+                void sift_down(std::size_t pos) noexcept {
+                    const std::size_t size = m_heap.size();
+                    while (true) {
+                        std::size_t smallest = pos;
+                        const std::size_t left = 2 * pos + 1;
+                        const std::size_t right = left + 1;
+                        if (left < size && count_at(left) < count_at(smallest)) {
+                            smallest = left;
+                        }
+                        if (right < size && count_at(right) < count_at(smallest)) {
+                            smallest = right;
+                        }
+                        if (smallest == pos) {
+                            return;
+                        }
+                        swap_heap(pos, smallest);
+                        pos = smallest;
+                    }
+                }
+
+                // Strings of evicted tags stay in the arena. Copy the live
+                // ones into a new arena when too much memory is wasted.
+                void compact_if_needed() {
+                    if (m_arena.used_memory() < 4 * 1024 * 1024 || m_arena.used_memory() < 2 * m_live_bytes) {
+                        return;
+                    }
+
+                    StringArena arena;
+                    m_index.clear();
+                    for (std::size_t i = 0; i < m_counters.size(); ++i) {
+                        auto& c = m_counters[i];
+                        c.tag.key = arena.add(c.tag.key, c.tag.value);
+                        c.tag.value = c.tag.key + std::strlen(c.tag.key) + 1;
+                        m_index.emplace(c.tag, i);
+                    }
+                    using std::swap;
+                    swap(m_arena, arena);
+                }
+
+                // Number of bytes a tag takes up in the arena.
+                static std::size_t arena_size(const tag_ref& tag) noexcept {
+                    return static_cast<std::size_t>(tag.value - tag.key) + std::strlen(tag.value) + 1;
+                }
+
+                void insert(const char* key, const char* value, const uint64_t count, const uint64_t error) {
+                    const char* k = m_arena.add(key, value);
+                    const tag_ref tag{k, k + std::strlen(k) + 1};
+                    m_live_bytes += arena_size(tag);
+                    m_index.emplace(tag, m_counters.size());
+                    m_pos.push_back(m_heap.size());
+                    m_heap.push_back(m_counters.size());
+                    m_counters.push_back(counter{tag, count, error});
+                    sift_up(m_heap.size() - 1);
+                }
+
+            public:
+
+                explicit SpaceSaving(const std::size_t capacity) :
+                    m_capacity(capacity) {
+                    assert(capacity > 0);
+                }
+
+                std::size_t capacity() const noexcept {
+                    return m_capacity;
+                }
+
+                std::size_t size() const noexcept {
+                    return m_counters.size();
+                }
+
+                bool full() const noexcept {
+                    return m_counters.size() >= m_capacity;
+                }
+
+                /**
+                 * The smallest count in the summary if it is full, 0
+                 * otherwise. This is the maximum count any tag not in the
+                 * summary can have.
+                 */
+                uint64_t min_count() const noexcept {
+                    return full() ? count_at(0) : 0;
+                }
+
+                void add(const char* key, const char* value, const uint64_t count = 1) {
+                    const auto it = m_index.find(tag_ref{key, value});
+                    if (it != m_index.end()) {
+                        m_counters[it->second].count += count;
+                        sift_down(m_pos[it->second]);
+                        return;
+                    }
+
+                    if (!full()) {
+                        insert(key, value, count, 0);
+                        return;
+                    }
+
+                    // replace counter with smallest count
+                    const std::size_t n = m_heap[0];
+                    auto& c = m_counters[n];
+                    m_index.erase(c.tag);
+                    m_live_bytes -= arena_size(c.tag);
+                    const char* k = m_arena.add(key, value);
+                    c.tag = tag_ref{k, k + std::strlen(k) + 1};
+                    m_live_bytes += arena_size(c.tag);
+                    c.error = c.count;
+                    c.count += count;
+                    m_index.emplace(c.tag, n);
+                    sift_down(0);
+                    compact_if_needed();
+                }
+
+                /**
+                 * Merge another summary into this one. Tags missing from
+                 * one of the summaries are assumed to have its min_count()
+                 * there, so the error bounds stay intact.
+                 */
+                void merge(const SpaceSaving& other) {
+                    const uint64_t this_min = min_count();
+                    const uint64_t other_min = other.min_count();
+
+                    std::vector<counter> combined;
+                    combined.reserve(m_counters.size() + other.m_counters.size());
+
+                    for (const auto& c : m_counters) {
+                        const auto it = other.m_index.find(c.tag);
+                        if (it == other.m_index.end()) {
+                            combined.push_back(counter{c.tag, c.count + other_min, c.error + other_min});
+                        } else {
+                            const auto& oc = other.m_counters[it->second];
+                            combined.push_back(counter{c.tag, c.count + oc.count, c.error + oc.error});
+                        }
+                    }
+                    for (const auto& c : other.m_counters) {
+                        if (m_index.find(c.tag) == m_index.end()) {
+                            combined.push_back(counter{c.tag, c.count + this_min, c.error + this_min});
+                        }
+                    }
+
+                    if (combined.size() > m_capacity) {
+                        std::nth_element(combined.begin(), combined.begin() + static_cast<std::ptrdiff_t>(m_capacity), combined.end(), [](const counter& a, const counter& b) {
+                            return a.count > b.count;
+                        });
+                        combined.resize(m_capacity);
+                    }
+
+                    // the combined counters still point into the old
+                    // arenas, so keep this one alive until we are done
+                    StringArena old_arena;
+                    using std::swap;
+                    swap(m_arena, old_arena);
+
+                    m_counters.clear();
+                    m_heap.clear();
+                    m_pos.clear();
+                    m_index.clear();
+                    m_live_bytes = 0;
+                    for (const auto& c : combined) {
+                        insert(c.tag.key, c.tag.value, c.count, c.error);
+                    }
+                }
+
+                const std::vector<counter>& counters() const noexcept {
+                    return m_counters;
+                }
+
+            }; // class SpaceSaving
+
+        } // namespace detail
+
+        /**
+         * Result entry for keys from TagStatistics.
+         */
+        struct key_count {
+            const char* key;
+            uint64_t count;
+        }; // struct key_count
+
+        /**
+         * Result entry for tags from TagStatistics. The count is an upper
+         * bound, the real count is at least count - error. In exact mode
+         * the error is always 0.
+         */
+        struct tag_count {
+            const char* key;
+            const char* value;
+            uint64_t count;
+            uint64_t error;
+        }; // struct tag_count
+
+        /**
+         * Counts how often keys and tags (key/value combinations) appear
+         * in OSM objects.
+         *
+         * Keys are always counted exactly. Tags are counted exactly by
+         * default, but because there are many more distinct values than
+         * keys, this needs a lot of memory on large inputs. If max_tags is
+         * set, the most frequent tags are found in bounded memory with the
+         * Space-Saving algorithm instead (see tag_count for the error
+         * bounds).
+         *
+         * Strings are stored in an arena inside this object. The strings
+         * returned in the results are valid as long as this object exists
+         * and isn't changed.
+         *
+         * Several TagStatistics objects can be filled independently (for
+         * instance in different threads) and merged afterwards. See
+         * collect_tag_statistics() for a parallel driver.
+         */
+        class TagStatistics {
+
+            std::unordered_map<const char*, uint64_t, detail::str_hash, detail::str_equal> m_keys;
+            detail::StringArena m_key_arena;
+
+            std::unordered_map<detail::tag_ref, uint64_t, detail::tag_ref_hash, detail::tag_ref_equal> m_tags;
+            detail::StringArena m_tag_arena;
+
+            std::unique_ptr<detail::SpaceSaving> m_heavy_hitters;
+
+            uint64_t m_objects = 0;
+            uint64_t m_tag_count = 0;
+
+            void add_key(const char* key, const uint64_t count) {
+                const auto it = m_keys.find(key);
+                if (it != m_keys.end()) {
+                    it->second += count;
+                } else {
+                    m_keys.emplace(m_key_arena.add(key), count);
+                }
+            }
+
+            void add_tag(const char* key, const char* value, const uint64_t count) {
+                if (m_heavy_hitters) {
+                    m_heavy_hitters->add(key, value, count);
+                    return;
+                }
+                const auto it = m_tags.find(detail::tag_ref{key, value});
+                if (it != m_tags.end()) {
+                    it->second += count;
+                } else {
+                    const char* k = m_tag_arena.add(key, value);
+                    m_tags.emplace(detail::tag_ref{k, k + std::strlen(k) + 1}, count);
+                }
+            }
+
+        public:
+
+            /**
+             * Constructor.
+             *
+             * @param max_tags If this is 0 (the default), all tags are
+             *                 counted exactly. Otherwise at most this many
+             *                 tags are tracked using the Space-Saving
+             *                 algorithm.
+             */
+            explicit TagStatistics(const std::size_t max_tags = 0) {
+                if (max_tags > 0) {
+                    m_heavy_hitters.reset(new detail::SpaceSaving{max_tags});
+                }
+            }
+
+            /// The maximum number of tags tracked, 0 in exact mode.
+            std::size_t max_tags() const noexcept {
+                return m_heavy_hitters ? m_heavy_hitters->capacity() : 0;
+            }
+
+            /// Number of objects added.
+            uint64_t objects() const noexcept {
+                return m_objects;
+            }
+
+            /// Number of tags seen in all objects.
+            uint64_t tags() const noexcept {
+                return m_tag_count;
+            }
+
+            /// Number of distinct keys seen.
+            std::size_t distinct_keys() const noexcept {
+                return m_keys.size();
+            }
+
+            void add(const osmium::TagList& tags) {
+                for (const auto& tag : tags) {
+                    add_key(tag.key(), 1);
+                    add_tag(tag.key(), tag.value(), 1);
+                    ++m_tag_count;
+                }
+            }
+
+            void add(const osmium::OSMObject& object) {
+                ++m_objects;
+                add(object.tags());
+            }
+
+            /**
+             * Add all OSM objects of the specified types in the buffer.
+             */
+            void add(const osmium::memory::Buffer& buffer, const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nwr) {
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    if (entities & osmium::osm_entity_bits::from_item_type(object.type())) {
+                        add(object);
+                    }
+                }
+            }
+
+            /**
+             * Merge the counts from other statistics into this one. Both
+             * must have been created with the same max_tags setting.
+             */
+            void merge(const TagStatistics& other) {
+                assert(max_tags() == other.max_tags());
+
+                m_objects += other.m_objects;
+                m_tag_count += other.m_tag_count;
+
+                for (const auto& k : other.m_keys) {
+                    add_key(k.first, k.second);
+                }
+
+                if (m_heavy_hitters) {
+                    m_heavy_hitters->merge(*other.m_heavy_hitters);
+                } else {
+                    for (const auto& t : other.m_tags) {
+                        add_tag(t.first.key, t.first.value, t.second);
+                    }
+                }
+            }
+
+            /**
+             * Get all keys sorted by count (largest first), keys with the
+             * same count are sorted alphabetically.
+             */
+            std::vector<key_count> keys_by_frequency() const {
+                std::vector<key_count> result;
+                result.reserve(m_keys.size());
+                for (const auto& k : m_keys) {
+                    result.push_back(key_count{k.first, k.second});
+                }
+                std::sort(result.begin(), result.end(), [](const key_count& a, const key_count& b) {
+                    return a.count > b.count ||
+                           (a.count == b.count && std::strcmp(a.key, b.key) < 0);
+                });
+                return result;
+            }
+
+            /**
+             * Get tags sorted by count (largest first), tags with the same
+             * count are sorted alphabetically by key and then value.
+             *
+             * @param max Return at most this many tags (0 = all).
+             */
+            std::vector<tag_count> tags_by_frequency(const std::size_t max = 0) const {
+                std::vector<tag_count> result;
+                if (m_heavy_hitters) {
+                    result.reserve(m_heavy_hitters->size());
+                    for (const auto& c : m_heavy_hitters->counters()) {
+                        result.push_back(tag_count{c.tag.key, c.tag.value, c.count, c.error});
+                    }
+                } else {
+                    result.reserve(m_tags.size());
+                    for (const auto& t : m_tags) {
+                        result.push_back(tag_count{t.first.key, t.first.value, t.second, 0});
+                    }
+                }
+
+                const auto compare = [](const tag_count& a, const tag_count& b) {
+                    if (a.count != b.count) {
+                        return a.count > b.count;
+                    }
+                    const int c = std::strcmp(a.key, b.key);
+                    return c < 0 || (c == 0 && std::strcmp(a.value, b.value) < 0);
+                };
+
+                if (max > 0 && max < result.size()) {
+                    std::partial_sort(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(max), result.end(), compare);
+                    result.resize(max);
+                } else {
+                    std::sort(result.begin(), result.end(), compare);
+                }
+
+                return result;
+            }
+
+        }; // class TagStatistics
+
+        namespace detail {
+
+            /**
+             * One TagStatistics object for each worker. Tasks running in
+             * the thread pool borrow one that isn't used at the moment.
+             */
+            class TagStatisticsSlots {
+
+                std::vector<TagStatistics> m_slots;
+                std::vector<std::size_t> m_free;
+                std::mutex m_mutex;
+
+            public:
+
+                TagStatisticsSlots(const std::size_t num, const std::size_t max_tags) {
+                    m_slots.reserve(num);
+                    for (std::size_t i = 0; i < num; ++i) {
+                        m_slots.emplace_back(max_tags);
+                        m_free.push_back(i);
+                    }
+                }
+
+                // There are never more tasks running than slots, so there
+                // is always a free one.
+                std::size_t acquire() {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    assert(!m_free.empty());
+                    const std::size_t n = m_free.back();
+                    m_free.pop_back();
+                    return n;
+                }
+
+                void release(const std::size_t n) {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    m_free.push_back(n);
+                }
+
+                TagStatistics& operator[](const std::size_t n) noexcept {
+                    return m_slots[n];
+                }
+
+                std::size_t size() const noexcept {
+                    return m_slots.size();
+                }
+
+            }; // class TagStatisticsSlots
+
+            class TagStatisticsTask {
+
+                std::shared_ptr<osmium::memory::Buffer> m_buffer;
+                TagStatisticsSlots* m_slots;
+                osmium::osm_entity_bits::type m_entities;
+
+            public:
+
+                TagStatisticsTask(osmium::memory::Buffer&& buffer, TagStatisticsSlots& slots, const osmium::osm_entity_bits::type entities) :
+                    m_buffer(std::make_shared<osmium::memory::Buffer>(std::move(buffer))),
+                    m_slots(&slots),
+                    m_entities(entities) {
+                }
+
+                void operator()() const {
+                    const std::size_t n = m_slots->acquire();
+                    try {
+                        (*m_slots)[n].add(*m_buffer, m_entities);
+                    } catch (...) {
+                        m_slots->release(n);
+                        throw;
+                    }
+                    m_slots->release(n);
+                }
+
+            }; // class TagStatisticsTask
+
+        } // namespace detail
+
+        /**
+         * Count keys and tags of all objects from a source in parallel.
+         * Buffers are handed to the thread pool, each worker counts into
+         * its own TagStatistics which are merged at the end. The number of
+         * buffers in flight is limited to the number of threads.
+         *
+         * @param source Something with a read() function returning buffers,
+         *               usually an osmium::io::Reader.
+         * @param max_tags See TagStatistics constructor.
+         * @param entities Only count objects of these types.
+         * @param pool Thread pool to use.
+         * @returns The merged statistics.
+         * @throws Any exception thrown by the source or the workers.
+         */
+        template <typename TSource>
+        TagStatistics collect_tag_statistics(TSource& source,
+                                             const std::size_t max_tags = 0,
+                                             const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nwr,
+                                             osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+            const auto num_threads = static_cast<std::size_t>(pool.num_threads());
+            detail::TagStatisticsSlots slots{num_threads, max_tags};
+
+            std::deque<std::future<void>> futures;
+            try {
+                while (auto buffer = source.read()) {
+                    if (futures.size() >= slots.size()) {
+                        futures.front().get();
+                        futures.pop_front();
+                    }
+                    futures.push_back(pool.submit(detail::TagStatisticsTask{std::move(buffer), slots, entities}));
+                }
+                while (!futures.empty()) {
+                    futures.front().get();
+                    futures.pop_front();
+                }
+            } catch (...) {
+                // tasks refer to the slots, wait for them before unwinding
+                for (auto& future : futures) {
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                }
+                throw;
+            }
+
+            TagStatistics result{max_tags};
+            for (std::size_t i = 0; i < slots.size(); ++i) {
+                result.merge(slots[i]);
+            }
+            return result;
+        }
+
+    } // namespace tags
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_TAG_STATISTICS_HPP
@@ -0,0 +1,196 @@
+#ifndef OSMIUM_TIME_FILTER_HPP
+#define OSMIUM_TIME_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2020 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/diff_parallel.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/diff_object.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace osmium {
+
+    /**
+     * Filter for history data: Finds the object versions valid at a point
+     * in time or during a time range.
+     *
+     * This can be used as a predicate on DiffObjects, to filter a
+     * DiffPartition, or to filter a whole history file in parallel
+     * (see filter()). Objects are never copied except into the output
+     * buffers, the filter works directly on the decoded buffers.
+     */
+    class TimeFilter {
+
+        osmium::Timestamp m_from;
+        osmium::Timestamp m_to;
+        bool m_point_in_time;
+
+        class handler {
+
+            const TimeFilter& m_filter;
+            osmium::memory::Buffer& m_buffer;
+
+            void add(const osmium::DiffObject& diff) {
+                if (m_filter(diff)) {
+                    m_buffer.add_item(diff.curr());
+                    m_buffer.commit();
+                }
+            }
+
+        public:
+
+            handler(const TimeFilter& filter, osmium::memory::Buffer& buffer) noexcept :
+                m_filter(filter),
+                m_buffer(buffer) {
+            }
+
+            void node(const osmium::DiffNode& diff) {
+                add(diff);
+            }
+
+            void way(const osmium::DiffWay& diff) {
+                add(diff);
+            }
+
+            void relation(const osmium::DiffRelation& diff) {
+                add(diff);
+            }
+
+        }; // class handler
+
+    public:
+
+        enum {
+            default_buffer_size = 1024UL * 1024UL
+        };
+
+        /**
+         * Filter for the state at the given point in time. This matches
+         * at most one version of each object, the one valid at that
+         * time, and only if it is not deleted. The result is a normal
+         * (non-history) file.
+         */
+        explicit TimeFilter(const osmium::Timestamp& point_in_time) noexcept :
+            m_from(point_in_time),
+            m_to(point_in_time),
+            m_point_in_time(true) {
+        }
+
+        /**
+         * Filter for all versions valid at some point in the time range
+         * from (inclusive) to (exclusive). This matches deleted versions,
+         * too, the result is a history file.
+         *
+         * @throws std::invalid_argument if from is after to.
+         */
+        TimeFilter(const osmium::Timestamp& from, const osmium::Timestamp& to) :
+            m_from(from),
+            m_to(to),
+            m_point_in_time(false) {
+            if (from > to) {
+                throw std::invalid_argument{"Start of time range must not be after its end"};
+            }
+        }
+
+        /// Does this filter for a point in time (or for a time range)?
+        bool point_in_time() const noexcept {
+            return m_point_in_time;
+        }
+
+        osmium::Timestamp from() const noexcept {
+            return m_from;
+        }
+
+        osmium::Timestamp to() const noexcept {
+            return m_to;
+        }
+
+        /**
+         * Does the current version of the DiffObject match this filter?
+         */
+        bool operator()(const osmium::DiffObject& diff) const noexcept {
+            return m_point_in_time ? diff.is_visible_at(m_from)
+                                   : diff.is_between(m_from, m_to);
+        }
+
+        /**
+         * Add all matching object versions from the partition to the
+         * buffer.
+         */
+        void filter_partition(const osmium::DiffPartition& partition, osmium::memory::Buffer& buffer) const {
+            handler h{*this, buffer};
+            partition.apply(h);
+        }
+
+        /**
+         * Filter a history file sorted by type, id, and version from the
+         * source (usually a Reader). This works on several partitions of
+         * the input in parallel. The output function is called with
+         * buffers containing the matching object versions in input
+         * order, usually it hands them to a Writer.
+         *
+         * @code
+         * osmium::io::Reader reader{"history.osh.pbf"};
+         * osmium::io::Writer writer{"snapshot.osm.pbf"};
+         * const osmium::TimeFilter filter{osmium::Timestamp{"2015-01-01T00:00:00Z"}};
+         * filter.filter(reader, [&](osmium::memory::Buffer&& buffer) {
+         *     writer(std::move(buffer));
+         * });
+         * @endcode
+         *
+         * @throws Any exception the source or the output throw.
+         */
+        template <typename TSource, typename TOutput>
+        void filter(TSource& source, TOutput&& output,
+                    osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) const {
+            osmium::apply_diff_parallel(source, [this](const osmium::DiffPartition& partition) {
+                osmium::memory::Buffer buffer{default_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                filter_partition(partition, buffer);
+                return buffer;
+            }, [&output](osmium::memory::Buffer&& buffer) {
+                if (buffer.committed() > 0) {
+                    output(std::move(buffer));
+                }
+            }, pool);
+        }
+
+    }; // class TimeFilter
+
+} // namespace osmium
+
+#endif // OSMIUM_TIME_FILTER_HPP
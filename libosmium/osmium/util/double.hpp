@@ -35,18 +35,90 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <iterator>
+#include <limits>
 #include <string>
 
 namespace osmium {
 
+    namespace detail {
+
+        // Write the absolute value of a fixed point number with the given
+        // number of digits after the decimal point.
+        template <typename T>
+        inline T unsigned_fixed_point_to_string(T iterator, uint64_t value, int precision, bool trim_zeros) {
+            enum {
+                max_uint64_length = 20 // number of decimal digits in 2^64
+            };
+
+            char buffer[max_uint64_length + 1];
+            char* end = buffer + sizeof(buffer);
+            char* p = end;
+
+            // write digits backwards, at least precision + 1 of them
+            int digits = 0;
+            do {
+                *--p = static_cast<char>('0' + value % 10);
+                value /= 10;
+                ++digits;
+            } while (value != 0 || digits <= precision);
+
+            char* const point = end - precision;
+            if (trim_zeros) {
+                while (end != point && end[-1] == '0') {
+                    --end;
+                }
+            }
+
+            iterator = std::copy(p, point, iterator);
+            if (point != end) {
+                *iterator++ = '.';
+                iterator = std::copy(point, end, iterator);
+            }
+            return iterator;
+        }
+
+    } // namespace detail
+
     inline namespace util {
 
+        /**
+         * Write fixed point number value / 10^precision to iterator. This
+         * only uses integer arithmetic.
+         *
+         * @tparam T iterator type
+         * @param iterator output iterator
+         * @param value the value that should be written multiplied by
+         *              10^precision
+         * @param precision number of digits after the decimal point (must be
+         *                  <= 19)
+         * @param trim_zeros remove '0' characters at the end of the digits
+         *                   after the decimal point, and the decimal point
+         *                   itself if no digits remain
+         */
+        template <typename T>
+        inline T fixed_point_to_string(T iterator, int64_t value, int precision, bool trim_zeros = true) {
+            assert(precision >= 0 && precision <= 19);
+            uint64_t abs_value = static_cast<uint64_t>(value);
+            if (value < 0) {
+                *iterator++ = '-';
+                abs_value = 0 - abs_value;
+            }
+            return osmium::detail::unsigned_fixed_point_to_string(iterator, abs_value, precision, trim_zeros);
+        }
+
         /**
          * Write double to iterator, removing superfluous '0' characters at
          * the end. The decimal dot will also be removed if necessary.
          *
+         * For precisions up to 9 the value is rounded to an integer and
+         * written using fixed_point_to_string(). Values very close to the
+         * middle between two results and huge values are formatted with
+         * snprintf() so that the result is always exactly the same.
+         *
          * @tparam T iterator type
          * @param iterator output iterator
          * @param value the value that should be written
@@ -54,12 +126,35 @@ namespace osmium {
          */
         template <typename T>
         inline T double2string(T iterator, double value, int precision) {
-            assert(precision <= 17);
+            assert(precision >= 0 && precision <= 17);
 
             enum {
-                max_double_length = 20 // should fit decimal representation of any double
+                max_double_length = 20, // should fit decimal representation of any double
+                max_fast_precision = 9
+            };
+
+            static const double powers_of_ten[max_fast_precision + 1] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
             };
 
+            if (precision <= max_fast_precision) {
+                const double scaled = std::abs(value) * powers_of_ten[precision];
+                // below 2^53 all integers can be represented as double
+                if (scaled < 9007199254740992.0) {
+                    const double rounded = std::floor(scaled + 0.5);
+                    // The multiplication can be off by half a unit in the
+                    // last place, so the rounding is only sure to be the
+                    // same as that of the exact value if not too close to .5
+                    const double distance_from_middle = std::abs(std::abs(scaled - rounded) - 0.5);
+                    if (distance_from_middle > scaled * std::numeric_limits<double>::epsilon()) {
+                        if (std::signbit(value)) {
+                            *iterator++ = '-';
+                        }
+                        return osmium::detail::unsigned_fixed_point_to_string(iterator, static_cast<uint64_t>(rounded), precision, true);
+                    }
+                }
+            }
+
             char buffer[max_double_length];
 
 #ifndef _MSC_VER
@@ -69,11 +164,13 @@ namespace osmium {
 #endif
             assert(len > 0 && len < max_double_length);
 
-            while (buffer[len - 1] == '0') {
-                --len;
-            }
-            if (buffer[len - 1] == '.') {
-                --len;
+            if (precision > 0) {
+                while (buffer[len - 1] == '0') {
+                    --len;
+                }
+                if (buffer[len - 1] == '.') {
+                    --len;
+                }
             }
 
             return std::copy_n(buffer, len, iterator);
@@ -222,6 +222,24 @@ namespace osmium {
             return static_cast<std::size_t>(offset);
         }
 
+        /**
+         * Set the offset into the file.
+         *
+         * @param fd Open file descriptor.
+         * @param offset New offset from the beginning of the file.
+         * @throws std::system_error If this fails.
+         */
+        inline void file_seek(int fd, std::size_t offset) {
+#ifdef _MSC_VER
+            osmium::detail::disable_invalid_parameter_handler diph;
+            if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) == -1) {
+#else
+            if (::lseek(fd, static_cast<off_t>(offset), SEEK_SET) == -1) {
+#endif
+                throw std::system_error{errno, std::system_category(), "Seek failed"};
+            }
+        }
+
         /**
          * Check whether the file descriptor refers to a TTY.
          */
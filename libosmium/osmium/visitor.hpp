@@ -94,6 +94,9 @@ namespace osmium {
                 case osmium::item_type::changeset_discussion:
                     std::forward<THandler>(handler).changeset_discussion(static_cast<ConstIfConst<TItem, osmium::ChangesetDiscussion>&>(item));
                     break;
+                case osmium::item_type::key_signature:
+                    // only used internally for faster tag lookups
+                    break;
             }
         }
 